@@ -1,16 +1,26 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdarg>
+#include <deque>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
-#include "loggable_os.hpp"
+#include "loggable_backend.hpp"
 #include "loggable_ringbuffer.hpp"
+#include "loggable_spill.hpp"
+#include "loggable_static.hpp"
 
 namespace loggable {
 
@@ -52,46 +62,316 @@ log_level_to_string(LogLevel level) noexcept {
   return "UNKNOWN"; // Satisfy compiler return requirement
 }
 
+/**
+ * @brief Maps a single-letter level code (as printed by ESP_LOGx) to a level.
+ * @return The matching level, or LogLevel::None if the letter is unknown.
+ */
+[[nodiscard]] constexpr LogLevel log_level_from_char(char letter) noexcept {
+  switch (letter) {
+  case 'E':
+    return LogLevel::Error;
+  case 'W':
+    return LogLevel::Warning;
+  case 'I':
+    return LogLevel::Info;
+  case 'D':
+    return LogLevel::Debug;
+  case 'V':
+    return LogLevel::Verbose;
+  default:
+    return LogLevel::None;
+  }
+}
+
 [[nodiscard]] constexpr bool
 is_log_level_enabled(LogLevel message_level, LogLevel global_level) noexcept {
   return message_level <= global_level;
 }
 
+/**
+ * @brief Result of parsing the prefix of a pre-formatted ESP-IDF log line.
+ */
+struct LogLinePrefix {
+  LogLevel level{LogLevel::None}; ///< Level recovered from the level letter
+  std::string_view tag;           ///< Tag, pointing into the parsed line
+  size_t length{0};               ///< Bytes consumed; 0 if no prefix matched
+};
+
+/**
+ * @brief Parses the standard `"I (1234) TAG: "` prefix written by ESP_LOGx.
+ *
+ * A leading ANSI color sequence (CONFIG_LOG_COLORS) is skipped. The parse
+ * is a single forward scan and never allocates.
+ *
+ * @param line The formatted line.
+ * @return The recovered level and tag, or a zero-length result on mismatch.
+ */
+[[nodiscard]] LogLinePrefix parse_log_line_prefix(std::string_view line) noexcept;
+
+/**
+ * @brief One key/value pair of a thread's diagnostic context, linked to
+ *        the pairs pushed before it.
+ *
+ * Push pairs with ScopedContext. Nodes are immutable and shared, so each
+ * LogMessage holds the context current when it was logged by reference:
+ * one reference count increment per message, with no copying or
+ * formatting. Sinks that want the context render it; the others never
+ * pay for it. The binary record formats and the spill store do not carry
+ * it.
+ */
+class LogContext {
+public:
+  LogContext(std::string key, std::string value,
+             std::shared_ptr<const LogContext> parent) noexcept
+      : _key(std::move(key)), _value(std::move(value)),
+        _parent(std::move(parent)) {}
+
+  [[nodiscard]] const std::string &key() const noexcept { return _key; }
+  [[nodiscard]] const std::string &value() const noexcept { return _value; }
+  [[nodiscard]] const std::shared_ptr<const LogContext> &parent() const noexcept {
+    return _parent;
+  }
+
+  /**
+   * @brief The innermost value pushed for @p key, or nullptr.
+   */
+  [[nodiscard]] const std::string *find(std::string_view key) const noexcept;
+
+  /**
+   * @brief Call `fn(key, value)` for every pair, outermost first.
+   */
+  template <typename Fn> void for_each(Fn &&fn) const {
+    if (_parent) {
+      _parent->for_each(fn);
+    }
+    fn(_key, _value);
+  }
+
+  /**
+   * @brief Append the pairs as "key=value", space separated, outermost first.
+   */
+  void format(std::string &out) const;
+
+  /**
+   * @brief The calling thread's context; empty if nothing is pushed.
+   */
+  [[nodiscard]] static std::shared_ptr<const LogContext> current() noexcept {
+    return _current();
+  }
+
+private:
+  friend class ScopedContext;
+  [[nodiscard]] static std::shared_ptr<const LogContext> &_current() noexcept;
+
+  std::string _key;
+  std::string _value;
+  std::shared_ptr<const LogContext> _parent;
+};
+
+/**
+ * @brief Adds to the calling thread's diagnostic context until destroyed.
+ *
+ * Scopes must end in the reverse order they began, as locals do:
+ *
+ * @code
+ * ScopedContext request("req", std::to_string(id));
+ * logger.log(LogLevel::Info, "accepted"); // carries req=<id>
+ * @endcode
+ *
+ * Pushing allocates a node, so LOGGABLE_NO_HEAP builds can only adopt
+ * contexts built at startup.
+ */
+class ScopedContext {
+public:
+#ifndef LOGGABLE_NO_HEAP
+  /// Push @p key = @p value; pushing an existing key shadows it.
+  ScopedContext(std::string key, std::string value) noexcept;
+#endif
+
+  /// Adopt @p snapshot, e.g. LogContext::current() captured on another task.
+  explicit ScopedContext(std::shared_ptr<const LogContext> snapshot) noexcept;
+
+  ~ScopedContext();
+
+  ScopedContext(const ScopedContext &) = delete;
+  ScopedContext &operator=(const ScopedContext &) = delete;
+
+private:
+  std::shared_ptr<const LogContext> _previous;
+};
+
+/**
+ * @brief Text with static storage duration, logged without a copy.
+ *
+ * Only binds to string literals and constexpr arrays, which is checked at
+ * compile time:
+ * `logger.log(LogLevel::Info, StaticText("Connected"))`.
+ */
+class StaticText {
+public:
+  template <size_t N>
+  consteval explicit StaticText(const char (&text)[N]) noexcept
+      : _text(text, text[N - 1] == '\0' ? N - 1 : N) {}
+
+  [[nodiscard]] constexpr std::string_view view() const noexcept { return _text; }
+
+private:
+  std::string_view _text;
+};
+
 /**
  * @brief A structure representing a single log entry.
  *
- * Owns its data by using std::string, ensuring lifetime correctness.
+ * Owns its data by using std::string, ensuring lifetime correctness. With
+ * LOGGABLE_NO_HEAP, tag and text are InlineString values instead, cut to
+ * LOGGABLE_MAX_TAG and LOGGABLE_MAX_MESSAGE bytes; code using only their
+ * common interface (data(), size(), c_str(), std::string_view) builds
+ * either way.
  */
 class LogMessage {
 public:
-  LogMessage() noexcept = default;
+#if defined(LOGGABLE_NO_HEAP) && defined(LOGGABLE_PMR)
+#error "LOGGABLE_PMR needs the heap; it cannot be combined with LOGGABLE_NO_HEAP"
+#elif defined(LOGGABLE_NO_HEAP)
+  using Tag = InlineString<LOGGABLE_MAX_TAG>;
+  using Text = InlineString<LOGGABLE_MAX_MESSAGE>;
+#elif defined(LOGGABLE_PMR)
+  using Tag = std::pmr::string;
+  using Text = std::pmr::string;
+#else
+  using Tag = std::string;
+  using Text = std::string;
+#endif
+
+  LogMessage() noexcept : _message() {}
 
   LogMessage(std::chrono::system_clock::time_point timestamp, LogLevel level,
-             std::string tag, std::string message) noexcept
+             Tag tag, Text message,
+             std::shared_ptr<const LogContext> context = {}) noexcept
       : _timestamp(timestamp), _level(level), _tag(std::move(tag)),
-        _message(std::move(message)) {}
+        _message(std::move(message)), _context(std::move(context)) {}
+
+  /// Message pointing at @p text instead of holding a copy of it.
+  LogMessage(std::chrono::system_clock::time_point timestamp, LogLevel level,
+             Tag tag, StaticText text,
+             std::shared_ptr<const LogContext> context = {}) noexcept
+      : _timestamp(timestamp), _level(level), _static(true), _tag(std::move(tag)),
+        _static_text(text.view()), _context(std::move(context)) {}
 
-  LogMessage(const LogMessage &) = default;
-  LogMessage &operator=(const LogMessage &) = default;
-  LogMessage(LogMessage &&) noexcept = default;
-  LogMessage &operator=(LogMessage &&) noexcept = default;
-  ~LogMessage() = default;
+  LogMessage(const LogMessage &other)
+      : _timestamp(other._timestamp), _level(other._level), _tag(other._tag),
+        _context(other._context) {
+    _construct_text(other);
+  }
+  LogMessage(LogMessage &&other) noexcept
+      : _timestamp(other._timestamp), _level(other._level), _tag(std::move(other._tag)),
+        _context(std::move(other._context)) {
+    _construct_text(std::move(other));
+  }
+  LogMessage &operator=(const LogMessage &other) {
+    if (this != &other) {
+      _timestamp = other._timestamp;
+      _level = other._level;
+      _tag = other._tag;
+      _context = other._context;
+      if (!_static && !other._static) {
+        _message = other._message;
+      } else {
+        _destroy_text();
+        _construct_text(other);
+      }
+    }
+    return *this;
+  }
+  /// Takes over the payloads together with their resource, so with
+  /// LOGGABLE_PMR a message moved into a queue slot is never copied into
+  /// the slot's resource.
+  LogMessage &operator=(LogMessage &&other) noexcept {
+    if (this != &other) {
+      std::destroy_at(this);
+      std::construct_at(this, std::move(other));
+    }
+    return *this;
+  }
+#ifdef LOGGABLE_PMR
+  /// Copy whose tag and text are allocated from @p resource.
+  LogMessage(const LogMessage &other, std::pmr::memory_resource *resource)
+      : _timestamp(other._timestamp), _level(other._level), _tag(other._tag, resource),
+        _context(other._context) {
+    _static = other._static;
+    if (_static) {
+      std::construct_at(&_static_text, other._static_text);
+    } else {
+      std::construct_at(&_message, other._message, resource);
+    }
+  }
+#endif
+  ~LogMessage() { _destroy_text(); }
 
   [[nodiscard]] std::chrono::system_clock::time_point
   get_timestamp() const noexcept {
     return _timestamp;
   }
   [[nodiscard]] LogLevel get_level() const noexcept { return _level; }
-  [[nodiscard]] const std::string &get_tag() const noexcept { return _tag; }
-  [[nodiscard]] const std::string &get_message() const noexcept {
+  [[nodiscard]] const Tag &get_tag() const noexcept { return _tag; }
+  /**
+   * @brief The text the message owns.
+   *
+   * Empty for static text (see has_static_text()), which only reaches
+   * sinks that opt in through ISink::supports_static_text().
+   */
+  [[nodiscard]] const Text &get_message() const noexcept {
+    if (_static) [[unlikely]] {
+      static const Text empty;
+      return empty;
+    }
     return _message;
   }
+  /// The text, static or owned.
+  [[nodiscard]] std::string_view get_message_view() const noexcept {
+    return _static ? _static_text : std::string_view(_message);
+  }
+  /// Whether the text is static storage logged through StaticText.
+  [[nodiscard]] bool has_static_text() const noexcept { return _static; }
+  /// Diagnostic context when the message was logged; may be empty.
+  [[nodiscard]] const std::shared_ptr<const LogContext> &get_context() const noexcept {
+    return _context;
+  }
 
 private:
+  /// Starts the text member that @p other has, copied or moved from it.
+  template <typename Other> void _construct_text(Other &&other) {
+    _static = other._static;
+    if (_static) {
+      std::construct_at(&_static_text, other._static_text);
+    } else {
+      std::construct_at(&_message, std::forward<Other>(other)._message);
+    }
+  }
+  void _destroy_text() noexcept {
+    if (!_static) {
+      std::destroy_at(&_message);
+    }
+  }
+
   std::chrono::system_clock::time_point _timestamp{};
   LogLevel _level{LogLevel::None};
-  std::string _tag;
-  std::string _message;
+  bool _static{false}; ///< _static_text is the text; sits in _level's padding
+  Tag _tag;
+  union {
+    Text _message;
+    std::string_view _static_text; ///< For StaticText
+  };
+  std::shared_ptr<const LogContext> _context;
+};
+
+/**
+ * @brief Delivery state of a sink that buffers, see ISink::backpressure().
+ */
+struct SinkBackpressure {
+  size_t buffered_bytes{0}; ///< Held for delivery, in memory or storage
+  size_t dropped_count{0};  ///< Messages the sink has dropped so far
+  bool stalled{false};      ///< Cannot deliver right now, e.g. disconnected
 };
 
 /**
@@ -109,6 +389,43 @@ public:
    * @param message The log message to append.
    */
   virtual void consume(const LogMessage &message) = 0;
+
+  /**
+   * @brief Whether this sink must see messages in the order they were logged.
+   *
+   * In async mode, priority messages (see SinkerConfig::priority_level)
+   * overtake queued ones. A sink returning true instead receives each of
+   * them after every message logged before it. Queried once, when the sink
+   * is added.
+   */
+  [[nodiscard]] virtual bool requires_ordering() const noexcept { return false; }
+
+  /**
+   * @brief Whether consume() reads the text through
+   * LogMessage::get_message_view().
+   *
+   * Messages logged with StaticText then reach this sink without a copy.
+   * A sink returning false receives them with the text copied into
+   * get_message(), once per message for all such sinks of a worker.
+   * Queried once, when the sink is added.
+   */
+  [[nodiscard]] virtual bool supports_static_text() const noexcept { return false; }
+
+  /**
+   * @brief Called by the dispatch worker whenever it runs out of messages.
+   *
+   * Batching sinks send partial batches here: messages are coalesced
+   * while a backlog lasts and go out as soon as it clears. In sync mode
+   * it follows every consume().
+   * @return ms until the sink needs another call even if no message
+   *         arrives, e.g. to retry a connection, or os::WAIT_FOREVER.
+   */
+  virtual uint32_t on_idle() noexcept { return os::WAIT_FOREVER; }
+
+  /**
+   * @brief Report buffering and drops; summed into SinkerMetrics.
+   */
+  [[nodiscard]] virtual SinkBackpressure backpressure() const noexcept { return {}; }
 };
 
 /**
@@ -119,15 +436,125 @@ struct SinkerMetrics {
   size_t queued_count{0};  ///< Messages currently in queue
   size_t capacity{0};      ///< Queue capacity
   bool is_running{false};  ///< Whether async dispatch is active
+  size_t worker_count{0};  ///< Dispatch workers currently running
+  size_t priority_dropped_count{0}; ///< Priority messages dropped (included in dropped_count)
+  size_t priority_queued_count{0};  ///< Messages currently in the priority queue
+  size_t priority_capacity{0};      ///< Priority queue capacity
+  bool level_shedding{false};       ///< Adaptive level currently raised
+  size_t level_shed_count{0};       ///< Times the adaptive level was raised
+
+  // Window statistics, since init() or the last reset_metrics()
+  uint32_t window_ms{0};             ///< Length of the window
+  size_t pending_high_watermark{0};  ///< Most messages pending delivery at once
+  uint32_t time_above_high_ms{0};    ///< Time with SinkerConfig::high_watermark or more pending
+  float worker_busy_ratio{0.0f};     ///< Share of the window workers spent dispatching (0..1)
+  float messages_per_second{0.0f};   ///< Accepted messages, EWMA with a 5 s time constant
+
+  size_t spilled_count{0};       ///< Messages written to the spill store
+  size_t spill_pending_count{0}; ///< Messages in the spill store awaiting replay
+  size_t spill_bytes{0};         ///< Spill store space in use
+
+  // Summed over the sinks' backpressure()
+  size_t sink_buffered_bytes{0}; ///< Bytes sinks hold for delivery
+  size_t sink_dropped_count{0};  ///< Messages dropped inside sinks, not in dropped_count
+  size_t stalled_sinks{0};       ///< Sinks currently unable to deliver
+
+  // Slow-sink breaker, see SinkerConfig::slow_sink_us
+  size_t bypassed_sinks{0};      ///< Sinks currently bypassed
+  size_t sink_bypassed_count{0}; ///< Deliveries skipped while bypassed, not in dropped_count
+  size_t sink_trip_count{0};     ///< Times a sink was bypassed
+};
+
+/**
+ * @brief Who moves overflowing messages to SinkerConfig::spill_store.
+ */
+enum class SpillPolicy : std::uint8_t {
+  Producer, ///< A producer finding the queue full spills the oldest entry
+  Worker    ///< The worker spills while high_watermark or more are queued
 };
 
 /**
  * @brief Configuration for the async dispatch system.
  */
 struct SinkerConfig {
+  static constexpr size_t MAX_WORKERS = 4;
+
   size_t task_stack_size = 4096;
   int task_priority = 10;
   int task_core = -1; ///< -1 = any core
+
+  /**
+   * @brief Number of dispatch workers (1..MAX_WORKERS).
+   *
+   * Each sink is assigned to one worker when it is added, so sinks run in
+   * parallel while every sink still sees messages in order.
+   */
+  size_t worker_count = 1;
+  std::array<int, MAX_WORKERS> worker_cores{-1, -1, -1, -1}; ///< -1 = task_core
+
+  /**
+   * @brief Messages at or above this severity use the priority queue.
+   *
+   * The dispatch worker always drains it first, so errors do not wait
+   * behind (or get dropped with) verbose traffic. LogLevel::None disables it.
+   */
+  LogLevel priority_level = LogLevel::Warning;
+
+  /**
+   * @brief Pending-message thresholds.
+   *
+   * high_watermark also sets the threshold for
+   * SinkerMetrics::time_above_high_ms.
+   */
+  size_t high_watermark = 96;
+  size_t low_watermark = 32;
+
+  /**
+   * @brief Raise the effective level while the queue is under pressure.
+   *
+   * Once high_watermark messages are pending, Logger rejects anything less
+   * severe than shed_level before formatting it. The configured level is
+   * restored when no more than low_watermark are pending.
+   */
+  bool adaptive_level = false;
+  LogLevel shed_level = LogLevel::Info;
+
+  /**
+   * @brief Store overflowing messages here instead of dropping them.
+   *
+   * Spilled messages are replayed to the sinks in their original order
+   * once no more than low_watermark are queued. Messages are only dropped
+   * when the store is full. nullptr keeps the drop-oldest behavior.
+   */
+  std::shared_ptr<ISpillStore> spill_store{};
+  SpillPolicy spill_policy = SpillPolicy::Producer;
+
+  /**
+   * @brief Bypass a sink whose consume() keeps running slow.
+   *
+   * A consume() taking slow_sink_us or longer is slow. After
+   * slow_sink_trips slow calls in a row the sink is bypassed: its
+   * deliveries are skipped and counted for sink_probe_ms, then the next
+   * one probes it. A fast probe restores the sink; a slow one bypasses it
+   * again for twice as long, up to 16 times sink_probe_ms. Other sinks
+   * on the same worker keep their latency. 0 disables the breaker and
+   * the two clock reads per delivery it costs.
+   */
+  uint32_t slow_sink_us = 0;
+  uint32_t slow_sink_trips = 3;
+  uint32_t sink_probe_ms = 1000;
+
+  /**
+   * @brief Where the pipeline allocates from, e.g. a PSRAM arena.
+   *
+   * The queues, dispatch lanes, held priority messages and the sink table
+   * move to this resource at init(), and with LOGGABLE_PMR so do the tag
+   * and text of every message logged from then on. It stays in use after
+   * shutdown() until an init() with another resource, so it must outlive
+   * the Sinker or be replaced first. nullptr selects
+   * std::pmr::get_default_resource(). Ignored by the no-heap build.
+   */
+  std::pmr::memory_resource *memory_resource = nullptr;
 };
 
 /**
@@ -183,6 +610,14 @@ public:
    */
   [[nodiscard]] LogLevel get_level() const noexcept;
 
+  /**
+   * @brief Gets the level Logger filters against.
+   *
+   * The global level, raised to SinkerConfig::shed_level while adaptive
+   * shedding is active.
+   */
+  [[nodiscard]] LogLevel get_effective_level() const noexcept;
+
   /**
    * @brief Forwards a log message to all registered sinkers.
    *
@@ -193,6 +628,12 @@ public:
    */
   void dispatch(const LogMessage &message) noexcept;
 
+  /**
+   * @brief Forwards a log message, moving it into the queue in async mode.
+   * @param message The message to dispatch.
+   */
+  void dispatch(LogMessage &&message) noexcept;
+
   // --- Async API ---
 
   /**
@@ -216,7 +657,8 @@ public:
   /**
    * @brief Flush all queued messages synchronously.
    *
-   * Blocks until the queue is empty or timeout expires.
+   * Blocks until every message accepted so far has been delivered to the
+   * sinks, or the timeout expires.
    *
    * @param timeout_ms Maximum time to wait in milliseconds.
    * @return true if queue is empty, false if timeout expired.
@@ -228,35 +670,312 @@ public:
    */
   [[nodiscard]] bool is_running() const noexcept;
 
+  /**
+   * @brief The resource the pipeline allocates from, see
+   * SinkerConfig::memory_resource.
+   *
+   * Sinks that keep copies of messages can allocate them from it too.
+   */
+  [[nodiscard]] std::pmr::memory_resource *memory_resource() const noexcept;
+
   /**
    * @brief Get current metrics for monitoring.
    */
   [[nodiscard]] SinkerMetrics get_metrics() const noexcept;
 
+  /**
+   * @brief Get current metrics, then start a new statistics window.
+   */
+  SinkerMetrics reset_metrics() noexcept;
+
 private:
   Sinker() = default;
 
   std::atomic<LogLevel> _global_level{LogLevel::Info};
-  std::vector<std::shared_ptr<ISink>> _sinkers;
-  mutable std::mutex _sinkers_mutex;
+  /// Slow-sink breaker state, owned by the worker the sink is assigned to.
+  struct SinkHealth {
+    SinkHealth() noexcept = default;
+    /// Entries are only copied under the exclusive lock, when no worker runs them
+    SinkHealth(const SinkHealth &other) noexcept { *this = other; }
+    SinkHealth &operator=(const SinkHealth &other) noexcept {
+      bypassed.store(other.bypassed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      skipped.store(other.skipped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      trips.store(other.trips.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      slow_streak = other.slow_streak;
+      bypass_ms = other.bypass_ms;
+      probe_at_ms = other.probe_at_ms;
+      return *this;
+    }
+
+    std::atomic<bool> bypassed{false};
+    std::atomic<size_t> skipped{0};
+    std::atomic<size_t> trips{0};
+    uint32_t slow_streak{0};
+    uint32_t bypass_ms{0};  ///< Current bypass period
+    uint32_t probe_at_ms{0};
+  };
+
+  /// A sink and its stable slot; the slot picks the dispatch worker.
+  struct SinkEntry {
+    std::shared_ptr<ISink> sink;
+    size_t slot{0};
+    bool ordered{false}; ///< Cached requires_ordering()
+    bool static_text{false}; ///< Cached supports_static_text()
+    mutable SinkHealth health; ///< Updated by its worker under the shared lock
+  };
+
+  /// Which sinks a delivery is for.
+  enum class Audience : uint8_t { All, Unordered, Ordered };
+
+#ifdef LOGGABLE_NO_HEAP
+  /// Storage that lives in the Sinker itself
+  template <typename T> using Storage = std::optional<T>;
+  StaticVector<SinkEntry, LOGGABLE_MAX_SINKS> _sinkers;
+#else
+  /// Frees what emplace() built in the resource it came from
+  struct ResourceDelete {
+    std::pmr::memory_resource *resource;
+    template <typename T> void operator()(T *item) const noexcept {
+      std::destroy_at(item);
+      resource->deallocate(item, sizeof(T), alignof(T));
+    }
+  };
+  template <typename T> using Storage = std::unique_ptr<T, ResourceDelete>;
+  std::pmr::vector<SinkEntry> _sinkers;
+#endif
+  /// Set by init(); nullptr until then
+  std::atomic<std::pmr::memory_resource *> _memory_resource{nullptr};
+  size_t _next_slot{0};
+  std::atomic<size_t> _ordered_sinks{0};
+  /// Shared by the dispatch workers, exclusive for everything else
+  mutable std::shared_mutex _sinkers_mutex;
 
   // Async infrastructure
   static constexpr size_t QUEUE_CAPACITY = 128;
-  std::unique_ptr<RingBuffer<LogMessage, QUEUE_CAPACITY>> _queue;
+  static constexpr size_t PRIORITY_CAPACITY = 16;
+
+  /// A queued message and its acceptance order across both queues.
+  struct QueuedMessage {
+    LogMessage message;
+    uint32_t sequence{0};
+  };
+
+  /// Intrusive reference count next to the message; immutable while shared.
+  struct SharedNode {
+    std::atomic<uint32_t> refs{0};
+    LogMessage message;
+#ifdef LOGGABLE_NO_HEAP
+    std::atomic<SharedNode *> *free_list{nullptr}; ///< Returns to this list
+    SharedNode *next_free{nullptr};
+#else
+    std::pmr::memory_resource *resource{nullptr}; ///< Allocated from
+#endif
+  };
+
+  /**
+   * @brief Handle to a message the fan-out stages share instead of copying.
+   *
+   * Worker 0 shares a message once, when it goes to more than one
+   * worker or is held back for ordering sinks; every lane and the held
+   * list then pass the handle on. The last handle frees the node.
+   */
+  class SharedMessage {
+  public:
+    SharedMessage() noexcept = default;
+    SharedMessage(const SharedMessage &other) noexcept;
+    SharedMessage(SharedMessage &&other) noexcept
+        : _node(std::exchange(other._node, nullptr)) {}
+    SharedMessage &operator=(SharedMessage other) noexcept {
+      std::swap(_node, other._node);
+      return *this;
+    }
+    ~SharedMessage();
+
+    [[nodiscard]] const LogMessage &operator*() const noexcept { return _node->message; }
+    explicit operator bool() const noexcept { return _node != nullptr; }
+
+  private:
+    friend class Sinker;
+    explicit SharedMessage(SharedNode *node) noexcept : _node(node) {}
+    SharedNode *_node{nullptr};
+  };
+
+  /// A held priority message and its acceptance order.
+  struct HeldMessage {
+    SharedMessage message;
+    uint32_t sequence{0};
+  };
+
+  Storage<RingBuffer<QueuedMessage, QUEUE_CAPACITY>> _queue;
+  /// Signals through _queue, which is the only queue the worker waits on
+  Storage<RingBuffer<QueuedMessage, PRIORITY_CAPACITY>> _priority_queue;
+  std::atomic<uint32_t> _next_sequence{0};
+  std::atomic<LogLevel> _priority_level{LogLevel::None};
+  /// Worker-owned: priority messages awaiting their turn for ordering sinks
+#ifdef LOGGABLE_NO_HEAP
+  static constexpr size_t HELD_CAPACITY = PRIORITY_CAPACITY;
+  StaticDeque<HeldMessage, HELD_CAPACITY> _held;
+#else
+  static constexpr size_t HELD_CAPACITY = QUEUE_CAPACITY;
+  std::pmr::deque<HeldMessage> _held;
+#endif
+
+  // Adaptive level; producers racing with init() may read the settings
+  std::atomic<bool> _adaptive_level{false};
+  std::atomic<size_t> _high_watermark{0};
+  std::atomic<size_t> _low_watermark{0};
+  std::atomic<LogLevel> _shed_level{LogLevel::Info};
+  std::atomic<bool> _shedding{false};
+  std::atomic<size_t> _shed_count{0};
+
+  // Slow-sink breaker settings
+  std::atomic<uint32_t> _slow_sink_us{0};
+  std::atomic<uint32_t> _slow_sink_trips{0};
+  std::atomic<uint32_t> _sink_probe_ms{0};
+  size_t _reported_shed_count{0}; ///< Worker-owned
+  bool _reported_shedding{false};  ///< Worker-owned
+
+  // Window statistics; counters are updated lock-free on the hot paths,
+  // _stats_mutex only serializes readers, which also fold in the rate
+  std::atomic<size_t> _pending_peak{0};
+  std::atomic<bool> _above_high{false};
+  std::atomic<uint64_t> _above_since_us{0};
+  std::atomic<uint64_t> _above_us{0};
+  std::atomic<uint64_t> _busy_us{0};
+  mutable std::mutex _stats_mutex;
+  uint64_t _window_start_us{0};
+  mutable uint64_t _rate_at_us{0};
+  mutable uint32_t _rate_sequence{0};
+  mutable float _rate{0.0f};
+  static constexpr float RATE_TIME_CONSTANT_US = 5e6f;
+
+  // Overflow spill. Everything spilled is older than everything queued;
+  // _spill_mutex guards the store and the record buffer
+  std::shared_ptr<ISpillStore> _spill; ///< Owner; replaced only by init()
+  std::atomic<ISpillStore *> _spill_store{nullptr};
+  std::atomic<SpillPolicy> _spill_policy{SpillPolicy::Producer};
+  mutable std::mutex _spill_mutex;
+  std::vector<uint8_t> _spill_record;
+  std::atomic<size_t> _spill_pending{0};
+  std::atomic<size_t> _spilled{0};
+  std::atomic<size_t> _spill_dropped{0};
+  bool _spill_stalled{false}; ///< Worker-owned; the last read removed nothing
+  static constexpr uint32_t SPILL_RETRY_MS = 10;
+  os::BoundBackend *_queue_backend{nullptr};
   std::atomic<bool> _running{false};
   std::atomic<bool> _shutdown_requested{false};
+  std::atomic<size_t> _in_flight{0}; ///< Accepted but not yet dispatched
+  size_t _reported_dropped{0};       ///< Worker-owned
+  uint32_t _last_drop_report_ms{0};  ///< Worker-owned
+  bool _drop_reported{false};        ///< Worker-owned; false until the first report
+  static constexpr uint32_t DROP_REPORT_INTERVAL_MS = 1000;
+  std::mutex _lifecycle_mutex;       ///< Serializes init() and shutdown()
 
-  os::TaskHandle _task{};
+  /// Worker 0 drains _queue and fans out to the lanes of the others.
+#ifdef LOGGABLE_NO_HEAP
+  static constexpr size_t LANE_CAPACITY = LOGGABLE_LANE_CAPACITY;
+#else
+  static constexpr size_t LANE_CAPACITY = QUEUE_CAPACITY;
+#endif
+  struct LaneEntry {
+    SharedMessage message;
+    Audience audience{Audience::All};
+  };
+  using Lane = RingBuffer<LaneEntry, LANE_CAPACITY>;
+#ifdef LOGGABLE_NO_HEAP
+  /// Enough nodes for full lanes, a message in hand per worker and a full
+  /// held list, so sharing never fails
+  static constexpr size_t SHARED_NODES =
+      (SinkerConfig::MAX_WORKERS - 1) * (LANE_CAPACITY + 1) + HELD_CAPACITY + 1;
+  std::array<SharedNode, SHARED_NODES> _shared_slab{};
+  /// Free nodes; any worker pushes, only worker 0 pops, so no ABA
+  std::atomic<SharedNode *> _shared_free{nullptr};
+  bool _shared_slab_ready{false}; ///< Guarded by _lifecycle_mutex
+#endif
+  struct Worker {
+    Sinker *owner{nullptr};
+    size_t index{0};
+    Storage<Lane> lane; ///< Unused for worker 0; lives with _queue
+    os::TaskHandle task{};
+  };
+  std::array<Worker, SinkerConfig::MAX_WORKERS> _workers{};
+  std::atomic<size_t> _worker_count{1};
+  std::atomic<size_t> _workers_alive{0};
+  std::atomic<bool> _lanes_closed{false};
+
+  os::SemaphoreHandle _worker_done{}; ///< Given by the last worker to exit
+  os::EventHandle _drained{}; ///< Wakes flush() when capable; lives with _queue
+  std::atomic<size_t> _flush_waiters{0};
+  static constexpr uint32_t DRAINED_BIT = 1u << 0;
   static void _task_entry(void *arg) noexcept;
   void _process_queue() noexcept;
+  void _process_lane(size_t index) noexcept;
+  void _fan_out(LogMessage &&message, Audience audience) noexcept;
+  void _fan_out(const SharedMessage &message, Audience audience) noexcept;
+  /// Lanes with sinks for @p audience, a bit per worker; the caller holds _sinkers_mutex.
+  [[nodiscard]] uint32_t _lanes_for(Audience audience, size_t workers) const noexcept;
+  void _push_lanes(const SharedMessage &message, Audience audience, uint32_t lanes,
+                   size_t workers) noexcept;
+  [[nodiscard]] SharedMessage _share(LogMessage &&message) noexcept;
+  static void _release(SharedNode *node) noexcept;
+  bool _drain_priority() noexcept;
+  void _release_held(uint32_t before, bool all) noexcept;
+  void _deliver(QueuedMessage &&msg) noexcept;
+  [[nodiscard]] bool _spill_write(ISpillStore &store, const QueuedMessage &msg) noexcept;
+  [[nodiscard]] bool _spill_read(QueuedMessage &msg) noexcept;
+  [[nodiscard]] bool _divert(const QueuedMessage &msg) noexcept;
+  [[nodiscard]] bool _replay_spilled() noexcept;
+  void _close_lanes() noexcept;
+  /// Call on_idle() of one worker's sinks; the caller holds _sinkers_mutex.
+  [[nodiscard]] uint32_t _idle_sinks(size_t index, size_t workers) noexcept;
+  [[nodiscard]] size_t _dropped_total() const noexcept;
+  [[nodiscard]] static os::TaskConfig _worker_task_config(const SinkerConfig &config,
+                                                          size_t index) noexcept;
+  void _enqueue(LogMessage &&message) noexcept;
+  void _complete() noexcept;
+  uint32_t _report_drops(bool force) noexcept;
+  void _report_shedding() noexcept;
+  void _track_pending_up(size_t pending) noexcept;
+  void _track_pending_down(size_t pending) noexcept;
+  void _reset_window(uint64_t now_us) noexcept;
+  [[nodiscard]] SinkerMetrics _current_metrics() const noexcept;
+  /// Fill in the window statistics; the caller holds _stats_mutex.
+  void _window_metrics(SinkerMetrics &metrics, uint64_t now_us) const noexcept;
 
   /**
    * @brief Internal implementation of the dispatch logic.
    * @param message The message to dispatch.
    */
   void _dispatch_internal(const LogMessage &message) noexcept;
+
+  /// Hand @p message to one sink, through its slow-sink breaker.
+  void _consume(const SinkEntry &entry, const LogMessage &message) noexcept;
+
+  /**
+   * @brief Dispatch to the sinks assigned to one worker.
+   * @param message The message to dispatch.
+   * @param index The worker's index.
+   * @param workers The number of workers.
+   * @param audience Which of those sinks to deliver to.
+   */
+  void _dispatch_assigned(const LogMessage &message, size_t index,
+                          size_t workers, Audience audience) noexcept;
 };
 
+/**
+ * @brief Most verbose level whose timing spans are compiled in, as a
+ *        LogLevel value (0 = None ... 5 = Verbose).
+ *
+ * Define it for the library and every translation unit, e.g.
+ * `-DLOGGABLE_SPAN_LEVEL=3` to keep Info spans and compile out Debug and
+ * Verbose ones. See Logger::span().
+ */
+#ifndef LOGGABLE_SPAN_LEVEL
+#define LOGGABLE_SPAN_LEVEL 5
+#endif
+
+inline constexpr LogLevel SPAN_LEVEL = static_cast<LogLevel>(LOGGABLE_SPAN_LEVEL);
+
 /**
  * @brief Lightweight logger that formats and dispatches log messages.
  *
@@ -280,6 +999,13 @@ public:
    */
   void log(LogLevel level, std::string_view message) noexcept;
 
+  /**
+   * @brief Logs static text without copying it.
+   * @param level The message's severity level.
+   * @param message Text with static storage duration.
+   */
+  void log(LogLevel level, StaticText message) noexcept;
+
   /**
    * @brief Logs a fmt-style formatted message.
    * @param level The message's severity level.
@@ -290,16 +1016,130 @@ public:
   template <typename... Args>
   void logf(LogLevel level, fmt::format_string<Args...> format_str,
             Args &&...args) noexcept {
-    if (!is_log_level_enabled(level, Sinker::instance().get_level())) {
+    if (!is_log_level_enabled(level, Sinker::instance().get_effective_level())) {
       return;
     }
+#ifdef LOGGABLE_NO_HEAP
+    std::array<char, LOGGABLE_MAX_MESSAGE> buf;
+    const auto result = fmt::format_to_n(buf.data(), buf.size(), format_str,
+                                         std::forward<Args>(args)...);
+    log(level, std::string_view(buf.data(), std::min(result.size, buf.size())));
+#else
     fmt::memory_buffer buf;
     fmt::format_to(std::back_inserter(buf), format_str,
                    std::forward<Args>(args)...);
     log(level, std::string_view(buf.data(), buf.size()));
+#endif
+  }
+
+  /**
+   * @brief Logs a printf-style formatted message.
+   * @param level The message's severity level.
+   * @param format The printf-style format string.
+   * @param args Arguments for the format string.
+   */
+  void vlogf(LogLevel level, const char *format, va_list args) noexcept;
+
+  /**
+   * @brief Logs a printf-style line carrying its own ESP-IDF prefix.
+   *
+   * Intended as the body of an `esp_log_set_vprintf` hook: the line is
+   * formatted once, and level and tag are recovered from the leading
+   * `"I (1234) TAG: "` prefix instead of being re-formatted. Lines without
+   * a recognizable prefix are logged at Info level under this logger's tag.
+   * When the level letter is visible in the format string itself, disabled
+   * levels are rejected before any formatting takes place.
+   *
+   * @param format The printf-style format string.
+   * @param args Arguments for the format string.
+   * @return Number of characters formatted, also for a line that is
+   *         filtered out, or a negative value on error (vprintf semantics).
+   */
+  int vlog_line(const char *format, va_list args) noexcept;
+
+  /// Lines shorter than this are formatted once, on the stack; longer ones
+  /// are formatted again straight into the message's text.
+  static constexpr size_t LINE_BUFFER_SIZE = 192;
+
+  /**
+   * @brief Times a scope and logs its duration when it ends.
+   *
+   * Reads the backend's microsecond clock (IAsyncBackend::get_time_us())
+   * when created and when ended, then logs one `"<name>: <n> us"` message
+   * under the logger's tag, formatted on the stack. Nothing is timed if
+   * the level is disabled when the span starts.
+   */
+  class Span {
+  public:
+    Span() noexcept = default;
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+    Span(Span &&other) noexcept { *this = std::move(other); }
+    Span &operator=(Span &&other) noexcept;
+    ~Span() noexcept { end(); }
+
+    /// Time so far; 0 for a span that is not timing.
+    [[nodiscard]] uint64_t elapsed_us() const noexcept;
+
+    /// Stop timing and log the duration now; later calls do nothing.
+    void end() noexcept;
+
+    /// Stop timing without logging, e.g. on an error path.
+    void cancel() noexcept { _active = false; }
+
+  private:
+    friend class Logger;
+    Span(std::string_view tag, LogLevel level, std::string_view name,
+         uint32_t threshold_us) noexcept;
+
+    std::string_view _tag;
+    std::string_view _name;
+    uint64_t _start_us{0};
+    uint32_t _threshold_us{0};
+    LogLevel _level{LogLevel::None};
+    bool _active{false};
+  };
+
+  /**
+   * @brief Stand-in for Span when its level is compiled out; no code, no
+   *        state.
+   */
+  struct NullSpan {
+    [[nodiscard]] static constexpr uint64_t elapsed_us() noexcept { return 0; }
+    static constexpr void end() noexcept {}
+    static constexpr void cancel() noexcept {}
+  };
+
+  template <LogLevel Level>
+  using SpanFor =
+      std::conditional_t<is_log_level_enabled(Level, SPAN_LEVEL), Span, NullSpan>;
+
+  /**
+   * @brief Starts timing a scope: `auto span = logger.span("flash_write");`.
+   *
+   * Spans for levels above LOGGABLE_SPAN_LEVEL compile to nothing.
+   *
+   * @tparam Level The level of the duration message.
+   * @param name Names the span in the message; must outlive it, e.g. a
+   *             string literal.
+   * @param threshold_us Log only durations of at least this many
+   *                     microseconds; 0 logs every one.
+   */
+  template <LogLevel Level = LogLevel::Debug>
+  [[nodiscard]] SpanFor<Level> span(std::string_view name,
+                                    uint32_t threshold_us = 0) const noexcept {
+    if constexpr (is_log_level_enabled(Level, SPAN_LEVEL)) {
+      return Span(_tag, Level, name, threshold_us);
+    } else {
+      return {};
+    }
   }
 
 private:
+  static void _log(LogLevel level, std::string_view tag,
+                   std::string_view message) noexcept;
+  static void _log(LogLevel level, LogMessage::Tag tag, LogMessage::Text message) noexcept;
+
   std::string_view _tag;
 };
 
@@ -0,0 +1,65 @@
+#pragma once
+#include <type_traits>
+
+#include "loggable_os.hpp"
+
+/**
+ * @file loggable_backend.hpp
+ * @brief Selects how the core reaches its async backend.
+ *
+ * By default the backend is chosen at runtime with os::set_backend() and
+ * every OS call is a virtual call through IAsyncBackend.
+ *
+ * Defining LOGGABLE_BACKEND_TYPE (and LOGGABLE_BACKEND_HEADER, the header
+ * that declares it) binds one backend at compile time instead. The type
+ * must be a `final` class derived from IAsyncBackend with a static
+ * `instance()` accessor. RingBuffer and Sinker then call it through a
+ * pointer to the final type, so calls are devirtualized and, when the
+ * adapter defines its methods in the header, inlined; the atomic load of
+ * the runtime backend pointer disappears as well. Both definitions must be
+ * identical for the library and every translation unit that includes it.
+ */
+
+#if defined(LOGGABLE_BACKEND_TYPE)
+#if !defined(LOGGABLE_BACKEND_HEADER)
+#error "LOGGABLE_BACKEND_TYPE requires LOGGABLE_BACKEND_HEADER"
+#endif
+#include LOGGABLE_BACKEND_HEADER
+#endif
+
+namespace loggable {
+namespace os {
+
+#if defined(LOGGABLE_BACKEND_TYPE)
+
+/// Backend type the core is compiled against.
+using BoundBackend = LOGGABLE_BACKEND_TYPE;
+
+static_assert(std::is_base_of_v<IAsyncBackend, BoundBackend>,
+              "LOGGABLE_BACKEND_TYPE must derive from IAsyncBackend");
+static_assert(std::is_final_v<BoundBackend>,
+              "LOGGABLE_BACKEND_TYPE must be final so calls devirtualize");
+
+/**
+ * @brief Get the compile-time bound backend.
+ */
+[[nodiscard]] inline BoundBackend* bound_backend() noexcept {
+    return &BoundBackend::instance();
+}
+
+#else
+
+/// Backend type the core is compiled against.
+using BoundBackend = IAsyncBackend;
+
+/**
+ * @brief Get the backend registered with set_backend(), or nullptr.
+ */
+[[nodiscard]] inline BoundBackend* bound_backend() noexcept {
+    return get_backend();
+}
+
+#endif
+
+} // namespace os
+} // namespace loggable
@@ -0,0 +1,378 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "loggable.hpp"
+#include "loggable_lz.hpp"
+#include "loggable_record.hpp"
+
+/**
+ * @file loggable_block.hpp
+ * @brief Block-compressed binary log files.
+ *
+ * A file is a plain sequence of blocks, each holding a run of records
+ * (see loggable_record.hpp) compressed as one unit. Every block starts
+ * with a self-describing header, little-endian:
+ *
+ * | Offset | Size | Field                                           |
+ * |--------|------|-------------------------------------------------|
+ * | 0      | 4    | Magic, "LGBK"                                   |
+ * | 4      | 1    | Format version                                  |
+ * | 5      | 1    | Codec: 0 stored, 1 LZ (loggable_lz.hpp)         |
+ * | 6      | 2    | Header size, including extensions               |
+ * | 8      | 4    | Record count                                    |
+ * | 12     | 4    | Raw (decompressed) payload size                 |
+ * | 16     | 4    | Stored payload size                             |
+ * | 20     | 4    | CRC-32 of the stored payload                    |
+ * | 24     | 8    | Earliest record timestamp, ms                   |
+ * | 32     | 8    | Latest record timestamp, ms                     |
+ * | 40     | 4    | CRC-32 of the header, with this field zeroed    |
+ * | 44     | ...  | Extensions, then the stored payload             |
+ *
+ * Extensions are `u8 type, u16 length, bytes` sections; readers skip
+ * types they do not know. BlockFileSink writes a summary of each block
+ * there, so searches can skip blocks without decompressing them:
+ *
+ * - Levels (1): one byte, bit n set if a record has LogLevel n.
+ * - Bloom (2): the hash count, then a Bloom filter of the tags and
+ *   message tokens (see for_each_token()) of the block's records. Its
+ *   size is a power of two, folded down from
+ *   BlockFileConfig::summary_bits to suit the number of distinct keys.
+ *
+ * The raw payload holds the records with their timestamp fields zeroed,
+ * followed by a timestamp column: one zigzag varint per record, the first
+ * relative to the earliest timestamp and each other relative to the one
+ * before. Varying timestamps inside the records would break up LZ matches
+ * on otherwise repetitive text, roughly halving the compression ratio.
+ * Since each block carries its own magic and checksums, a reader can
+ * resynchronize after a torn write, and files can be concatenated.
+ *
+ * A sparse index of the blocks goes to a sidecar file, `<path>.idx`: an
+ * 8-byte header ("LGIX", version, entry size, reserved) followed by one
+ * fixed-size entry per block, little-endian:
+ *
+ * | Offset | Size | Field                                 |
+ * |--------|------|---------------------------------------|
+ * | 0      | 8    | Block offset in the log file          |
+ * | 8      | 4    | Block size, header included           |
+ * | 12     | 4    | Record count                          |
+ * | 16     | 8    | Earliest record timestamp, ms         |
+ * | 24     | 8    | Latest record timestamp, ms           |
+ * | 32     | 4    | CRC-32 of bytes 0-31                  |
+ *
+ * Readers stride by the entry size in the index header, so later versions
+ * can append fields. The index is only a shortcut: blocks it does not
+ * cover, such as one written just before a crash, are still found by
+ * scanning headers.
+ */
+
+namespace loggable {
+
+namespace block {
+
+inline constexpr uint32_t MAGIC = 0x4B42474C; // "LGBK"
+inline constexpr uint8_t VERSION = 1;
+inline constexpr size_t HEADER_SIZE = 44;
+
+enum class Codec : uint8_t { Stored = 0, Lz = 1 };
+
+enum class Extension : uint8_t { Levels = 1, Bloom = 2 };
+
+inline constexpr uint8_t BLOOM_HASHES = 3;
+
+inline constexpr uint32_t INDEX_MAGIC = 0x5849474C; // "LGIX"
+inline constexpr uint8_t INDEX_VERSION = 1;
+inline constexpr size_t INDEX_HEADER_SIZE = 8;
+inline constexpr size_t INDEX_ENTRY_SIZE = 36;
+
+struct BlockHeader {
+    Codec codec{Codec::Stored};
+    uint32_t record_count{0};
+    uint32_t raw_size{0};
+    uint32_t stored_size{0};
+    uint32_t payload_crc{0};
+    int64_t min_ms{0};
+    int64_t max_ms{0};
+    std::vector<uint8_t> extensions; ///< Raw extension sections
+};
+
+/**
+ * @brief Append the encoded header, checksum included, to @p out.
+ */
+void encode_header(const BlockHeader &header, std::vector<uint8_t> &out) noexcept;
+
+/**
+ * @brief Header size announced by the fixed part in @p data.
+ * @return 0 if @p data does not start with a plausible header.
+ */
+[[nodiscard]] size_t header_size(const uint8_t *data, size_t size) noexcept;
+
+/**
+ * @brief Parse and verify a complete header.
+ * @return false on a bad magic, version or checksum.
+ */
+[[nodiscard]] bool parse_header(const uint8_t *data, size_t size, BlockHeader &out) noexcept;
+
+/**
+ * @brief Call `fn(std::string_view)` for each token of @p text: each
+ *        maximal run of ASCII letters, digits and underscores.
+ */
+template <typename Fn>
+void for_each_token(std::string_view text, Fn &&fn) {
+    const auto is_token_char = [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+               c == '_';
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        if (i < text.size() && is_token_char(text[i])) {
+            continue;
+        }
+        if (i > start) {
+            fn(text.substr(start, i - start));
+        }
+        start = i + 1;
+    }
+}
+
+/// Bloom filter keys; tags and tokens hash apart even when equal.
+[[nodiscard]] uint64_t tag_hash(std::string_view tag) noexcept;
+[[nodiscard]] uint64_t token_hash(std::string_view token) noexcept;
+
+/**
+ * @brief Set the bits of @p hash in a filter of @p size bytes, a power of two.
+ */
+void bloom_add(uint8_t *bloom, size_t size, uint64_t hash) noexcept;
+
+/**
+ * @brief What a block's summary extensions rule out.
+ *
+ * Fields stay permissive when a block has no summary, as in files
+ * written before summaries existed.
+ */
+struct BlockSummary {
+    uint8_t levels{0xFF};           ///< Bit n set: may hold LogLevel n
+    const uint8_t *bloom{nullptr};  ///< Points into the header's extensions
+    size_t bloom_size{0};
+    uint8_t hashes{0};
+
+    [[nodiscard]] bool may_have(LogLevel level) const noexcept {
+        return (levels >> static_cast<uint8_t>(level)) & 1;
+    }
+
+    /// false only if no record of the block has this tag or token hash.
+    [[nodiscard]] bool may_contain(uint64_t hash) const noexcept;
+};
+
+/**
+ * @brief Read the summary of the block described by @p header.
+ *
+ * The result points into @p header and is valid as long as it is.
+ */
+[[nodiscard]] BlockSummary summary(const BlockHeader &header) noexcept;
+
+/**
+ * @brief One block, as listed in the index.
+ */
+struct IndexEntry {
+    uint64_t offset{0};
+    uint32_t size{0};
+    uint32_t record_count{0};
+    int64_t min_ms{0};
+    int64_t max_ms{0};
+};
+
+/**
+ * @brief Sidecar index file of the log file at @p path.
+ */
+[[nodiscard]] inline std::string index_path(const std::string &path) {
+    return path + ".idx";
+}
+
+void encode_index_header(std::vector<uint8_t> &out) noexcept;
+void encode_index_entry(const IndexEntry &entry, std::vector<uint8_t> &out) noexcept;
+
+/**
+ * @brief Parse and verify one entry of INDEX_ENTRY_SIZE or more bytes.
+ */
+[[nodiscard]] bool parse_index_entry(const uint8_t *data, IndexEntry &out) noexcept;
+
+/**
+ * @brief Read the index of the log file at @p path.
+ *
+ * Stops at the first damaged or partial entry.
+ *
+ * @return false if there is no usable index.
+ */
+bool load_index(const std::string &path, std::vector<IndexEntry> &entries) noexcept;
+
+/**
+ * @brief Call `fn(const record::RecordView&)` for each record in the raw
+ *        payload of the block described by @p header.
+ * @return false if the payload ends in a partial or invalid record.
+ */
+template <typename Fn>
+bool for_each_record(const BlockHeader &header, const std::vector<uint8_t> &raw, Fn &&fn) {
+    // Find the timestamp column behind the records
+    size_t column = 0;
+    record::RecordView view;
+    for (uint32_t i = 0; i < header.record_count; ++i) {
+        const size_t consumed = record::parse(raw.data() + column, raw.size() - column, view);
+        if (consumed == 0) {
+            return false;
+        }
+        column += consumed;
+    }
+
+    size_t pos = 0;
+    int64_t timestamp_ms = header.min_ms;
+    for (uint32_t i = 0; i < header.record_count; ++i) {
+        uint64_t delta = 0;
+        if (!record::get_varint(raw.data(), raw.size(), column, delta)) {
+            return false;
+        }
+        pos += record::parse(raw.data() + pos, raw.size() - pos, view);
+        timestamp_ms += record::unzigzag(delta);
+        view.timestamp_ms = timestamp_ms;
+        fn(view);
+    }
+    return column == raw.size();
+}
+
+} // namespace block
+
+/**
+ * @brief Options for BlockFileSink.
+ */
+struct BlockFileConfig {
+    size_t block_size = 16 * 1024; ///< Raw bytes gathered before a block is written
+    bool compress = true;          ///< LZ-compress blocks; stored as-is when it does not help
+    bool index = true;             ///< Maintain the `<path>.idx` block index
+    /// Bloom filter bits per block before folding, a power of two; 0 = no summaries
+    size_t summary_bits = 4096;
+    /// Also write a block once it spans this many ms of log time; 0 = only when full
+    uint32_t max_block_age_ms = 0;
+};
+
+/**
+ * @brief Sink appending block-compressed records to a file.
+ *
+ * Records are gathered in RAM and written a block at a time, so a crash
+ * loses at most the open block; call flush() before a planned reset.
+ * The block buffers and compressor state are allocated up front. Works
+ * on any C stdio filesystem. Read the file back with BlockFileReader or
+ * the `loggable_cat` host tool, or search it with run_query() or the
+ * `loggable_query` host tool.
+ */
+class BlockFileSink : public ISink {
+public:
+    struct Stats {
+        size_t blocks{0};
+        size_t records{0};
+        uint64_t raw_bytes{0};    ///< Encoded record bytes written
+        uint64_t stored_bytes{0}; ///< File bytes written, headers included
+        size_t write_errors{0};
+    };
+
+    explicit BlockFileSink(std::string path, BlockFileConfig config = {}) noexcept;
+    ~BlockFileSink() override;
+
+    BlockFileSink(const BlockFileSink &) = delete;
+    BlockFileSink &operator=(const BlockFileSink &) = delete;
+
+    void consume(const LogMessage &message) override;
+    [[nodiscard]] bool supports_static_text() const noexcept override { return true; }
+
+    /// Replaying the file later must give the logging order.
+    [[nodiscard]] bool requires_ordering() const noexcept override { return true; }
+
+    /**
+     * @brief Write the open block, even if it is not full.
+     * @return false on a write error.
+     */
+    bool flush() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return _file != nullptr; }
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    bool _write_block() noexcept;
+    void _write_summary() noexcept;
+
+    mutable std::mutex _mutex;
+    std::string _path;
+    BlockFileConfig _config;
+    std::FILE *_file{nullptr};
+    std::FILE *_index{nullptr};
+    std::vector<uint8_t> _raw;
+    std::vector<uint8_t> _column; ///< Timestamp deltas after the first record
+    int64_t _first_ms{0};
+    int64_t _last_ms{0};
+    uint8_t _levels{0};
+    std::vector<uint8_t> _bloom;
+    std::vector<uint8_t> _stored;
+    std::vector<uint8_t> _header_bytes;
+    std::unique_ptr<lz::CompressState> _lz;
+    block::BlockHeader _header;
+    Stats _stats;
+};
+
+/**
+ * @brief Sequential reader for block-compressed log files.
+ *
+ * Call next() for each header, then either read_payload() or
+ * skip_payload(). A damaged block is skipped by scanning forward to the
+ * next valid header.
+ */
+class BlockFileReader {
+public:
+    explicit BlockFileReader(const std::string &path) noexcept;
+    ~BlockFileReader();
+
+    BlockFileReader(const BlockFileReader &) = delete;
+    BlockFileReader &operator=(const BlockFileReader &) = delete;
+
+    [[nodiscard]] bool is_open() const noexcept { return _file != nullptr; }
+
+    /**
+     * @brief Read the next valid header, leaving the file at its payload.
+     * @return false at end of file.
+     */
+    bool next(block::BlockHeader &header) noexcept;
+
+    /**
+     * @brief Read, verify and decompress the payload of the last header.
+     * @return false on a checksum or decompression error.
+     */
+    bool read_payload(const block::BlockHeader &header, std::vector<uint8_t> &raw) noexcept;
+
+    /**
+     * @brief Move past the payload of the last header without reading it.
+     */
+    bool skip_payload(const block::BlockHeader &header) noexcept;
+
+    /**
+     * @brief Continue reading at @p offset, which should start a block.
+     */
+    bool seek(uint64_t offset) noexcept;
+
+    /// File offset of the header last returned by next().
+    [[nodiscard]] uint64_t block_offset() const noexcept { return _block_offset; }
+    /// Bytes skipped while looking for a valid header.
+    [[nodiscard]] uint64_t skipped_bytes() const noexcept { return _skipped; }
+
+private:
+    std::FILE *_file{nullptr};
+    uint64_t _offset{0};       ///< Current file position
+    uint64_t _block_offset{0};
+    uint64_t _skipped{0};
+    std::vector<uint8_t> _buffer;
+};
+
+} // namespace loggable
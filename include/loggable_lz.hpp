@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file loggable_lz.hpp
+ * @brief Small LZ77 block codec for log storage.
+ *
+ * The format follows LZ4's block layout: each sequence is a token byte
+ * (literal length in the high nibble, match length minus 4 in the low
+ * one, 15 meaning "more length bytes follow"), the literals, then a
+ * 16-bit little-endian match offset and any extra match length bytes.
+ * The final sequence carries literals only. Compression is a greedy
+ * single-pass hash match: fast and allocation-free, trading some ratio
+ * against LZ4's accelerated matcher.
+ */
+
+namespace loggable::lz {
+
+inline constexpr size_t HASH_BITS = 12;
+
+/**
+ * @brief Match-finder state; large enough to keep off small task stacks.
+ */
+struct CompressState {
+    std::array<uint32_t, size_t{1} << HASH_BITS> table{};
+};
+
+/**
+ * @brief Worst-case compressed size of @p size input bytes.
+ */
+[[nodiscard]] constexpr size_t compress_bound(size_t size) noexcept {
+    return size + size / 255 + 16;
+}
+
+/**
+ * @brief Compress @p size bytes from @p src into @p dst.
+ * @return Compressed size, or 0 if it does not fit in @p capacity.
+ */
+[[nodiscard]] size_t compress(const uint8_t *src, size_t size, uint8_t *dst,
+                              size_t capacity, CompressState &state) noexcept;
+
+/**
+ * @brief Decompress @p size bytes from @p src into @p dst.
+ *
+ * Safe against malformed input: never reads or writes out of bounds.
+ *
+ * @return Decompressed size, or 0 on malformed input or if the output
+ *         does not fit in @p capacity.
+ */
+[[nodiscard]] size_t decompress(const uint8_t *src, size_t size, uint8_t *dst,
+                                size_t capacity) noexcept;
+
+} // namespace loggable::lz
@@ -0,0 +1,279 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "loggable.hpp"
+#include "loggable_record.hpp"
+
+/**
+ * @file loggable_net.hpp
+ * @brief Network sinks.
+ *
+ * UdpSink packs many records into each datagram, in one of two formats:
+ *
+ * - Syslog: RFC 5424 lines, one per record, separated by '\n'. Collectors
+ *   that split datagrams on newlines (Vector, Fluent Bit, `nc -u`) read
+ *   them directly; set UdpSinkConfig::max_records to 1 for a strict
+ *   RFC 5426 receiver that expects one message per datagram.
+ * - Binary: an 8-byte header, then records as in loggable_record.hpp:
+ *
+ * | Offset | Size | Field                                  |
+ * |--------|------|----------------------------------------|
+ * | 0      | 4    | Magic, "LGDG"                          |
+ * | 4      | 4    | Datagram sequence number, to spot loss |
+ * | 8      | ...  | Records                                |
+ *
+ * Decode binary datagrams with net::parse_datagram().
+ *
+ * TcpSink streams the same records to a collector, either as RFC 5424
+ * messages with RFC 6587 octet-counting framing ("LEN SP MSG"), or as
+ * binary records back to back.
+ *
+ * Syslog messages carry the diagnostic context (see LogContext) as
+ * structured data; binary records do not.
+ */
+
+namespace loggable {
+
+namespace net {
+
+inline constexpr uint32_t DATAGRAM_MAGIC = 0x4744474C; // "LGDG"
+inline constexpr size_t DATAGRAM_HEADER_SIZE = 8;
+
+/**
+ * @brief Call `fn(const record::RecordView&)` for each record of a binary
+ *        datagram.
+ * @param sequence Set to the datagram's sequence number.
+ * @return false if the datagram is not a whole binary datagram.
+ */
+template <typename Fn>
+bool parse_datagram(const uint8_t *data, size_t size, uint32_t &sequence, Fn &&fn) {
+    if (size < DATAGRAM_HEADER_SIZE || record::get_u32(data) != DATAGRAM_MAGIC) {
+        return false;
+    }
+    sequence = record::get_u32(data + 4);
+    record::RecordView view;
+    for (size_t pos = DATAGRAM_HEADER_SIZE; pos < size;) {
+        const size_t consumed = record::parse(data + pos, size - pos, view);
+        if (consumed == 0) {
+            return false;
+        }
+        fn(view);
+        pos += consumed;
+    }
+    return true;
+}
+
+/// SD-ID of the diagnostic context in syslog messages; 32473 is the
+/// private enterprise number RFC 5612 reserves for examples.
+inline constexpr std::string_view CONTEXT_SD_ID = "ctx@32473";
+
+/**
+ * @brief Append the RFC 5424 line for a record, without a line break.
+ * @param context Rendered as STRUCTURED-DATA, e.g. `[ctx@32473 req="42"]`.
+ */
+void format_syslog(const record::RecordView &view, uint8_t facility,
+                   std::string_view hostname, std::string_view app_name,
+                   std::vector<uint8_t> &out, const LogContext *context = nullptr) noexcept;
+
+} // namespace net
+
+enum class NetFormat : uint8_t { Syslog, Binary };
+
+/**
+ * @brief Options for UdpSink.
+ */
+struct UdpSinkConfig {
+    std::string host = "127.0.0.1"; ///< IPv4 address or host name
+    uint16_t port = 514;
+    NetFormat format = NetFormat::Syslog;
+    /// Payload bytes per datagram; the default avoids IP fragmentation
+    size_t max_datagram = 1232;
+    size_t max_records = 0;         ///< Records per datagram; 0 = as many as fit
+    /// Bytes of full datagrams the socket may not take yet; beyond, the oldest is dropped
+    size_t max_buffered = 8 * 1024;
+    /// Hold a partial datagram this long for more records, once idle
+    uint32_t linger_ms = 20;
+    // Syslog header fields
+    uint8_t facility = 1;           ///< user-level
+    std::string hostname = "-";
+    std::string app_name = "loggable";
+};
+
+/**
+ * @brief Sink sending batches of records over UDP.
+ *
+ * Records are packed into datagrams of up to max_datagram bytes. A full
+ * datagram is sent right away; a partial one once the dispatch worker
+ * runs idle (see ISink::on_idle()) and linger_ms has passed. Sends never
+ * block: datagrams the socket refuses wait in a bounded buffer, allocated
+ * up front, and the oldest is dropped when it is full.
+ */
+class UdpSink : public ISink {
+public:
+    struct Stats {
+        size_t records{0};            ///< Records packed into datagrams
+        size_t datagrams_sent{0};
+        uint64_t bytes_sent{0};
+        size_t datagrams_dropped{0};  ///< Buffer full or send failed
+        size_t records_dropped{0};
+    };
+
+    explicit UdpSink(UdpSinkConfig config = {}) noexcept;
+    ~UdpSink() override;
+
+    UdpSink(const UdpSink &) = delete;
+    UdpSink &operator=(const UdpSink &) = delete;
+
+    void consume(const LogMessage &message) override;
+    [[nodiscard]] bool supports_static_text() const noexcept override { return true; }
+    uint32_t on_idle() noexcept override;
+
+    /**
+     * @brief Seal the open datagram and try to send everything buffered.
+     * @return false if datagrams are still waiting for the socket.
+     */
+    bool flush() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return _socket >= 0; }
+    [[nodiscard]] Stats stats() const noexcept;
+    [[nodiscard]] SinkBackpressure backpressure() const noexcept override;
+
+private:
+    struct Datagram {
+        std::vector<uint8_t> bytes;
+        size_t records{0};
+    };
+
+    [[nodiscard]] Datagram &_open_datagram() noexcept {
+        return _slots[(_head + _sealed) % _slots.size()];
+    }
+    void _seal() noexcept;
+    void _send_ready() noexcept;
+
+    mutable std::mutex _mutex;
+    UdpSinkConfig _config;
+    int _socket{-1};               ///< Connected to the receiver
+    std::vector<Datagram> _slots;  ///< Ring: sealed datagrams, then the open one
+    size_t _head{0};               ///< Oldest sealed datagram
+    size_t _sealed{0};
+    uint32_t _open_since_ms{0};
+    uint32_t _sequence{0};
+    std::vector<uint8_t> _scratch;
+    Stats _stats;
+};
+
+/**
+ * @brief Options for TcpSink.
+ */
+struct TcpSinkConfig {
+    std::string host = "127.0.0.1"; ///< IPv4 address or host name
+    uint16_t port = 514;
+    NetFormat format = NetFormat::Syslog;
+    /// Writes are coalesced up to this size, one TCP segment by default;
+    /// longer records are cut to fit
+    size_t batch_bytes = 1460;
+    /// Hold a partial batch this long for more records, once idle
+    uint32_t linger_ms = 20;
+    /// Memory for batches waiting on the collector, allocated up front
+    size_t buffer_bytes = 16 * 1024;
+    /// Takes the oldest batches once memory is full; none = drop them.
+    /// Give the sink its own store, not the Sinker's.
+    std::shared_ptr<ISpillStore> overflow_store{};
+    uint32_t backoff_min_ms = 100;  ///< First reconnect delay, doubled per failure
+    uint32_t backoff_max_ms = 30'000;
+    uint32_t connect_timeout_ms = 5'000;
+    // Syslog header fields
+    uint8_t facility = 1;
+    std::string hostname = "-";
+    std::string app_name = "loggable";
+};
+
+/**
+ * @brief Sink streaming batches of records to a TCP collector.
+ *
+ * Never blocks the dispatch worker: connecting and sending are
+ * non-blocking and driven from consume() and on_idle(). While the
+ * collector is unreachable, batches are kept in memory, then in
+ * overflow_store, and sent in order after reconnecting; reconnects back
+ * off exponentially. Records the kernel accepted before a connection
+ * broke may be lost, as TCP gives no delivery receipts. Buffering and
+ * drops are reported through backpressure() into SinkerMetrics.
+ */
+class TcpSink : public ISink {
+public:
+    struct Stats {
+        size_t records{0};          ///< Records accepted into batches
+        uint64_t bytes_sent{0};
+        size_t records_dropped{0};  ///< Buffers full, or a stored batch unreadable
+        size_t batches_stored{0};   ///< Batches moved to the overflow store
+        size_t connects{0};
+        size_t connect_failures{0};
+        size_t disconnects{0};
+    };
+
+    explicit TcpSink(TcpSinkConfig config = {}) noexcept;
+    ~TcpSink() override;
+
+    TcpSink(const TcpSink &) = delete;
+    TcpSink &operator=(const TcpSink &) = delete;
+
+    void consume(const LogMessage &message) override;
+    [[nodiscard]] bool supports_static_text() const noexcept override { return true; }
+    uint32_t on_idle() noexcept override;
+    [[nodiscard]] SinkBackpressure backpressure() const noexcept override;
+
+    /**
+     * @brief Seal the open batch and send what the connection takes now.
+     * @return true if nothing is left to send.
+     */
+    bool flush() noexcept;
+
+    [[nodiscard]] bool is_connected() const noexcept;
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    enum class State : uint8_t { Disconnected, Connecting, Connected };
+
+    struct Batch {
+        std::vector<uint8_t> bytes;
+        size_t records{0};
+    };
+
+    [[nodiscard]] Batch &_open_batch() noexcept {
+        return _slots[(_head + _sealed) % _slots.size()];
+    }
+    [[nodiscard]] bool _has_unsent() const noexcept;
+    void _seal() noexcept;
+    void _evict_oldest() noexcept;
+    [[nodiscard]] bool _next_batch() noexcept;
+    void _pump() noexcept;
+    [[nodiscard]] bool _connection_ready() noexcept;
+    void _close() noexcept; ///< Drop the connection and schedule a retry
+
+    mutable std::mutex _mutex;
+    TcpSinkConfig _config;
+    uint32_t _address{0};           ///< IPv4, network byte order; 0 = unresolved
+    int _socket{-1};
+    State _state{State::Disconnected};
+    uint32_t _retry_at_ms{0};
+    uint32_t _connect_started_ms{0};
+    uint32_t _backoff_ms{0};
+    std::vector<Batch> _slots;      ///< Ring: sealed batches, then the open one
+    size_t _head{0};
+    size_t _sealed{0};
+    uint32_t _open_since_ms{0};
+    Batch _inflight;                ///< Oldest batch, taken out of the ring or store
+    size_t _sent{0};                ///< Bytes of _inflight written
+    size_t _stored{0};              ///< Batches in the overflow store
+    std::vector<uint8_t> _scratch;  ///< One framed record
+    std::vector<uint8_t> _frame;    ///< Batch to or from the overflow store
+    Stats _stats;
+};
+
+} // namespace loggable
@@ -35,6 +35,34 @@ struct TaskHandle {
     }
 };
 
+/**
+ * @brief Opaque handle for an event group.
+ */
+struct EventHandle {
+    void* _handle{nullptr};
+
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return _handle != nullptr;
+    }
+
+    [[nodiscard]] bool operator==(const EventHandle& other) const noexcept {
+        return _handle == other._handle;
+    }
+};
+
+/**
+ * @brief Optional primitives a backend supports beyond binary semaphores.
+ *
+ * The core discovers these through IAsyncBackend::capabilities() and uses
+ * the cheapest available mechanism, falling back to binary semaphores and
+ * polling otherwise.
+ */
+struct Capabilities {
+    bool counting_semaphore{false}; ///< semaphore_create_counting()
+    bool task_notify{false};        ///< task_current(), task_notify(), task_notify_wait()
+    bool event_group{false};        ///< event_create() and friends
+};
+
 /**
  * @brief Configuration for task creation.
  */
@@ -92,6 +120,88 @@ public:
      */
     [[nodiscard]] virtual bool semaphore_take(SemaphoreHandle sem, uint32_t timeout_ms) noexcept = 0;
 
+    // --- Optional primitives ---
+
+    /**
+     * @brief Report which optional primitives this backend implements.
+     *
+     * The defaults below are only called when the matching flag is set.
+     */
+    [[nodiscard]] virtual Capabilities capabilities() const noexcept { return {}; }
+
+    /**
+     * @brief Create a counting semaphore (FreeRTOS: xSemaphoreCreateCounting).
+     *
+     * Destroyed, given and taken with the binary semaphore operations.
+     * @param max_count Maximum count; gives beyond it are ignored.
+     * @param initial_count Initial count.
+     * @return Handle to the semaphore, or invalid handle on failure.
+     */
+    [[nodiscard]] virtual SemaphoreHandle semaphore_create_counting(uint32_t /*max_count*/,
+                                                                    uint32_t /*initial_count*/) noexcept {
+        return {};
+    }
+
+    /**
+     * @brief Get the handle of the calling task.
+     * @return Handle, or invalid handle if the caller is not a backend task.
+     */
+    [[nodiscard]] virtual TaskHandle task_current() noexcept { return {}; }
+
+    /**
+     * @brief OR @p bits into a task's notification value and mark it pending
+     *        (FreeRTOS: xTaskNotify with eSetBits).
+     */
+    virtual void task_notify(TaskHandle /*task*/, uint32_t /*bits*/) noexcept {}
+
+    /**
+     * @brief Wait for a notification to the calling task
+     *        (FreeRTOS: xTaskNotifyWait(0, ULONG_MAX, ...)).
+     *
+     * A notification sent before the wait is latched and returns at once.
+     * @param timeout_ms Timeout in milliseconds, or WAIT_FOREVER.
+     * @param bits If not null, receives the notification value, which is
+     *             cleared on return.
+     * @return true if notified, false on timeout.
+     */
+    [[nodiscard]] virtual bool task_notify_wait(uint32_t /*timeout_ms*/,
+                                                uint32_t* /*bits*/ = nullptr) noexcept {
+        return false;
+    }
+
+    /**
+     * @brief Create an event group (FreeRTOS: xEventGroupCreate).
+     */
+    [[nodiscard]] virtual EventHandle event_create() noexcept { return {}; }
+
+    /**
+     * @brief Destroy an event group.
+     */
+    virtual void event_destroy(EventHandle /*event*/) noexcept {}
+
+    /**
+     * @brief Set bits, waking every task waiting on any of them.
+     */
+    virtual void event_set(EventHandle /*event*/, uint32_t /*bits*/) noexcept {}
+
+    /**
+     * @brief Clear bits.
+     */
+    virtual void event_clear(EventHandle /*event*/, uint32_t /*bits*/) noexcept {}
+
+    /**
+     * @brief Wait until any of @p bits is set.
+     * @param bits Bits to wait for.
+     * @param clear_on_exit Clear @p bits when returning successfully.
+     * @param timeout_ms Timeout in milliseconds, or WAIT_FOREVER.
+     * @return The waited-for bits that were set, or 0 on timeout.
+     */
+    [[nodiscard]] virtual uint32_t event_wait(EventHandle /*event*/, uint32_t /*bits*/,
+                                              bool /*clear_on_exit*/,
+                                              uint32_t /*timeout_ms*/) noexcept {
+        return 0;
+    }
+
     // --- Task operations ---
 
     /**
@@ -124,13 +234,26 @@ public:
      * @return Current time in milliseconds.
      */
     virtual uint32_t get_time_ms() noexcept = 0;
+
+    /**
+     * @brief Get the current time in microseconds (ESP-IDF: esp_timer_get_time).
+     *
+     * Used for metrics that need finer resolution than get_time_ms(); the
+     * default derives it from get_time_ms().
+     */
+    virtual uint64_t get_time_us() noexcept {
+        return static_cast<uint64_t>(get_time_ms()) * 1000u;
+    }
 };
 
 /**
  * @brief Set the async backend implementation.
  *
  * Must be called before Sinker::init() to enable async dispatch.
- * Thread-safe (uses atomic pointer).
+ * Thread-safe (uses atomic pointer). The backend must outlive the Sinker's
+ * queue, which keeps its semaphore across Sinker::shutdown().
+ * Has no effect when a backend is bound at compile time (see
+ * loggable_backend.hpp).
  *
  * @param backend Pointer to backend implementation. Pass nullptr to disable.
  */
@@ -138,7 +261,8 @@ void set_backend(IAsyncBackend* backend) noexcept;
 
 /**
  * @brief Get the current async backend.
- * @return Pointer to backend, or nullptr if none set.
+ * @return Pointer to backend, or nullptr if none set. Always the bound
+ *         backend when one is selected at compile time.
  */
 [[nodiscard]] IAsyncBackend* get_backend() noexcept;
 
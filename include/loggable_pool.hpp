@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace loggable {
+
+/**
+ * @brief Options for PayloadPool.
+ */
+struct PayloadPoolConfig {
+    static constexpr size_t CLASS_COUNT = 5;
+    static constexpr std::array<size_t, CLASS_COUNT> BLOCK_SIZES{32, 64, 128, 256, 512};
+
+    /// Blocks per size class, allocated up front from @ref upstream; at
+    /// most PayloadPool::MAX_BLOCKS
+    std::array<uint32_t, CLASS_COUNT> blocks{256, 256, 128, 64, 32};
+    /// Serves larger requests and classes that run out; nullptr selects
+    /// std::pmr::get_default_resource()
+    std::pmr::memory_resource *upstream = nullptr;
+};
+
+/**
+ * @brief Lock-free size-class pool for log payloads.
+ *
+ * A std::pmr::memory_resource meant for SinkerConfig::memory_resource:
+ * producers allocate message text and lane messages, the dispatch
+ * workers free them. Each size class is one slab of equal blocks taken
+ * from the upstream resource at construction. Every thread keeps a few
+ * free blocks of each class for itself and exchanges them in batches
+ * with a lock-free free list shared by all threads, so blocks freed by
+ * a worker are reused by the producers without a lock or a call into
+ * malloc. Requests larger than 512 bytes, aligned beyond
+ * std::max_align_t, or for a class with no block left go to the
+ * upstream resource.
+ *
+ * A thread keeps blocks for up to CACHED_POOLS pools at once. Moving to
+ * a further pool hands the blocks of one of them back, under a lock
+ * shared by all pools, so a thread should not cycle through more pools
+ * than that.
+ *
+ * Destroy the pool only once nothing allocated from it is in use and no
+ * thread allocates from it any more.
+ */
+class PayloadPool final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t CLASS_COUNT = PayloadPoolConfig::CLASS_COUNT;
+    /// Free blocks a thread keeps per class, at most
+    static constexpr size_t CACHE_BLOCKS = 32;
+    /// Pools a thread keeps free blocks for at once
+    static constexpr size_t CACHED_POOLS = 2;
+    /// Blocks per class, at most; the free list head packs a block index
+    /// into 16 bits
+    static constexpr uint32_t MAX_BLOCKS = 0xffff;
+
+    struct SizeClass {
+        size_t block_size{0};
+        size_t capacity{0};    ///< Blocks in the slab
+        size_t in_use{0};      ///< Handed out and not yet freed
+        size_t peak_in_use{0};
+        size_t exhausted{0};   ///< Requests passed upstream for lack of a block
+    };
+
+    struct Stats {
+        std::array<SizeClass, CLASS_COUNT> classes{};
+        size_t oversize{0}; ///< Requests no class can hold, passed upstream
+    };
+
+    explicit PayloadPool(PayloadPoolConfig config = {}) noexcept;
+    ~PayloadPool() override;
+
+    PayloadPool(const PayloadPool &) = delete;
+    PayloadPool &operator=(const PayloadPool &) = delete;
+
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    struct ThreadCache;
+
+    struct Class {
+        std::byte *slab{nullptr};
+        /// Free list links, index + 1 of the next free block; 0 ends the list
+        std::atomic<uint32_t> *next{nullptr};
+        uint32_t capacity{0};
+        uint32_t cache_limit{0}; ///< Blocks a thread keeps before returning some
+        /// Shared free list: index + 1 of the first block in the lower
+        /// half, and a tag that changes with every update against ABA in
+        /// the upper half. 32 bits, so lock-free on 32-bit targets too.
+        std::atomic<uint32_t> head{0};
+        std::atomic<size_t> in_use{0};
+        std::atomic<size_t> peak_in_use{0};
+        std::atomic<size_t> exhausted{0};
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    [[nodiscard]] ThreadCache &_cache() noexcept;
+    void _attach(ThreadCache &cache) noexcept;
+    void _detach(ThreadCache &cache) noexcept;
+    [[nodiscard]] uint32_t _pop(Class &cls) noexcept;
+    void _push(Class &cls, const uint32_t *indices, size_t count) noexcept;
+
+    std::pmr::memory_resource *_upstream;
+    std::array<Class, CLASS_COUNT> _classes;
+    std::atomic<size_t> _oversize{0};
+    ThreadCache *_caches{nullptr}; ///< Threads holding blocks of this pool
+};
+
+} // namespace loggable
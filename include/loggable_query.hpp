@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "loggable_block.hpp"
+
+/**
+ * @file loggable_query.hpp
+ * @brief Search block-compressed log files without reading all of them.
+ *
+ * Blocks whose time span misses the query are skipped using the sidecar
+ * index (see loggable_block.hpp), and blocks whose summary rules out the
+ * levels, tags or words asked for are skipped using their headers, so
+ * only blocks that may match are read and decompressed. Without an index,
+ * or past its end, block headers are scanned instead, which still skips
+ * the payloads of non-matching blocks.
+ */
+
+namespace loggable {
+
+/**
+ * @brief Which records a query returns. All conditions must hold.
+ */
+struct LogQuery {
+    int64_t from_ms = std::numeric_limits<int64_t>::min(); ///< Inclusive
+    int64_t to_ms = std::numeric_limits<int64_t>::max();   ///< Inclusive
+    LogLevel most_severe = LogLevel::Error;    ///< Level range, inclusive
+    LogLevel least_severe = LogLevel::Verbose;
+    std::vector<std::string> tags;             ///< Any of these; empty = all tags
+    /// All of these message tokens, each as split by block::for_each_token()
+    std::vector<std::string> words;
+
+    /// Could a block spanning [@p min_ms, @p max_ms] hold a match?
+    [[nodiscard]] bool overlaps(int64_t min_ms, int64_t max_ms) const noexcept {
+        return max_ms >= from_ms && min_ms <= to_ms;
+    }
+
+    /// Could the block with this header hold a match, going by its summary?
+    [[nodiscard]] bool may_match(const block::BlockHeader &header) const noexcept;
+
+    [[nodiscard]] bool matches(const record::RecordView &view) const noexcept;
+};
+
+/**
+ * @brief What run_query() had to read.
+ */
+struct QueryStats {
+    size_t blocks_total{0};    ///< Blocks found in the file
+    size_t blocks_read{0};     ///< Blocks read and decompressed
+    size_t blocks_filtered{0}; ///< In the time range but ruled out by the summary
+    size_t blocks_damaged{0};
+    size_t records_matched{0};
+    bool used_index{false};    ///< false if the index was missing or stale
+};
+
+/**
+ * @brief Call @p fn with each record of the log file at @p path that
+ *        matches @p query, in file order.
+ *
+ * The view passed to @p fn is only valid during the call.
+ */
+QueryStats run_query(const std::string &path, const LogQuery &query,
+                     const std::function<void(const record::RecordView &)> &fn);
+
+} // namespace loggable
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "loggable.hpp"
+
+/**
+ * @file loggable_record.hpp
+ * @brief Compact binary encoding of a LogMessage.
+ *
+ * Used wherever messages leave memory: the overflow spill store and the
+ * binary log formats built on it. All integers are little-endian:
+ *
+ * | Offset | Size | Field                                  |
+ * |--------|------|----------------------------------------|
+ * | 0      | 8    | Timestamp, ms since the clock's epoch  |
+ * | 8      | 1    | LogLevel                               |
+ * | 9      | 1    | Tag length                             |
+ * | 10     | 2    | Message length                         |
+ * | 12     | ...  | Tag bytes, then message bytes          |
+ *
+ * Tags longer than MAX_TAG_SIZE and messages longer than
+ * MAX_MESSAGE_SIZE bytes are truncated.
+ */
+
+namespace loggable::record {
+
+inline constexpr size_t HEADER_SIZE = 12;
+inline constexpr size_t MAX_TAG_SIZE = 0xFF;
+inline constexpr size_t MAX_MESSAGE_SIZE = 0xFFFF;
+
+/**
+ * @brief A decoded record, pointing into the buffer it was parsed from.
+ */
+struct RecordView {
+    int64_t timestamp_ms{0};
+    LogLevel level{LogLevel::None};
+    std::string_view tag;
+    std::string_view message;
+};
+
+/**
+ * @brief Bytes encode() appends for @p message.
+ */
+[[nodiscard]] size_t encoded_size(const LogMessage &message) noexcept;
+
+/**
+ * @brief Append the encoding of @p message to @p out.
+ * @param max_size Cut the message text, then the tag, so the record takes
+ *                 at most this many bytes (never less than HEADER_SIZE).
+ * @return Bytes appended.
+ */
+size_t encode(const LogMessage &message, std::vector<uint8_t> &out,
+              size_t max_size = SIZE_MAX) noexcept;
+
+/**
+ * @brief Parse one record from the front of @p data without copying.
+ * @return Bytes consumed, or 0 if @p data does not start with a whole,
+ *         valid record.
+ */
+[[nodiscard]] size_t parse(const uint8_t *data, size_t size, RecordView &out) noexcept;
+
+/**
+ * @brief Parse one record from the front of @p data into a LogMessage.
+ * @return Bytes consumed, or 0 on a truncated or invalid record.
+ */
+[[nodiscard]] size_t decode(const uint8_t *data, size_t size, LogMessage &out) noexcept;
+
+/**
+ * @brief CRC-32 (IEEE 802.3), continuing from @p crc for chunked input.
+ */
+[[nodiscard]] uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0) noexcept;
+
+/**
+ * @brief Little-endian helpers shared by the binary formats.
+ */
+inline void put_u16(std::vector<uint8_t> &out, uint16_t value) noexcept {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+inline void put_u32(std::vector<uint8_t> &out, uint32_t value) noexcept {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+inline void put_u64(std::vector<uint8_t> &out, uint64_t value) noexcept {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+[[nodiscard]] inline uint16_t get_u16(const uint8_t *data) noexcept {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+[[nodiscard]] inline uint32_t get_u32(const uint8_t *data) noexcept {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+[[nodiscard]] inline uint64_t get_u64(const uint8_t *data) noexcept {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Append @p value as a LEB128 varint: 7 bits per byte, low first.
+ */
+inline void put_varint(std::vector<uint8_t> &out, uint64_t value) noexcept {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief Read a varint at @p pos, advancing it.
+ * @return false on truncated or overlong input.
+ */
+[[nodiscard]] inline bool get_varint(const uint8_t *data, size_t size, size_t &pos,
+                                     uint64_t &value) noexcept {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        const uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Zigzag mapping, so small negative deltas also make short varints.
+[[nodiscard]] constexpr uint64_t zigzag(int64_t value) noexcept {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+[[nodiscard]] constexpr int64_t unzigzag(uint64_t value) noexcept {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace loggable::record
@@ -2,38 +2,70 @@
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <optional>
 
-#include "loggable_os.hpp"
+#include "loggable_backend.hpp"
 
 namespace loggable {
 
 /**
  * @brief Thread-safe ring buffer with "drop oldest" overflow policy.
  *
- * When buffer is full, push() overwrites the oldest entry.
- * If a backend is provided, pop() blocks until data is available using
- * semaphore signaling. Without a backend, pop() returns immediately if empty.
+ * When buffer is full, push() overwrites the oldest entry, optionally
+ * handing it to an eviction handler first.
+ * If a backend is provided, pop() blocks until data is available. The
+ * wakeup mechanism is picked from the backend's capabilities:
+ * - Notify: a consumer task bound with bind_consumer() is woken with a
+ *   direct task notification, sent only when the buffer turns non-empty.
+ * - Counting: a counting semaphore mirrors the item count, so any number
+ *   of consumers can wait without re-signaling.
+ * - Binary: a binary semaphore, re-given while items remain.
+ * Without a backend, pop() returns immediately if empty.
  *
  * @tparam T Element type (must be move-constructible)
  * @tparam Capacity Fixed buffer capacity
+ * @tparam Backend Backend type; a final type makes semaphore calls direct
  */
-template <typename T, size_t Capacity>
+template <typename T, size_t Capacity, typename Backend = os::BoundBackend>
 class RingBuffer {
     static_assert(Capacity > 0, "Capacity must be greater than 0");
 
 public:
+    /**
+     * @brief Mechanism used to wake a consumer blocked in pop().
+     */
+    enum class Signaling : uint8_t {
+        None,     ///< No backend: pop() never blocks
+        Binary,   ///< Binary semaphore
+        Counting, ///< Counting semaphore
+        Notify    ///< Task notification to the bound consumer
+    };
+
+    /// Notification bit used in Notify mode.
+    static constexpr uint32_t NOTIFY_BIT = 1u << 0;
+
     /**
      * @brief Construct a ring buffer.
      * @param backend Optional async backend for semaphore operations.
      *                If nullptr, blocking operations are disabled.
      */
-    explicit RingBuffer(os::IAsyncBackend* backend = nullptr) noexcept
+    explicit RingBuffer(Backend* backend = nullptr) noexcept
         : _backend(backend) {
-        if (_backend) {
+        if (!_backend) {
+            return;
+        }
+        _caps = _backend->capabilities();
+        if (_caps.counting_semaphore) {
+            _sem = _backend->semaphore_create_counting(static_cast<uint32_t>(Capacity), 0);
+            _sem_signaling = _sem ? Signaling::Counting : Signaling::None;
+        }
+        if (!_sem) {
             _sem = _backend->semaphore_create_binary();
+            _sem_signaling = _sem ? Signaling::Binary : Signaling::None;
         }
+        _signaling = _sem_signaling;
     }
 
     ~RingBuffer() {
@@ -45,21 +77,83 @@ public:
     RingBuffer(const RingBuffer&) = delete;
     RingBuffer& operator=(const RingBuffer&) = delete;
 
+    /**
+     * @brief Bind (or, with an invalid handle, unbind) the single consumer.
+     *
+     * With a task-notify capable backend, a bound consumer is woken by task
+     * notifications instead of the semaphore. Must be called by the consumer
+     * itself, and the consumer must unbind before it is deleted.
+     *
+     * @param consumer The consumer task, usually backend->task_current().
+     * @return true if Notify signaling is now in use.
+     */
+    bool bind_consumer(os::TaskHandle consumer) noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const Signaling previous = _signaling;
+        if (consumer && _caps.task_notify) {
+            _consumer = consumer;
+            _signaling = Signaling::Notify;
+        } else {
+            _consumer = os::TaskHandle{};
+            _signaling = _sem_signaling;
+        }
+
+        // Keep the counting semaphore in step with the items it mirrors,
+        // carrying a pending wakeup (such as a signal()) over as a notification
+        if (previous == Signaling::Counting && _signaling == Signaling::Notify) {
+            bool pending = false;
+            while (_backend->semaphore_take(_sem, 0)) {
+                pending = true;
+            }
+            if (pending) {
+                _backend->task_notify(_consumer, NOTIFY_BIT);
+            }
+        } else if (previous == Signaling::Notify && _signaling == Signaling::Counting) {
+            for (size_t i = 0; i < _count; ++i) {
+                _backend->semaphore_give(_sem);
+            }
+        }
+        return _signaling == Signaling::Notify;
+    }
+
     /**
      * @brief Push an item, dropping oldest if full.
      * @param item Item to push (moved into buffer)
      * @return true if space was available, false if oldest was dropped
      */
     bool push(T item) noexcept {
+        return push(std::move(item), [](T&& /*evicted*/) noexcept { return false; });
+    }
+
+    /**
+     * @brief Push an item, handing the oldest to @p on_evict if full.
+     *
+     * @p on_evict runs under the buffer lock, so no pop() can overtake the
+     * evicted item; it must not call back into this buffer.
+     *
+     * @param item Item to push (moved into buffer)
+     * @param on_evict Called as `bool(T&&)` with the evicted item; returns
+     *                 true if it kept the item, which then does not count
+     *                 as dropped
+     * @return true unless the oldest item was evicted and not kept
+     */
+    template <typename OnEvict>
+    bool push(T item, OnEvict&& on_evict) noexcept {
         std::lock_guard<std::mutex> lock(_mutex);
 
+        const bool was_empty = _count == 0;
+        bool evicted = false;
         bool dropped = false;
         if (_count == Capacity) {
-            // Buffer full - drop oldest by advancing tail
+            // Buffer full - evict oldest by advancing tail
+            T oldest = std::move(_buffer[_tail]);
             _tail = (_tail + 1) % Capacity;
             --_count;
-            _dropped_count.fetch_add(1, std::memory_order_relaxed);
-            dropped = true;
+            evicted = true;
+            if (!on_evict(std::move(oldest))) {
+                _dropped_count.fetch_add(1, std::memory_order_relaxed);
+                dropped = true;
+            }
         }
 
         _buffer[_head] = std::move(item);
@@ -67,8 +161,24 @@ public:
         ++_count;
 
         // Signal waiting consumer
-        if (_backend && _sem) {
+        switch (_signaling) {
+        case Signaling::Notify:
+            // The consumer only waits after seeing the buffer empty
+            if (was_empty) {
+                _backend->task_notify(_consumer, NOTIFY_BIT);
+            }
+            break;
+        case Signaling::Counting:
+            // An overwrite leaves the item count unchanged
+            if (!evicted) {
+                _backend->semaphore_give(_sem);
+            }
+            break;
+        case Signaling::Binary:
             _backend->semaphore_give(_sem);
+            break;
+        case Signaling::None:
+            break;
         }
 
         return !dropped;
@@ -76,31 +186,42 @@ public:
 
     /**
      * @brief Pop an item, blocking until available or timeout.
+     *
+     * May return nullopt before the timeout after signal() or a stale
+     * wakeup; callers are expected to loop.
+     *
      * @param timeout_ms Timeout in milliseconds (WAIT_FOREVER for infinite)
      * @return Item if available within timeout, nullopt otherwise
      */
     std::optional<T> pop(uint32_t timeout_ms = os::WAIT_FOREVER) noexcept {
-        // Wait for signal that data is available (if backend exists)
-        if (_backend && _sem && !_backend->semaphore_take(_sem, timeout_ms)) {
-            return std::nullopt;
+        Signaling signaling;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            signaling = _signaling;
+            // Counting units are consumed one per item, so always take first
+            if (signaling != Signaling::Counting && _count > 0) {
+                return _take_locked(false);
+            }
         }
 
-        std::lock_guard<std::mutex> lock(_mutex);
-
-        if (_count == 0) {
+        if (signaling == Signaling::None ||
+            (timeout_ms == 0 && signaling != Signaling::Counting)) {
             return std::nullopt;
         }
 
-        T item = std::move(_buffer[_tail]);
-        _tail = (_tail + 1) % Capacity;
-        --_count;
-
-        // If more items remain, re-signal for next pop
-        if (_count > 0 && _backend && _sem) {
-            _backend->semaphore_give(_sem);
+        // Wait for signal that data is available
+        const bool woken = signaling == Signaling::Notify
+                               ? _backend->task_notify_wait(timeout_ms, nullptr)
+                               : _backend->semaphore_take(_sem, timeout_ms);
+        if (!woken) {
+            return std::nullopt;
         }
 
-        return item;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count == 0) {
+            return std::nullopt;
+        }
+        return _take_locked(signaling == Signaling::Binary);
     }
 
     /**
@@ -131,16 +252,46 @@ public:
      */
     [[nodiscard]] static constexpr size_t capacity() noexcept { return Capacity; }
 
+    /**
+     * @brief Get the wakeup mechanism currently in use.
+     */
+    [[nodiscard]] Signaling signaling() const noexcept {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _signaling;
+    }
+
     /**
      * @brief Signal to unblock any waiting pop() calls.
      */
     void signal() noexcept {
-        if (_backend && _sem) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        switch (_signaling) {
+        case Signaling::Notify:
+            _backend->task_notify(_consumer, NOTIFY_BIT);
+            break;
+        case Signaling::Counting:
+        case Signaling::Binary:
             _backend->semaphore_give(_sem);
+            break;
+        case Signaling::None:
+            break;
         }
     }
 
 private:
+    T _take_locked(bool took_binary) noexcept {
+        T item = std::move(_buffer[_tail]);
+        _tail = (_tail + 1) % Capacity;
+        --_count;
+
+        // A binary semaphore wakes one waiter per give: pass the unit on
+        // while items remain so other consumers are not stranded
+        if (took_binary && _count > 0) {
+            _backend->semaphore_give(_sem);
+        }
+        return item;
+    }
+
     std::array<T, Capacity> _buffer{};
     size_t _head{0};
     size_t _tail{0};
@@ -148,8 +299,12 @@ private:
     mutable std::mutex _mutex;
     std::atomic<size_t> _dropped_count{0};
 
-    os::IAsyncBackend* _backend{nullptr};
+    Backend* _backend{nullptr};
+    os::Capabilities _caps{};
     os::SemaphoreHandle _sem{};
+    Signaling _sem_signaling{Signaling::None}; ///< Mode when no consumer is bound
+    Signaling _signaling{Signaling::None};
+    os::TaskHandle _consumer{};
 };
 
 } // namespace loggable
@@ -0,0 +1,187 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "loggable.hpp"
+#include "loggable_record.hpp"
+
+/**
+ * @file loggable_serial.hpp
+ * @brief Framed transport for binary records over a serial line.
+ *
+ * Each record travels in its own frame. The frame content is Consistent
+ * Overhead Byte Stuffing (COBS) encoded, so it contains no zero bytes,
+ * and a zero byte sits on each side of it. Before encoding, the content
+ * is:
+ *
+ * | Offset | Size | Field                                        |
+ * |--------|------|----------------------------------------------|
+ * | 0      | 2    | Frame sequence number, to spot lost frames   |
+ * | 2      | ...  | One record as in loggable_record.hpp         |
+ * | end-4  | 4    | CRC-32 of the sequence number and the record |
+ *
+ * A receiver that joins mid-stream, or loses or garbles bytes, discards
+ * the damaged frame and picks up again at the next zero byte. Console
+ * text sharing the line is dropped the same way. Decode a byte stream
+ * with serial::FrameDecoder.
+ */
+
+namespace loggable {
+
+namespace serial {
+
+inline constexpr uint8_t DELIMITER = 0;
+/// Sequence number and CRC around each record.
+inline constexpr size_t FRAME_OVERHEAD = 6;
+
+/**
+ * @brief Append the COBS encoding of @p data: one extra byte per 254, no zeros.
+ */
+void cobs_encode(const uint8_t *data, size_t size, std::vector<uint8_t> &out) noexcept;
+
+/**
+ * @brief Replace @p out with the data COBS encoded in @p data.
+ * @return false if @p data is not a valid encoding.
+ */
+[[nodiscard]] bool cobs_decode(const uint8_t *data, size_t size,
+                               std::vector<uint8_t> &out) noexcept;
+
+/**
+ * @brief Append the frame carrying an encoded @p record, delimiters included.
+ * @param payload Scratch buffer for the frame content.
+ */
+void encode_frame(const uint8_t *record, size_t size, uint16_t sequence,
+                  std::vector<uint8_t> &payload, std::vector<uint8_t> &out) noexcept;
+
+/**
+ * @brief Incremental decoder for a framed byte stream.
+ *
+ * Feed bytes as they arrive, in chunks of any size. Records are passed
+ * to the callback as views into the decoder, valid until it returns.
+ */
+class FrameDecoder {
+public:
+    struct Stats {
+        size_t frames{0};        ///< Records decoded
+        size_t bad_frames{0};    ///< Failed COBS, CRC or record checks, or overlong
+        size_t lost_frames{0};   ///< Gaps in the sequence numbers
+        uint64_t bytes{0};
+    };
+
+    /**
+     * @param max_frame Longer frames are discarded without buffering them.
+     */
+    explicit FrameDecoder(size_t max_frame = 4096) noexcept : _max_frame(max_frame) {
+        _frame.reserve(max_frame);
+        _payload.reserve(max_frame);
+    }
+
+    /**
+     * @brief Call `fn(const record::RecordView&)` for each record completed by @p data.
+     */
+    template <typename Fn>
+    void feed(const uint8_t *data, size_t size, Fn &&fn) {
+        _stats.bytes += size;
+        for (size_t i = 0; i < size; ++i) {
+            if (data[i] != DELIMITER) {
+                if (_frame.size() < _max_frame) {
+                    _frame.push_back(data[i]);
+                } else {
+                    _overlong = true;
+                }
+                continue;
+            }
+            record::RecordView view;
+            if (_finish(view)) {
+                fn(view);
+            }
+        }
+    }
+
+    [[nodiscard]] Stats stats() const noexcept { return _stats; }
+
+private:
+    /// End of the buffered frame: check and decode it, then reset.
+    [[nodiscard]] bool _finish(record::RecordView &view) noexcept;
+
+    size_t _max_frame;
+    std::vector<uint8_t> _frame;   ///< Bytes since the last delimiter
+    std::vector<uint8_t> _payload; ///< Decoded frame content
+    bool _overlong{false};
+    bool _synced{false};           ///< A frame has been decoded; gaps count from there
+    uint16_t _expected{0};
+    Stats _stats;
+};
+
+} // namespace serial
+
+/**
+ * @brief Options for SerialSink.
+ */
+struct SerialSinkConfig {
+    size_t max_record = 512;    ///< Longer records are cut to this size
+    /// Frames the port has not taken yet, allocated up front; beyond,
+    /// new frames are dropped and show as sequence gaps
+    size_t buffer_bytes = 4096;
+};
+
+/**
+ * @brief Sink writing framed binary records to a serial port.
+ *
+ * Writes to a file descriptor: a UART opened through the ESP-IDF VFS
+ * ("/dev/uart/1"), or a tty or pty on a host. Open it with O_NONBLOCK so
+ * a slow line never stalls the dispatch worker; frames the port does not
+ * take wait in a bounded buffer and are retried from on_idle(). At
+ * 921600 baud that is about 90 KB of records a second. The descriptor is
+ * not closed by the sink. Read the line on a host with the
+ * `loggable_serial` tool or serial::FrameDecoder.
+ */
+class SerialSink : public ISink {
+public:
+    struct Stats {
+        size_t frames{0};         ///< Frames accepted into the buffer
+        uint64_t bytes_written{0};
+        size_t frames_dropped{0}; ///< Buffer full
+        size_t write_errors{0};   ///< Failed writes; the buffered bytes are discarded
+    };
+
+    explicit SerialSink(int fd, SerialSinkConfig config = {}) noexcept;
+    ~SerialSink() override;
+
+    SerialSink(const SerialSink &) = delete;
+    SerialSink &operator=(const SerialSink &) = delete;
+
+    void consume(const LogMessage &message) override;
+    [[nodiscard]] bool supports_static_text() const noexcept override { return true; }
+    uint32_t on_idle() noexcept override;
+    [[nodiscard]] SinkBackpressure backpressure() const noexcept override;
+
+    /// Sequence numbers let the receiver count losses, not reorderings.
+    [[nodiscard]] bool requires_ordering() const noexcept override { return true; }
+
+    /**
+     * @brief Write what the port takes now.
+     * @return true if nothing is left to write.
+     */
+    bool flush() noexcept;
+
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    void _write_pending() noexcept;
+
+    mutable std::mutex _mutex;
+    int _fd;
+    SerialSinkConfig _config;
+    std::vector<uint8_t> _pending; ///< Encoded frames, from _written on
+    size_t _written{0};
+    uint16_t _sequence{0};
+    std::vector<uint8_t> _record;
+    std::vector<uint8_t> _payload;
+    std::vector<uint8_t> _frame;
+    Stats _stats;
+};
+
+} // namespace loggable
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace loggable {
+
+/**
+ * @brief Storage for messages the async queue has no room for.
+ *
+ * Holds opaque records in FIFO order. The Sinker serializes every call
+ * under its own lock, so implementations need not be thread-safe.
+ */
+class ISpillStore {
+public:
+    virtual ~ISpillStore() = default;
+
+    /**
+     * @brief Append one record after all the others.
+     * @return false if the store has no room for it.
+     */
+    virtual bool append(const uint8_t *data, size_t size) noexcept = 0;
+
+    /**
+     * @brief Remove the oldest record and copy it into @p record.
+     *
+     * A record that cannot be read is removed all the same, and a store
+     * that can no longer find its records may drop all of them; either
+     * way size_bytes() shrinks. It stays the same only when nothing was
+     * removed, e.g. after a transient read error.
+     * @return false if the store is empty or the record cannot be read.
+     */
+    virtual bool read(std::vector<uint8_t> &record) noexcept = 0;
+
+    /**
+     * @brief Bytes currently used, including per-record overhead.
+     */
+    [[nodiscard]] virtual size_t size_bytes() const noexcept = 0;
+};
+
+/**
+ * @brief ISpillStore backed by a file, used as a circular log.
+ *
+ * Works on any C stdio filesystem: the host, or SPIFFS, LittleFS and FAT
+ * mounted through the ESP-IDF VFS. Each record is prefixed by its 32-bit
+ * length. Space freed by read() is reused once the writer reaches the end
+ * of the file, so it never grows past @p max_bytes. The file is created
+ * empty and removed again on destruction; records do not survive a reboot.
+ */
+class FileSpillStore final : public ISpillStore {
+public:
+    FileSpillStore(std::string path, size_t max_bytes) noexcept;
+    ~FileSpillStore() override;
+
+    FileSpillStore(const FileSpillStore &) = delete;
+    FileSpillStore &operator=(const FileSpillStore &) = delete;
+
+    /**
+     * @brief Whether the file could be created.
+     */
+    [[nodiscard]] bool is_open() const noexcept { return _file != nullptr; }
+
+    bool append(const uint8_t *data, size_t size) noexcept override;
+    bool read(std::vector<uint8_t> &record) noexcept override;
+    [[nodiscard]] size_t size_bytes() const noexcept override { return _used; }
+
+private:
+    static constexpr size_t LENGTH_SIZE = 4;
+
+    /// Remove the oldest record, @p bytes long including its length.
+    void _pop(size_t bytes) noexcept;
+    /// Drop every record.
+    void _clear() noexcept;
+
+    std::string _path;
+    size_t _max_bytes;
+    std::FILE *_file{nullptr};
+    size_t _head{0};    ///< Write offset
+    size_t _tail{0};    ///< Read offset
+    size_t _wrap_at{0}; ///< End of the data ahead of _tail while _wrapped
+    bool _wrapped{false}; ///< _head has wrapped around behind _tail
+    size_t _records{0};
+    size_t _used{0};
+};
+
+} // namespace loggable
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <utility>
+
+/**
+ * @file loggable_static.hpp
+ * @brief Fixed-capacity containers for the no-heap build.
+ *
+ * Define LOGGABLE_NO_HEAP for the library and every translation unit
+ * (CMake option of the same name) and the core keeps every buffer in
+ * statically sized storage: message tags and text, the sink table, the
+ * queues and the dispatch lanes. Nothing is allocated after init() and
+ * the first add_sinker() calls. The capacities below are compile-time
+ * settings; longer tags and text are cut to fit.
+ */
+
+#ifndef LOGGABLE_MAX_TAG
+#define LOGGABLE_MAX_TAG 23 ///< Tag bytes kept per message
+#endif
+#ifndef LOGGABLE_MAX_MESSAGE
+#define LOGGABLE_MAX_MESSAGE 119 ///< Text bytes kept per message
+#endif
+#ifndef LOGGABLE_MAX_SINKS
+#define LOGGABLE_MAX_SINKS 8 ///< Sinks registered at once
+#endif
+#ifndef LOGGABLE_LANE_CAPACITY
+#define LOGGABLE_LANE_CAPACITY 32 ///< Messages per extra dispatch worker
+#endif
+
+namespace loggable {
+
+/**
+ * @brief String of at most @p Capacity bytes, stored inline.
+ *
+ * Assigning longer text keeps its first @p Capacity bytes. Always null
+ * terminated. Converts to std::string_view.
+ */
+template <size_t Capacity>
+class InlineString {
+public:
+    static_assert(Capacity <= UINT16_MAX, "InlineString capacity too large");
+
+    constexpr InlineString() noexcept = default;
+
+    template <typename S>
+        requires std::convertible_to<const S &, std::string_view>
+    InlineString(const S &text) noexcept { // NOLINT: implicit, like std::string
+        assign(text);
+    }
+
+    void assign(std::string_view text) noexcept {
+        _size = static_cast<uint16_t>(std::min(text.size(), Capacity));
+        std::copy_n(text.data(), _size, _data.data());
+        _data[_size] = '\0';
+    }
+
+    void clear() noexcept { assign({}); }
+
+    [[nodiscard]] const char *data() const noexcept { return _data.data(); }
+    [[nodiscard]] const char *c_str() const noexcept { return _data.data(); }
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] const char *begin() const noexcept { return data(); }
+    [[nodiscard]] const char *end() const noexcept { return data() + _size; }
+    [[nodiscard]] static constexpr size_t capacity() noexcept { return Capacity; }
+
+    operator std::string_view() const noexcept { return {data(), _size}; }
+
+    friend bool operator==(const InlineString &a, std::string_view b) noexcept {
+        return std::string_view(a) == b;
+    }
+
+private:
+    std::array<char, Capacity + 1> _data{};
+    uint16_t _size{0};
+};
+
+/**
+ * @brief Vector of at most @p Capacity elements, stored inline.
+ *
+ * Elements are constructed only when added. Check full() before adding.
+ */
+template <typename T, size_t Capacity>
+class StaticVector {
+public:
+    StaticVector() noexcept = default;
+    StaticVector(const StaticVector &) = delete;
+    StaticVector &operator=(const StaticVector &) = delete;
+    ~StaticVector() { clear(); }
+
+    /// Precondition: !full().
+    void push_back(T item) noexcept {
+        new (&_storage[_size * sizeof(T)]) T(std::move(item));
+        ++_size;
+    }
+
+    /// Remove [first, end()); the elements before stay in order.
+    void erase(T *first, T *last) noexcept {
+        T *tail = std::move(last, end(), first);
+        while (end() != tail) {
+            --_size;
+            end()->~T();
+        }
+    }
+
+    void clear() noexcept { erase(begin(), end()); }
+
+    [[nodiscard]] T *begin() noexcept { return std::launder(reinterpret_cast<T *>(_storage)); }
+    [[nodiscard]] T *end() noexcept { return begin() + _size; }
+    [[nodiscard]] const T *begin() const noexcept {
+        return std::launder(reinterpret_cast<const T *>(_storage));
+    }
+    [[nodiscard]] const T *end() const noexcept { return begin() + _size; }
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] bool full() const noexcept { return _size == Capacity; }
+
+private:
+    alignas(T) std::byte _storage[Capacity * sizeof(T)];
+    size_t _size{0};
+};
+
+/**
+ * @brief FIFO of at most @p Capacity elements, stored inline.
+ *
+ * Slots hold default-constructed elements while unused. Check size()
+ * before adding.
+ */
+template <typename T, size_t Capacity>
+class StaticDeque {
+public:
+    /// Precondition: size() < Capacity.
+    void push_back(T item) noexcept {
+        _items[(_head + _size) % Capacity] = std::move(item);
+        ++_size;
+    }
+
+    [[nodiscard]] T &front() noexcept { return _items[_head]; }
+
+    void pop_front() noexcept {
+        _items[_head] = T{}; // Release what the element holds now
+        _head = (_head + 1) % Capacity;
+        --_size;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+private:
+    std::array<T, Capacity> _items{};
+    size_t _head{0};
+    size_t _size{0};
+};
+
+} // namespace loggable
@@ -1,7 +1,12 @@
 #include "loggable.hpp"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
 #include <memory>
 #include <mutex>
 #include <string_view>
@@ -12,10 +17,254 @@
 #include <fmt/format.h>
 
 #include "fmt/color.h"
-#include "loggable_os.hpp"
+#include "loggable_backend.hpp"
+#include "loggable_record.hpp"
 
 namespace loggable {
 
+namespace {
+
+/// ANSI reset sequence appended by ESP_LOGx when CONFIG_LOG_COLORS is set.
+constexpr std::string_view COLOR_RESET = "\033[0m";
+
+/**
+ * @brief Returns the offset just past a leading ANSI color sequence, if any.
+ */
+[[nodiscard]] size_t skip_color(std::string_view text) noexcept {
+    if (text.size() < 2 || text[0] != '\033' || text[1] != '[') {
+        return 0;
+    }
+    const size_t end = text.find('m', 2);
+    return end == std::string_view::npos ? 0 : end + 1;
+}
+
+/**
+ * @brief Recovers the level from an ESP_LOGx format string before formatting.
+ *
+ * The level letter is a literal in LOG_FORMAT, so it is visible without
+ * expanding any arguments.
+ */
+[[nodiscard]] LogLevel level_hint(std::string_view format) noexcept {
+    const size_t pos = skip_color(format);
+    if (format.size() < pos + 3 || format[pos + 1] != ' ' ||
+        format[pos + 2] != '(') {
+        return LogLevel::None;
+    }
+    return log_level_from_char(format[pos]);
+}
+
+[[nodiscard]] std::chrono::system_clock::time_point now() noexcept {
+    auto *backend = os::bound_backend();
+    if (backend) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::milliseconds(backend->get_time_ms()));
+    }
+    return std::chrono::system_clock::now();
+}
+
+#ifdef LOGGABLE_NO_HEAP
+/// Timestamp for diagnostics printed before a backend is set.
+[[nodiscard]] uint32_t now_ms() noexcept {
+    auto *backend = os::bound_backend();
+    return backend ? backend->get_time_ms() : 0;
+}
+#endif
+
+/**
+ * @brief Whether sequence number @p a was assigned before @p b.
+ *
+ * Wrap-safe as long as the two are less than 2^31 apart.
+ */
+[[nodiscard]] constexpr bool sequence_before(uint32_t a, uint32_t b) noexcept {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+/// Build the queue or a lane in its storage: in @p resource, or in place.
+template <typename T, typename Delete, typename... Args>
+void emplace(std::unique_ptr<T, Delete> &storage, std::pmr::memory_resource *resource,
+             Args &&...args) {
+    void *memory = resource->allocate(sizeof(T), alignof(T));
+    storage = std::unique_ptr<T, Delete>(new (memory) T(std::forward<Args>(args)...),
+                                         Delete{resource});
+}
+
+template <typename T, typename... Args>
+void emplace(std::optional<T> &storage, std::pmr::memory_resource * /*resource*/,
+             Args &&...args) {
+    storage.emplace(std::forward<Args>(args)...);
+}
+
+#ifndef LOGGABLE_NO_HEAP
+/// Move the elements of @p container into a copy allocating from @p resource.
+template <typename Container>
+void adopt_resource(Container &container, std::pmr::memory_resource *resource) {
+    if (container.get_allocator().resource() == resource) {
+        return;
+    }
+    Container moved(std::make_move_iterator(container.begin()),
+                    std::make_move_iterator(container.end()), resource);
+    std::destroy_at(&container);
+    std::construct_at(&container, std::move(moved));
+}
+#endif
+
+/// Payload string holding @p text; from @p resource with LOGGABLE_PMR.
+template <typename S>
+[[nodiscard]] S payload(std::string_view text,
+                        [[maybe_unused]] std::pmr::memory_resource *resource) noexcept {
+#ifdef LOGGABLE_PMR
+    return S(text, resource);
+#else
+    return S(text);
+#endif
+}
+
+/**
+ * @brief vsnprintf a message text. Lines that fit go through a stack buffer;
+ *        longer ones are formatted again straight into an exact-size payload
+ *        from @p resource, or cut with LOGGABLE_NO_HEAP.
+ * @param fn Invoked with the formatted text.
+ * @return vsnprintf's return value.
+ */
+template <typename Fn>
+int format_printf(const char *format, va_list args, std::pmr::memory_resource *resource,
+                  Fn &&fn) noexcept {
+    char stack_buf[Logger::LINE_BUFFER_SIZE];
+    va_list retry_args;
+    va_copy(retry_args, args);
+
+    const int len = std::vsnprintf(stack_buf, sizeof(stack_buf), format, args);
+    if (len >= 0 && static_cast<size_t>(len) < sizeof(stack_buf)) {
+        fn(payload<LogMessage::Text>(std::string_view(stack_buf, static_cast<size_t>(len)),
+                                     resource));
+#ifdef LOGGABLE_NO_HEAP
+    } else if (len >= 0) {
+        fn(payload<LogMessage::Text>(std::string_view(stack_buf, sizeof(stack_buf) - 1),
+                                     resource));
+#else
+    } else if (len >= 0) {
+        auto text = payload<LogMessage::Text>({}, resource);
+        text.resize(static_cast<size_t>(len));
+        std::vsnprintf(text.data(), text.size() + 1, format, retry_args);
+        fn(std::move(text));
+#endif
+    }
+
+    va_end(retry_args);
+    return len;
+}
+
+/// Cut @p text to [@p pos, @p pos + @p count) without reallocating.
+void trim_payload(LogMessage::Text &text, size_t pos, size_t count) noexcept {
+#ifdef LOGGABLE_NO_HEAP
+    text.assign(std::string_view(text).substr(pos, count));
+#else
+    text.erase(pos + count);
+    text.erase(0, pos);
+#endif
+}
+
+/**
+ * @brief @p message as a sink that reads get_message() needs it.
+ *
+ * Static text is copied into @p owned the first time such a sink asks.
+ */
+[[nodiscard]] const LogMessage &readable_by(bool static_text, const LogMessage &message,
+                                            std::optional<LogMessage> &owned) noexcept {
+    if (static_text || !message.has_static_text()) [[likely]] {
+        return message;
+    }
+    if (!owned) {
+        auto *resource = Sinker::instance().memory_resource();
+        owned.emplace(message.get_timestamp(), message.get_level(),
+                      payload<LogMessage::Tag>(message.get_tag(), resource),
+                      payload<LogMessage::Text>(message.get_message_view(), resource),
+                      message.get_context());
+    }
+    return *owned;
+}
+
+
+/// Task names, indexed by dispatch worker.
+constexpr std::array<const char *, SinkerConfig::MAX_WORKERS> WORKER_NAMES{
+    "log_dispatch", "log_dispatch1", "log_dispatch2", "log_dispatch3"};
+
+} // namespace
+
+LogLinePrefix parse_log_line_prefix(std::string_view line) noexcept {
+    size_t pos = skip_color(line);
+
+    // "<L> (" - level letter followed by the opening of the timestamp
+    if (line.size() < pos + 3 || line[pos + 1] != ' ' || line[pos + 2] != '(') {
+        return {};
+    }
+    const LogLevel level = log_level_from_char(line[pos]);
+    if (level == LogLevel::None) {
+        return {};
+    }
+    pos += 3;
+
+    // Timestamp: tick count, or HH:MM:SS.mmm with CONFIG_LOG_TIMESTAMP_SOURCE_SYSTEM
+    const size_t stamp_begin = pos;
+    while (pos < line.size() &&
+           ((line[pos] >= '0' && line[pos] <= '9') || line[pos] == ':' ||
+            line[pos] == '.')) {
+        ++pos;
+    }
+    if (pos == stamp_begin || line.size() < pos + 2 || line[pos] != ')' ||
+        line[pos + 1] != ' ') {
+        return {};
+    }
+    pos += 2;
+
+    const size_t tag_end = line.find(": ", pos);
+    if (tag_end == std::string_view::npos) {
+        return {};
+    }
+    return LogLinePrefix{.level = level,
+                         .tag = line.substr(pos, tag_end - pos),
+                         .length = tag_end + 2};
+}
+
+// --- LogContext Implementation ---
+
+std::shared_ptr<const LogContext> &LogContext::_current() noexcept {
+    thread_local std::shared_ptr<const LogContext> current;
+    return current;
+}
+
+const std::string *LogContext::find(std::string_view key) const noexcept {
+    for (const LogContext *node = this; node; node = node->_parent.get()) {
+        if (node->_key == key) {
+            return &node->_value;
+        }
+    }
+    return nullptr;
+}
+
+void LogContext::format(std::string &out) const {
+    if (_parent) {
+        _parent->format(out);
+        out.push_back(' ');
+    }
+    out.append(_key).append(1, '=').append(_value);
+}
+
+#ifndef LOGGABLE_NO_HEAP
+ScopedContext::ScopedContext(std::string key, std::string value) noexcept
+    : _previous(LogContext::_current()) {
+    LogContext::_current() =
+        std::make_shared<const LogContext>(std::move(key), std::move(value), _previous);
+}
+#endif
+
+ScopedContext::ScopedContext(std::shared_ptr<const LogContext> snapshot) noexcept
+    : _previous(std::exchange(LogContext::_current(), std::move(snapshot))) {}
+
+ScopedContext::~ScopedContext() {
+    LogContext::_current() = std::move(_previous);
+}
+
 // --- Sinker Implementation ---
 
 Sinker &Sinker::instance() noexcept {
@@ -25,19 +274,37 @@ Sinker &Sinker::instance() noexcept {
 
 void Sinker::add_sinker(std::shared_ptr<ISink> sinker) noexcept {
     if (sinker) {
-        std::lock_guard<std::mutex> lock(_sinkers_mutex);
-        _sinkers.push_back(std::move(sinker));
+        std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
+#ifdef LOGGABLE_NO_HEAP
+        if (_sinkers.full()) {
+            fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Sink table full ({} sinks), sink not added\n", now_ms(), "Loggable::Sinker", __func__, __LINE__, _sinkers.size());
+            return;
+        }
+#endif
+        const bool ordered = sinker->requires_ordering();
+        const bool static_text = sinker->supports_static_text();
+        _sinkers.push_back(SinkEntry{.sink = std::move(sinker), .slot = _next_slot++,
+                                     .ordered = ordered, .static_text = static_text,
+                                     .health = {}});
+        if (ordered) {
+            _ordered_sinks.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 }
 
 void Sinker::remove_sinker(const std::shared_ptr<ISink> &sinker) noexcept {
     if (sinker) {
-        std::lock_guard<std::mutex> lock(_sinkers_mutex);
-#if __cplusplus >= 202002L
-        std::erase(_sinkers, sinker);
-#else
-        _sinkers.erase(std::remove(_sinkers.begin(), _sinkers.end(), sinker), _sinkers.end());
-#endif
+        std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
+        const auto matches = [&](const SinkEntry &entry) {
+            if (entry.sink != sinker) {
+                return false;
+            }
+            if (entry.ordered) {
+                _ordered_sinks.fetch_sub(1, std::memory_order_relaxed);
+            }
+            return true;
+        };
+        _sinkers.erase(std::remove_if(_sinkers.begin(), _sinkers.end(), matches), _sinkers.end());
 
     }
 }
@@ -50,91 +317,362 @@ LogLevel Sinker::get_level() const noexcept {
     return _global_level.load(std::memory_order_acquire);
 }
 
+LogLevel Sinker::get_effective_level() const noexcept {
+    const LogLevel level = _global_level.load(std::memory_order_acquire);
+    if (_shedding.load(std::memory_order_relaxed)) {
+        return std::min(level, _shed_level.load(std::memory_order_relaxed));
+    }
+    return level;
+}
+
 void Sinker::dispatch(const LogMessage &message) noexcept {
     if (_running.load(std::memory_order_acquire) && _queue) {
         // Async path: enqueue (drops oldest if full)
-        _queue->push(message);
+#ifdef LOGGABLE_PMR
+        _enqueue(LogMessage(message, memory_resource()));
+#else
+        _enqueue(LogMessage(message));
+#endif
     } else {
         // Sync fallback
-        std::lock_guard<std::mutex> lock(_sinkers_mutex);
+        std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
+        _dispatch_internal(message);
+        (void)_idle_sinks(0, 1);
+    }
+}
+
+void Sinker::dispatch(LogMessage &&message) noexcept {
+    if (_running.load(std::memory_order_acquire) && _queue) {
+        _enqueue(std::move(message));
+    } else {
+        std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
         _dispatch_internal(message);
+        (void)_idle_sinks(0, 1);
+    }
+}
+
+void Sinker::_enqueue(LogMessage &&message) noexcept {
+    const uint32_t sequence = _next_sequence.fetch_add(1, std::memory_order_relaxed);
+    const LogLevel level = message.get_level();
+    const bool priority = level != LogLevel::None &&
+        is_log_level_enabled(level, _priority_level.load(std::memory_order_relaxed));
+
+    const size_t pending = _in_flight.fetch_add(1, std::memory_order_relaxed) + 1;
+    _track_pending_up(pending);
+    if (_adaptive_level.load(std::memory_order_relaxed) &&
+        pending >= _high_watermark.load(std::memory_order_relaxed) &&
+        !_shedding.load(std::memory_order_relaxed) &&
+        !_shedding.exchange(true, std::memory_order_relaxed)) {
+        _shed_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ISpillStore *spill = _spill_store.load(std::memory_order_acquire);
+    bool kept;
+    if (priority) {
+        kept = _priority_queue->push(QueuedMessage{std::move(message), sequence});
+    } else if (spill && _spill_policy.load(std::memory_order_relaxed) == SpillPolicy::Producer) {
+        // Written out under the queue lock, before any pop can overtake it
+        kept = _queue->push(QueuedMessage{std::move(message), sequence},
+                            [&](QueuedMessage &&evicted) { return _spill_write(*spill, evicted); });
+    } else {
+        kept = _queue->push(QueuedMessage{std::move(message), sequence});
+    }
+    if (!kept) {
+        // The oldest entry was overwritten and will never be dispatched
+        _in_flight.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (priority) {
+        _queue->signal();
     }
 }
 
 void Sinker::_dispatch_internal(const LogMessage &message) noexcept {
-    for (const auto &sinker : _sinkers) {
-        if (sinker) [[likely]] {
-            sinker->consume(message);
+    std::optional<LogMessage> owned;
+    for (const auto &entry : _sinkers) {
+        if (entry.sink) [[likely]] {
+            _consume(entry, readable_by(entry.static_text, message, owned));
         }
     }
 }
 
+void Sinker::_dispatch_assigned(const LogMessage &message, size_t index,
+                                size_t workers, Audience audience) noexcept {
+    std::optional<LogMessage> owned;
+    for (const auto &entry : _sinkers) {
+        if (!entry.sink || entry.slot % workers != index) [[unlikely]] {
+            continue;
+        }
+        if (audience == Audience::All || entry.ordered == (audience == Audience::Ordered)) {
+            _consume(entry, readable_by(entry.static_text, message, owned));
+        }
+    }
+}
+
+void Sinker::_consume(const SinkEntry &entry, const LogMessage &message) noexcept {
+    const uint32_t slow_us = _slow_sink_us.load(std::memory_order_relaxed);
+    auto *backend = os::bound_backend();
+    if (slow_us == 0 || !backend) [[likely]] {
+        entry.sink->consume(message);
+        return;
+    }
+
+    SinkHealth &health = entry.health;
+    const bool bypassed = health.bypassed.load(std::memory_order_relaxed);
+    if (bypassed &&
+        static_cast<int32_t>(backend->get_time_ms() - health.probe_at_ms) < 0) {
+        health.skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const uint64_t start_us = backend->get_time_us();
+    entry.sink->consume(message);
+    const uint64_t took_us = backend->get_time_us() - start_us;
+
+    if (took_us < slow_us) {
+        health.slow_streak = 0;
+        if (bypassed) {
+            health.bypass_ms = 0;
+            health.bypassed.store(false, std::memory_order_relaxed);
+            fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Sink {} recovered\n", backend->get_time_ms(), "Loggable::Sinker", __func__, __LINE__, entry.slot);
+        }
+        return;
+    }
+    if (!bypassed && ++health.slow_streak < _slow_sink_trips.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Trip, or a failed probe: stay away longer each time
+    const uint32_t probe_ms = _sink_probe_ms.load(std::memory_order_relaxed);
+    health.bypass_ms = bypassed ? std::min(health.bypass_ms * 2, probe_ms * 16) : probe_ms;
+    health.probe_at_ms = backend->get_time_ms() + health.bypass_ms;
+    health.slow_streak = 0;
+    if (!bypassed) {
+        health.trips.fetch_add(1, std::memory_order_relaxed);
+        health.bypassed.store(true, std::memory_order_relaxed);
+        fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Sink {} took {} us, bypassed for {} ms\n", backend->get_time_ms(), "Loggable::Sinker", __func__, __LINE__, entry.slot, took_us, health.bypass_ms);
+    }
+}
+
 void Sinker::init(const SinkerConfig &config) noexcept {
-    auto *backend = os::get_backend();
+    auto *backend = os::bound_backend();
     if (!backend) {
         // No backend registered - stay in sync mode
         return;
     }
 
-    bool expected = false;
-    if (!_running.compare_exchange_strong(expected, true,
-                                          std::memory_order_acq_rel)) {
+    std::lock_guard<std::mutex> lifecycle(_lifecycle_mutex);
+    if (_running.load(std::memory_order_acquire)) {
         return; // Already running
     }
 
+    if (config.spill_store != _spill) {
+        std::lock_guard<std::mutex> spill(_spill_mutex);
+        // Records a stuck shutdown() left behind are lost with the old store
+        const size_t stale = _spill_pending.exchange(0, std::memory_order_relaxed);
+        _spill_dropped.fetch_add(stale, std::memory_order_relaxed);
+        _in_flight.fetch_sub(stale, std::memory_order_relaxed);
+        _spill = config.spill_store;
+        _spill_store.store(_spill.get(), std::memory_order_release);
+        _spill_stalled = false;
+#ifdef LOGGABLE_NO_HEAP
+        // Room for the largest record up front
+        _spill_record.reserve(sizeof(uint32_t) + record::HEADER_SIZE + LOGGABLE_MAX_TAG +
+                              LOGGABLE_MAX_MESSAGE);
+#endif
+    }
+    _spill_policy.store(config.spill_policy, std::memory_order_relaxed);
+
+    auto *resource = config.memory_resource ? config.memory_resource
+                                            : std::pmr::get_default_resource();
+    const bool resource_changed = resource != _memory_resource.exchange(resource);
+#ifndef LOGGABLE_NO_HEAP
+    adopt_resource(_held, resource); // No worker is running
+    {
+        std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
+        adopt_resource(_sinkers, resource);
+    }
+#endif
+
+    // The queue outlives shutdown() so that producers racing with it never
+    // touch freed memory; it is only rebuilt when the backend or the
+    // memory resource changes.
+    if (!_queue || _queue_backend != backend || resource_changed) {
+        if (_drained) {
+            _queue_backend->event_destroy(_drained);
+            _drained = os::EventHandle{};
+        }
+        emplace(_queue, resource, backend);
+        emplace(_priority_queue, resource);
+        for (auto &worker : _workers) {
+            worker.lane.reset();
+        }
+        _queue_backend = backend;
+        _in_flight.store(0, std::memory_order_relaxed);
+        if (backend->capabilities().event_group) {
+            _drained = backend->event_create();
+        }
+    }
+#ifdef LOGGABLE_NO_HEAP
+    if (!_shared_slab_ready) {
+        for (auto &node : _shared_slab) {
+            node.next_free = _shared_free.load(std::memory_order_relaxed);
+            _shared_free.store(&node, std::memory_order_relaxed);
+        }
+        _shared_slab_ready = true;
+    }
+#endif
+    _worker_done = backend->semaphore_create_binary();
+    if (!_worker_done) {
+        return;
+    }
+
     _shutdown_requested.store(false, std::memory_order_release);
-    _queue = std::make_unique<RingBuffer<LogMessage, QUEUE_CAPACITY>>(backend);
+    _lanes_closed.store(false, std::memory_order_release);
+    _priority_level.store(config.priority_level, std::memory_order_relaxed);
+    const size_t high_watermark = std::max<size_t>(config.high_watermark, 1);
+    _adaptive_level.store(config.adaptive_level, std::memory_order_relaxed);
+    _high_watermark.store(high_watermark, std::memory_order_relaxed);
+    _low_watermark.store(std::min(config.low_watermark, high_watermark - 1), std::memory_order_relaxed);
+    _shed_level.store(config.shed_level, std::memory_order_relaxed);
+    _shedding.store(false, std::memory_order_relaxed);
+    _slow_sink_us.store(config.slow_sink_us, std::memory_order_relaxed);
+    _slow_sink_trips.store(std::max<uint32_t>(config.slow_sink_trips, 1), std::memory_order_relaxed);
+    _sink_probe_ms.store(std::max<uint32_t>(config.sink_probe_ms, 1), std::memory_order_relaxed);
+    {
+        // Every sink starts with a clean record; no worker is running yet
+        std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
+        for (auto &entry : _sinkers) {
+            entry.health.bypassed.store(false, std::memory_order_relaxed);
+            entry.health.slow_streak = 0;
+            entry.health.bypass_ms = 0;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> stats(_stats_mutex);
+        const uint64_t now_us = backend->get_time_us();
+        _reset_window(now_us);
+        _rate_at_us = now_us;
+        _rate_sequence = _next_sequence.load(std::memory_order_relaxed);
+        _rate = 0.0f;
+    }
+    _running.store(true, std::memory_order_release);
 
-    os::TaskConfig task_cfg{
-        .name = "log_dispatch",
-        .stack_size = config.task_stack_size,
-        .priority = config.task_priority,
-        .core = config.task_core};
+    // Lane workers first: they only sleep until worker 0 feeds them, and
+    // the pool shrinks to whatever could be started
+    const size_t workers = std::clamp<size_t>(config.worker_count, 1, SinkerConfig::MAX_WORKERS);
+    size_t started = 1;
+    for (; started < workers; ++started) {
+        auto &worker = _workers[started];
+        if (!worker.lane) {
+            emplace(worker.lane, resource, backend);
+        }
+        worker.owner = this;
+        worker.index = started;
+        _workers_alive.fetch_add(1);
+        worker.task = backend->task_create(_worker_task_config(config, started),
+                                           &Sinker::_task_entry, &worker);
+        if (!worker.task) {
+            _workers_alive.fetch_sub(1);
+            break;
+        }
+    }
+    _worker_count.store(started, std::memory_order_release);
 
-    _task = backend->task_create(task_cfg, &Sinker::_task_entry, this);
+    auto &dispatcher = _workers[0];
+    dispatcher.owner = this;
+    dispatcher.index = 0;
+    _workers_alive.fetch_add(1);
+    dispatcher.task = backend->task_create(_worker_task_config(config, 0),
+                                           &Sinker::_task_entry, &dispatcher);
 
-    if (!_task) {
-        _queue.reset();
+    if (!dispatcher.task) {
+        _workers_alive.fetch_sub(1);
         _running.store(false, std::memory_order_release);
+        if (started > 1) {
+            _close_lanes();
+            (void)backend->semaphore_take(_worker_done, os::WAIT_FOREVER);
+        }
+        backend->semaphore_destroy(_worker_done);
+        _worker_done = os::SemaphoreHandle{};
     }
 }
 
 void Sinker::shutdown() noexcept {
-    auto *backend = os::get_backend();
+    auto *backend = os::bound_backend();
+    std::lock_guard<std::mutex> lifecycle(_lifecycle_mutex);
     if (!backend || !_running.load(std::memory_order_acquire)) {
         return;
     }
 
     _shutdown_requested.store(true, std::memory_order_release);
-
-    if (_queue) {
-        _queue->signal();
-    }
+    _queue->signal();
 
     (void)flush(5000);
 
     _running.store(false, std::memory_order_release);
+    _queue->signal();
 
-    if (_queue) {
-        _queue->signal();
+    // Wait for every worker to exit before touching their state
+    if (!backend->semaphore_take(_worker_done, 5000)) {
+        return; // A worker is stuck in a sink; leave its resources alone
+    }
+    backend->semaphore_destroy(_worker_done);
+    _worker_done = os::SemaphoreHandle{};
+    for (auto &worker : _workers) {
+        worker.task = os::TaskHandle{};
     }
 
-    backend->delay_ms(100);
-
-    _queue.reset();
-    _task = os::TaskHandle{};
+    // Deliver anything enqueued by producers that raced with shutdown
+    std::lock_guard<std::shared_mutex> lock(_sinkers_mutex);
+    while (auto msg = _priority_queue->pop(0)) {
+        _dispatch_internal(msg->message);
+        _complete();
+    }
+    QueuedMessage spilled; // Older than anything still queued
+    while (_spill_read(spilled)) {
+        _dispatch_internal(spilled.message);
+        _complete();
+    }
+    while (auto msg = _queue->pop(0)) {
+        _dispatch_internal(msg->message);
+        _complete();
+    }
 }
 
 bool Sinker::flush(uint32_t timeout_ms) noexcept {
-    auto *backend = os::get_backend();
-    if (!_queue) {
+    auto *backend = os::bound_backend();
+    if (!_running.load(std::memory_order_acquire)) {
         return true;
     }
 
+    if (_drained && backend) {
+        // Event-driven: the worker sets DRAINED_BIT when the last in-flight
+        // message is delivered while someone is waiting here.
+        _flush_waiters.fetch_add(1);
+        const uint32_t start = backend->get_time_ms();
+        bool drained = true;
+        while (_in_flight.load() != 0) {
+            uint32_t wait_ms = os::WAIT_FOREVER;
+            if (timeout_ms > 0) {
+                const uint32_t elapsed = backend->get_time_ms() - start;
+                if (elapsed >= timeout_ms) {
+                    drained = false;
+                    break;
+                }
+                wait_ms = timeout_ms - elapsed;
+            }
+            (void)backend->event_wait(_drained, DRAINED_BIT, true, wait_ms);
+        }
+        _flush_waiters.fetch_sub(1);
+        return drained;
+    }
+
     constexpr uint32_t poll_interval = 10;
     uint32_t elapsed = 0;
 
-    while (!_queue->empty()) {
+    // Wait until every accepted message has been handed to the sinks, not
+    // merely popped from the queue.
+    while (_in_flight.load(std::memory_order_acquire) != 0) {
         if (timeout_ms > 0 && elapsed >= timeout_ms) {
             return false;
         }
@@ -151,65 +689,705 @@ bool Sinker::is_running() const noexcept {
     return _running.load(std::memory_order_acquire);
 }
 
+std::pmr::memory_resource *Sinker::memory_resource() const noexcept {
+    auto *resource = _memory_resource.load(std::memory_order_acquire);
+    return resource ? resource : std::pmr::get_default_resource();
+}
+
 SinkerMetrics Sinker::get_metrics() const noexcept {
-    return SinkerMetrics{
-        .dropped_count = _queue ? _queue->dropped_count() : 0,
-        .queued_count = _queue ? _queue->size() : 0,
+    SinkerMetrics metrics = _current_metrics();
+    auto *backend = os::bound_backend();
+    if (!backend) {
+        return metrics;
+    }
+
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    _window_metrics(metrics, backend->get_time_us());
+    return metrics;
+}
+
+SinkerMetrics Sinker::reset_metrics() noexcept {
+    SinkerMetrics metrics = _current_metrics();
+    auto *backend = os::bound_backend();
+    if (!backend) {
+        return metrics;
+    }
+
+    // Read and restart under one lock, so no event falls between windows
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    const uint64_t now_us = backend->get_time_us();
+    _window_metrics(metrics, now_us);
+    _reset_window(now_us);
+    return metrics;
+}
+
+SinkerMetrics Sinker::_current_metrics() const noexcept {
+    size_t queued = _queue ? _queue->size() : 0;
+    for (const auto &worker : _workers) {
+        if (worker.lane) {
+            queued += worker.lane->size();
+        }
+    }
+    const bool running = _running.load(std::memory_order_acquire);
+    SinkerMetrics metrics{
+        .dropped_count = _dropped_total(),
+        .queued_count = queued,
         .capacity = QUEUE_CAPACITY,
-        .is_running = _running.load(std::memory_order_acquire)};
+        .is_running = running,
+        .worker_count = running ? _worker_count.load(std::memory_order_acquire) : 0,
+        .priority_dropped_count = _priority_queue ? _priority_queue->dropped_count() : 0,
+        .priority_queued_count = _priority_queue ? _priority_queue->size() : 0,
+        .priority_capacity = PRIORITY_CAPACITY,
+        .level_shedding = _shedding.load(std::memory_order_relaxed),
+        .level_shed_count = _shed_count.load(std::memory_order_relaxed),
+        .spilled_count = _spilled.load(std::memory_order_relaxed),
+        .spill_pending_count = _spill_pending.load(std::memory_order_relaxed)};
+    {
+        std::lock_guard<std::mutex> spill(_spill_mutex);
+        if (_spill) {
+            metrics.spill_bytes = _spill->size_bytes();
+        }
+    }
+    {
+        std::shared_lock<std::shared_mutex> sinks(_sinkers_mutex);
+        for (const auto &entry : _sinkers) {
+            if (entry.sink) {
+                const SinkBackpressure pressure = entry.sink->backpressure();
+                metrics.sink_buffered_bytes += pressure.buffered_bytes;
+                metrics.sink_dropped_count += pressure.dropped_count;
+                metrics.stalled_sinks += pressure.stalled ? 1 : 0;
+                metrics.bypassed_sinks +=
+                    entry.health.bypassed.load(std::memory_order_relaxed) ? 1 : 0;
+                metrics.sink_bypassed_count +=
+                    entry.health.skipped.load(std::memory_order_relaxed);
+                metrics.sink_trip_count += entry.health.trips.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    return metrics;
+}
+
+void Sinker::_window_metrics(SinkerMetrics &metrics, uint64_t now_us) const noexcept {
+    const uint64_t window_us = now_us - _window_start_us;
+    uint64_t above_us = _above_us.load(std::memory_order_relaxed);
+    if (_above_high.load(std::memory_order_acquire)) {
+        above_us += now_us - _above_since_us.load(std::memory_order_relaxed);
+    }
+
+    // The rate is folded in on read, so an idle system never wakes to decay it
+    const uint32_t sequence = _next_sequence.load(std::memory_order_relaxed);
+    if (now_us > _rate_at_us) {
+        const auto elapsed_us = static_cast<float>(now_us - _rate_at_us);
+        const float accepted = static_cast<float>(sequence - _rate_sequence);
+        const float weight = 1.0f - std::exp(-elapsed_us / RATE_TIME_CONSTANT_US);
+        _rate += weight * (accepted * 1e6f / elapsed_us - _rate);
+        _rate_at_us = now_us;
+        _rate_sequence = sequence;
+    }
+
+    const size_t workers = std::max<size_t>(metrics.worker_count, 1);
+    const uint64_t busy_us = _busy_us.load(std::memory_order_relaxed);
+    metrics.window_ms = static_cast<uint32_t>(window_us / 1000);
+    metrics.pending_high_watermark = _pending_peak.load(std::memory_order_relaxed);
+    metrics.time_above_high_ms = static_cast<uint32_t>(above_us / 1000);
+    metrics.worker_busy_ratio = window_us == 0 ? 0.0f
+        : std::min(1.0f, static_cast<float>(busy_us) / static_cast<float>(window_us * workers));
+    metrics.messages_per_second = _rate;
+
+}
+
+void Sinker::_reset_window(uint64_t now_us) noexcept {
+    _window_start_us = now_us;
+    _pending_peak.store(_in_flight.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    _above_us.store(0, std::memory_order_relaxed);
+    _above_since_us.store(now_us, std::memory_order_relaxed);
+    _busy_us.store(0, std::memory_order_relaxed);
+}
+
+void Sinker::_track_pending_up(size_t pending) noexcept {
+    size_t peak = _pending_peak.load(std::memory_order_relaxed);
+    while (pending > peak &&
+           !_pending_peak.compare_exchange_weak(peak, pending, std::memory_order_relaxed)) {
+    }
+
+    // The clock is read only when crossing the threshold
+    if (pending >= _high_watermark.load(std::memory_order_relaxed) &&
+        !_above_high.load(std::memory_order_relaxed)) {
+        _above_since_us.store(os::bound_backend()->get_time_us(), std::memory_order_relaxed);
+        _above_high.store(true, std::memory_order_release);
+    }
+}
+
+void Sinker::_track_pending_down(size_t pending) noexcept {
+    if (pending < _high_watermark.load(std::memory_order_relaxed) &&
+        _above_high.load(std::memory_order_relaxed) &&
+        _above_high.exchange(false, std::memory_order_acq_rel)) {
+        const uint64_t since_us = _above_since_us.load(std::memory_order_relaxed);
+        _above_us.fetch_add(os::bound_backend()->get_time_us() - since_us,
+                            std::memory_order_relaxed);
+    }
+}
+
+
+size_t Sinker::_dropped_total() const noexcept {
+    size_t dropped = _queue ? _queue->dropped_count() : 0;
+    dropped += _spill_dropped.load(std::memory_order_relaxed);
+    if (_priority_queue) {
+        dropped += _priority_queue->dropped_count();
+    }
+    for (const auto &worker : _workers) {
+        if (worker.lane) {
+            dropped += worker.lane->dropped_count();
+        }
+    }
+    return dropped;
+}
+
+os::TaskConfig Sinker::_worker_task_config(const SinkerConfig &config, size_t index) noexcept {
+    const int core = config.worker_cores[index];
+    return os::TaskConfig{
+        .name = WORKER_NAMES[index],
+        .stack_size = config.task_stack_size,
+        .priority = config.task_priority,
+        .core = core >= 0 ? core : config.task_core};
 }
 
 void Sinker::_task_entry(void *arg) noexcept {
-    auto *self = static_cast<Sinker *>(arg);
-    self->_process_queue();
+    auto *worker = static_cast<Worker *>(arg);
+    Sinker *self = worker->owner;
+    if (worker->index == 0) {
+        self->_process_queue();
+    } else {
+        self->_process_lane(worker->index);
+    }
 
-    auto *backend = os::get_backend();
+    auto *backend = os::bound_backend();
     if (backend) {
+        if (self->_workers_alive.fetch_sub(1) == 1) {
+            backend->semaphore_give(self->_worker_done);
+        }
         backend->task_delete(os::TaskHandle{});
     }
 }
 
+void Sinker::_complete() noexcept {
+    // Paired with flush(): either the flusher sees zero in flight, or this
+    // sees the flusher registered and wakes it.
+    const size_t pending = _in_flight.fetch_sub(1) - 1;
+    if (pending == 0 && _drained && _flush_waiters.load() > 0) {
+        _queue_backend->event_set(_drained, DRAINED_BIT);
+    }
+    _track_pending_down(pending);
+    if (_shedding.load(std::memory_order_relaxed) &&
+        pending <= _low_watermark.load(std::memory_order_relaxed)) {
+        _shedding.store(false, std::memory_order_relaxed);
+    }
+}
+
 void Sinker::_process_queue() noexcept {
+    // Prefer direct-to-task notifications over the queue semaphore
+    auto *backend = os::bound_backend();
+    (void)_queue->bind_consumer(backend->task_current());
+
+    // Sleep until a message, flush or shutdown signal arrives; only a
+    // pending drop report arms a timeout
+    uint32_t wait_ms = os::WAIT_FOREVER;
+    uint64_t busy_from = backend->get_time_us();
     while (_running.load(std::memory_order_acquire)) {
-        auto msg = _queue->pop(100); // 100ms timeout for shutdown check
+        // Errors and warnings go first; don't sleep while any are held
+        // back or spilled
+        const bool busy = _drain_priority() || !_held.empty() ||
+                          (_spill_pending.load(std::memory_order_acquire) > 0 && !_spill_stalled);
+        if (!busy) {
+            _busy_us.fetch_add(backend->get_time_us() - busy_from, std::memory_order_relaxed);
+        }
+        auto msg = _queue->pop(busy ? 0 : wait_ms);
+        if (!busy) {
+            busy_from = backend->get_time_us();
+        }
 
         if (msg) {
-            std::lock_guard<std::mutex> lock(_sinkers_mutex);
-            _dispatch_internal(*msg);
+            // A priority message logged just before this one may have
+            // arrived since the drain above
+            (void)_drain_priority();
+            if (!_divert(*msg)) {
+                _deliver(std::move(*msg));
+            }
+        }
+        const bool replayed = _replay_spilled();
+        if (!msg && !replayed && _spill_pending.load(std::memory_order_acquire) == 0) {
+            _release_held(0, true); // Nothing older is left in the queue
         }
 
-        auto metrics = get_metrics();
-        if (metrics.dropped_count > 0) {
-            fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Dropped {} log messages\n", os::get_backend()->get_time_ms(), "Loggable::Sinker", __func__, __LINE__, metrics.dropped_count);
-            metrics.dropped_count = 0;
+        wait_ms = _report_drops(false);
+        if (_spill_stalled) {
+            wait_ms = std::min(wait_ms, SPILL_RETRY_MS); // Retry the store shortly
+        }
+        _report_shedding();
+        if (_queue->empty() && _priority_queue->empty()) {
+            // Batching sinks send what they hold; some ask to be woken later
+            const size_t workers = _worker_count.load(std::memory_order_acquire);
+            std::shared_lock<std::shared_mutex> lock(_sinkers_mutex);
+            wait_ms = std::min(wait_ms, _idle_sinks(0, workers));
         }
 
         if (_shutdown_requested.load(std::memory_order_acquire) &&
-            _queue->empty()) {
+            _queue->empty() && _priority_queue->empty() && _held.empty() &&
+            _spill_pending.load(std::memory_order_acquire) == 0) {
             break;
         }
     }
 
     // Drain remaining on shutdown
-    while (auto msg = _queue->pop(0)) {
-        std::lock_guard<std::mutex> lock(_sinkers_mutex);
-        _dispatch_internal(*msg);
+    while (true) {
+        auto msg = _queue->pop(0);
+        (void)_drain_priority();
+        if (msg) {
+            if (!_divert(*msg)) {
+                _deliver(std::move(*msg));
+            }
+        } else if (!_replay_spilled()) {
+            break;
+        }
+    }
+    _release_held(0, true);
+    (void)_report_drops(true);
+    _report_shedding();
+    {
+        std::shared_lock<std::shared_mutex> lock(_sinkers_mutex);
+        (void)_idle_sinks(0, _worker_count.load(std::memory_order_acquire));
+    }
+    _close_lanes();
+
+    // Producers must not notify this task once it is gone
+    (void)_queue->bind_consumer(os::TaskHandle{});
+}
+
+bool Sinker::_drain_priority() noexcept {
+    bool drained = false;
+    while (true) {
+        // Ordering sinks get priority messages later, in sequence; once too
+        // many are held back, the rest wait in the priority queue
+        const bool ordered = _ordered_sinks.load(std::memory_order_relaxed) > 0;
+        if (ordered && _held.size() >= HELD_CAPACITY) {
+            break;
+        }
+        auto msg = _priority_queue->pop(0);
+        if (!msg) {
+            break;
+        }
+        drained = true;
+
+        if (!ordered) {
+            _fan_out(std::move(msg->message), Audience::All);
+            continue;
+        }
+        _in_flight.fetch_add(1, std::memory_order_relaxed); // The held delivery
+        const SharedMessage shared = _share(std::move(msg->message));
+        _held.push_back(HeldMessage{shared, msg->sequence});
+        _fan_out(shared, Audience::Unordered);
+    }
+    return drained;
+}
+
+void Sinker::_release_held(uint32_t before, bool all) noexcept {
+    while (!_held.empty() &&
+           (all || sequence_before(_held.front().sequence, before))) {
+        _fan_out(_held.front().message, Audience::Ordered);
+        _held.pop_front();
+    }
+}
+
+void Sinker::_deliver(QueuedMessage &&msg) noexcept {
+    _release_held(msg.sequence, false);
+    _fan_out(std::move(msg.message), Audience::All);
+}
+
+bool Sinker::_spill_write(ISpillStore &store, const QueuedMessage &msg) noexcept {
+    std::lock_guard<std::mutex> lock(_spill_mutex);
+    _spill_record.clear();
+    record::put_u32(_spill_record, msg.sequence);
+    (void)record::encode(msg.message, _spill_record);
+    if (!store.append(_spill_record.data(), _spill_record.size())) {
+        return false;
+    }
+    _spill_pending.fetch_add(1, std::memory_order_release);
+    _spilled.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Sinker::_spill_read(QueuedMessage &msg) noexcept {
+    if (_spill_pending.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_spill_mutex);
+    ISpillStore *store = _spill_store.load(std::memory_order_relaxed);
+    while (_spill_pending.load(std::memory_order_relaxed) > 0) {
+        const size_t before = store->size_bytes();
+        size_t lost = 1;
+        _spill_stalled = false;
+        if (store->read(_spill_record)) {
+            _spill_pending.fetch_sub(1, std::memory_order_relaxed);
+            constexpr size_t sequence_size = sizeof(uint32_t);
+            if (_spill_record.size() > sequence_size &&
+                record::decode(_spill_record.data() + sequence_size,
+                               _spill_record.size() - sequence_size, msg.message) != 0) {
+                msg.sequence = record::get_u32(_spill_record.data());
+                return true;
+            }
+        } else if (const size_t after = store->size_bytes(); after == 0) {
+            // The store dropped every record it could no longer find
+            lost = _spill_pending.exchange(0, std::memory_order_relaxed);
+        } else if (after == before) {
+            // Nothing was removed: leave the records in order for a retry
+            _spill_stalled = true;
+            return false;
+        } else {
+            _spill_pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+        // Unreadable records are lost
+        _spill_dropped.fetch_add(lost, std::memory_order_relaxed);
+        for (size_t i = 0; i < lost; ++i) {
+            _complete();
+        }
+    }
+    return false;
+}
+
+bool Sinker::_divert(const QueuedMessage &msg) noexcept {
+    ISpillStore *store = _spill_store.load(std::memory_order_relaxed);
+    if (!store) {
+        return false;
+    }
+    // While anything is spilled, later messages must line up behind it
+    if (_spill_pending.load(std::memory_order_acquire) == 0 &&
+        (_spill_policy.load(std::memory_order_relaxed) != SpillPolicy::Worker ||
+         _queue->size() < _high_watermark.load(std::memory_order_relaxed))) {
+        return false;
+    }
+    if (!_spill_write(*store, msg)) {
+        _spill_dropped.fetch_add(1, std::memory_order_relaxed);
+        _complete();
+    }
+    return true;
+}
+
+bool Sinker::_replay_spilled() noexcept {
+    // Pressure has subsided once the queue is back to the low watermark
+    if (_spill_pending.load(std::memory_order_acquire) == 0 ||
+        _queue->size() > _low_watermark.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    QueuedMessage msg;
+    if (!_spill_read(msg)) {
+        return false;
+    }
+    _deliver(std::move(msg));
+    return true;
+}
+
+void Sinker::_fan_out(LogMessage &&message, Audience audience) noexcept {
+    const size_t workers = _worker_count.load(std::memory_order_acquire);
+    std::shared_lock<std::shared_mutex> lock(_sinkers_mutex);
+    const uint32_t lanes = _lanes_for(audience, workers);
+    if (lanes == 0) {
+        _dispatch_assigned(message, 0, workers, audience);
+        _complete();
+        return;
+    }
+
+    // Shared once for every lane
+    const SharedMessage shared = _share(std::move(message));
+    _push_lanes(shared, audience, lanes, workers);
+    _dispatch_assigned(*shared, 0, workers, audience);
+    _complete();
+}
+
+void Sinker::_fan_out(const SharedMessage &message, Audience audience) noexcept {
+    const size_t workers = _worker_count.load(std::memory_order_acquire);
+    std::shared_lock<std::shared_mutex> lock(_sinkers_mutex);
+    _push_lanes(message, audience, _lanes_for(audience, workers), workers);
+    _dispatch_assigned(*message, 0, workers, audience);
+    _complete();
+}
+
+uint32_t Sinker::_lanes_for(Audience audience, size_t workers) const noexcept {
+    if (workers == 1) {
+        return 0;
+    }
+    uint32_t lanes = 0;
+    for (const auto &entry : _sinkers) {
+        if (audience == Audience::All || entry.ordered == (audience == Audience::Ordered)) {
+            lanes |= 1u << (entry.slot % workers);
+        }
+    }
+    return lanes & ~1u;
+}
+
+void Sinker::_push_lanes(const SharedMessage &message, Audience audience, uint32_t lanes,
+                         size_t workers) noexcept {
+    // Each lane delivery is in flight until its worker hands it to the sinks
+    for (size_t index = 1; index < workers; ++index) {
+        if (lanes & (1u << index)) {
+            _in_flight.fetch_add(1, std::memory_order_relaxed);
+            if (!_workers[index].lane->push(LaneEntry{message, audience})) {
+                _complete(); // The lane's oldest entry was overwritten
+            }
+        }
     }
 }
 
+Sinker::SharedMessage Sinker::_share(LogMessage &&message) noexcept {
+#ifdef LOGGABLE_NO_HEAP
+    // Only worker 0 takes nodes, so the head cannot be taken and put back
+    // between the load and the exchange; the slab is sized to never run out
+    SharedNode *node = _shared_free.load(std::memory_order_acquire);
+    while (!_shared_free.compare_exchange_weak(node, node->next_free, std::memory_order_acquire,
+                                               std::memory_order_acquire)) {
+    }
+    node->free_list = &_shared_free;
+#else
+    auto *resource = memory_resource();
+    SharedNode *node = std::pmr::polymorphic_allocator<SharedNode>(resource).allocate(1);
+    std::construct_at(node);
+    node->resource = resource;
+#endif
+    node->message = std::move(message);
+    node->refs.store(1, std::memory_order_relaxed);
+    return SharedMessage(node);
+}
+
+void Sinker::_release(SharedNode *node) noexcept {
+    if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+#ifdef LOGGABLE_NO_HEAP
+    node->message = LogMessage{}; // Drops the context now
+    auto &free_list = *node->free_list;
+    SharedNode *head = free_list.load(std::memory_order_relaxed);
+    do {
+        node->next_free = head;
+    } while (!free_list.compare_exchange_weak(head, node, std::memory_order_release,
+                                              std::memory_order_relaxed));
+#else
+    auto *resource = node->resource;
+    std::destroy_at(node);
+    std::pmr::polymorphic_allocator<SharedNode>(resource).deallocate(node, 1);
+#endif
+}
+
+Sinker::SharedMessage::SharedMessage(const SharedMessage &other) noexcept : _node(other._node) {
+    if (_node) {
+        _node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Sinker::SharedMessage::~SharedMessage() {
+    if (_node) {
+        _release(_node);
+    }
+}
+
+void Sinker::_process_lane(size_t index) noexcept {
+    auto *backend = os::bound_backend();
+    Lane &lane = *_workers[index].lane;
+    (void)lane.bind_consumer(backend->task_current());
+
+    // Worker 0 closes the lanes once it has fanned out its last message
+    uint32_t wait_ms = os::WAIT_FOREVER;
+    uint64_t busy_from = backend->get_time_us();
+    while (true) {
+        _busy_us.fetch_add(backend->get_time_us() - busy_from, std::memory_order_relaxed);
+        auto msg = lane.pop(wait_ms);
+        busy_from = backend->get_time_us();
+        const size_t workers = _worker_count.load(std::memory_order_acquire);
+        std::shared_lock<std::shared_mutex> lock(_sinkers_mutex);
+        if (msg) {
+            _dispatch_assigned(*msg->message, index, workers, msg->audience);
+            _complete();
+        }
+        // The last push and the close may have woken this worker only once
+        if (_lanes_closed.load(std::memory_order_acquire) && lane.empty()) {
+            (void)_idle_sinks(index, workers);
+            break;
+        }
+        wait_ms = lane.empty() ? _idle_sinks(index, workers) : os::WAIT_FOREVER;
+    }
+
+    (void)lane.bind_consumer(os::TaskHandle{});
+}
+
+uint32_t Sinker::_idle_sinks(size_t index, size_t workers) noexcept {
+    uint32_t wait_ms = os::WAIT_FOREVER;
+    for (const auto &entry : _sinkers) {
+        if (entry.sink && entry.slot % workers == index) {
+            wait_ms = std::min(wait_ms, entry.sink->on_idle());
+        }
+    }
+    return wait_ms;
+}
+
+void Sinker::_close_lanes() noexcept {
+    _lanes_closed.store(true, std::memory_order_release);
+    const size_t workers = _worker_count.load(std::memory_order_acquire);
+    for (size_t index = 1; index < workers; ++index) {
+        _workers[index].lane->signal();
+    }
+}
+
+uint32_t Sinker::_report_drops(bool force) noexcept {
+    const size_t dropped = _dropped_total();
+    if (dropped == _reported_dropped) {
+        return os::WAIT_FOREVER;
+    }
+
+    // At most one report per interval; the worker wakes once more for the rest
+    const uint32_t now_ms = os::bound_backend()->get_time_ms();
+    const uint32_t since_ms = now_ms - _last_drop_report_ms;
+    if (!force && _drop_reported && since_ms < DROP_REPORT_INTERVAL_MS) {
+        return DROP_REPORT_INTERVAL_MS - since_ms;
+    }
+
+    fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Dropped {} log messages\n", now_ms, "Loggable::Sinker", __func__, __LINE__, dropped - _reported_dropped);
+    _reported_dropped = dropped;
+    _last_drop_report_ms = now_ms;
+    _drop_reported = true;
+    return os::WAIT_FOREVER;
+}
+
+void Sinker::_report_shedding() noexcept {
+    const size_t count = _shed_count.load(std::memory_order_relaxed);
+    const bool shedding = _shedding.load(std::memory_order_relaxed);
+    if (count == _reported_shed_count && shedding == _reported_shedding) {
+        return;
+    }
+
+    if (shedding) {
+        fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Queue under pressure, level raised to {}\n", os::bound_backend()->get_time_ms(), "Loggable::Sinker", __func__, __LINE__, log_level_to_string(_shed_level.load(std::memory_order_relaxed)));
+    } else {
+        fmt::print(fg(fmt::color::orange), "[{}][W][{}][{}:{}] Queue pressure relieved, level restored to {}\n", os::bound_backend()->get_time_ms(), "Loggable::Sinker", __func__, __LINE__, log_level_to_string(get_level()));
+    }
+    _reported_shed_count = count;
+    _reported_shedding = shedding;
+}
+
 // --- Logger Implementation ---
 
 void Logger::log(LogLevel level, std::string_view message) noexcept {
-    if (!is_log_level_enabled(level, Sinker::instance().get_level())) {
+    if (!is_log_level_enabled(level, Sinker::instance().get_effective_level())) {
         return;
     }
-    auto now = std::chrono::system_clock::now();
-    auto *backend = os::get_backend();
-    if (backend) {
-        now = std::chrono::system_clock::time_point(std::chrono::milliseconds(backend->get_time_ms()));
+    _log(level, _tag, message);
+}
+
+void Logger::log(LogLevel level, StaticText message) noexcept {
+    if (!is_log_level_enabled(level, Sinker::instance().get_effective_level())) {
+        return;
+    }
+    auto &sinker = Sinker::instance();
+    sinker.dispatch(LogMessage(now(), level, payload<LogMessage::Tag>(_tag, sinker.memory_resource()),
+                               message, LogContext::current()));
+}
+
+void Logger::vlogf(LogLevel level, const char *format, va_list args) noexcept {
+    if (!is_log_level_enabled(level, Sinker::instance().get_effective_level())) {
+        return;
+    }
+    auto *resource = Sinker::instance().memory_resource();
+    (void)format_printf(format, args, resource, [&](LogMessage::Text text) {
+        _log(level, payload<LogMessage::Tag>(_tag, resource), std::move(text));
+    });
+}
+
+int Logger::vlog_line(const char *format, va_list args) noexcept {
+    const LogLevel global_level = Sinker::instance().get_effective_level();
+    const LogLevel hint = level_hint(format);
+    if (hint != LogLevel::None && !is_log_level_enabled(hint, global_level)) {
+        // Still report the length, as vprintf would
+        return std::vsnprintf(nullptr, 0, format, args);
+    }
+
+    auto *resource = Sinker::instance().memory_resource();
+    return format_printf(format, args, resource, [&](LogMessage::Text text) {
+        std::string_view line = text;
+        if (line.ends_with('\n')) {
+            line.remove_suffix(1);
+        }
+        if (line.ends_with(COLOR_RESET)) {
+            line.remove_suffix(COLOR_RESET.size());
+        }
+
+        const LogLinePrefix prefix = parse_log_line_prefix(line);
+        if (prefix.length == 0) {
+            if (is_log_level_enabled(LogLevel::Info, global_level)) {
+                trim_payload(text, 0, line.size());
+                _log(LogLevel::Info, payload<LogMessage::Tag>(_tag, resource), std::move(text));
+            }
+            return;
+        }
+        if (is_log_level_enabled(prefix.level, global_level)) {
+            // The tag points into the text, so copy it out before the cut
+            auto tag = payload<LogMessage::Tag>(prefix.tag, resource);
+            trim_payload(text, prefix.length, line.size() - prefix.length);
+            _log(prefix.level, std::move(tag), std::move(text));
+        }
+    });
+}
+
+Logger::Span::Span(std::string_view tag, LogLevel level, std::string_view name,
+                   uint32_t threshold_us) noexcept
+    : _tag(tag), _name(name), _threshold_us(threshold_us), _level(level) {
+    auto *backend = os::bound_backend();
+    if (backend && is_log_level_enabled(level, Sinker::instance().get_effective_level())) {
+        _start_us = backend->get_time_us();
+        _active = true;
+    }
+}
+
+Logger::Span &Logger::Span::operator=(Span &&other) noexcept {
+    if (this != &other) {
+        end();
+        _tag = other._tag;
+        _name = other._name;
+        _start_us = other._start_us;
+        _threshold_us = other._threshold_us;
+        _level = other._level;
+        _active = std::exchange(other._active, false);
+    }
+    return *this;
+}
+
+uint64_t Logger::Span::elapsed_us() const noexcept {
+    return _active ? os::bound_backend()->get_time_us() - _start_us : 0;
+}
+
+void Logger::Span::end() noexcept {
+    if (!_active) {
+        return;
     }
-    LogMessage msg(now, level, std::string(_tag), std::string(message));
-    Sinker::instance().dispatch(msg);
+    const uint64_t took_us = elapsed_us();
+    _active = false;
+    // The level is checked again: it may have been raised while timing
+    if (took_us < _threshold_us ||
+        !is_log_level_enabled(_level, Sinker::instance().get_effective_level())) {
+        return;
+    }
+    std::array<char, LINE_BUFFER_SIZE> line;
+    const auto result = fmt::format_to_n(line.data(), line.size(), "{}: {} us", _name, took_us);
+    _log(_level, _tag, std::string_view(line.data(), std::min(result.size, line.size())));
+}
+
+void Logger::_log(LogLevel level, std::string_view tag,
+                  std::string_view message) noexcept {
+    auto *resource = Sinker::instance().memory_resource();
+    _log(level, payload<LogMessage::Tag>(tag, resource),
+         payload<LogMessage::Text>(message, resource));
+}
+
+void Logger::_log(LogLevel level, LogMessage::Tag tag, LogMessage::Text message) noexcept {
+    Sinker::instance().dispatch(
+        LogMessage(now(), level, std::move(tag), std::move(message), LogContext::current()));
 }
 
 } // namespace loggable
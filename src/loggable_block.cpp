@@ -0,0 +1,485 @@
+#include "loggable_block.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <utility>
+
+namespace loggable {
+
+namespace block {
+
+namespace {
+
+constexpr size_t HEADER_CRC_OFFSET = 40;
+constexpr size_t MIN_BLOOM_SIZE = 8;
+
+[[nodiscard]] uint64_t fnv1a(uint8_t kind, std::string_view text) noexcept {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = (hash ^ kind) * 0x100000001B3ull;
+    for (const char c : text) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/// Bit positions by double hashing. Taken modulo the filter size, which
+/// is a power of two, so a filter can be folded in half by OR-ing halves.
+template <typename Fn>
+void for_each_bit(uint64_t hash, uint8_t hashes, size_t size, Fn &&fn) {
+    const auto h1 = static_cast<uint32_t>(hash);
+    const auto h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    const size_t mask = size * 8 - 1;
+    for (uint32_t i = 0; i < hashes; ++i) {
+        fn((h1 + i * h2) & mask);
+    }
+}
+
+[[nodiscard]] uint32_t header_crc(const uint8_t *data, size_t size) noexcept {
+    constexpr std::array<uint8_t, 4> zero{};
+    uint32_t crc = record::crc32(data, HEADER_CRC_OFFSET);
+    crc = record::crc32(zero.data(), zero.size(), crc);
+    return record::crc32(data + HEADER_SIZE, size - HEADER_SIZE, crc);
+}
+
+} // namespace
+
+void encode_header(const BlockHeader &header, std::vector<uint8_t> &out) noexcept {
+    const size_t start = out.size();
+    const size_t size = HEADER_SIZE + header.extensions.size();
+    record::put_u32(out, MAGIC);
+    out.push_back(VERSION);
+    out.push_back(static_cast<uint8_t>(header.codec));
+    record::put_u16(out, static_cast<uint16_t>(size));
+    record::put_u32(out, header.record_count);
+    record::put_u32(out, header.raw_size);
+    record::put_u32(out, header.stored_size);
+    record::put_u32(out, header.payload_crc);
+    record::put_u64(out, static_cast<uint64_t>(header.min_ms));
+    record::put_u64(out, static_cast<uint64_t>(header.max_ms));
+    record::put_u32(out, 0);
+    out.insert(out.end(), header.extensions.begin(), header.extensions.end());
+
+    const uint32_t crc = header_crc(out.data() + start, size);
+    for (size_t i = 0; i < 4; ++i) {
+        out[start + HEADER_CRC_OFFSET + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+}
+
+size_t header_size(const uint8_t *data, size_t size) noexcept {
+    if (size < HEADER_SIZE || record::get_u32(data) != MAGIC || data[4] != VERSION) {
+        return 0;
+    }
+    const size_t announced = record::get_u16(data + 6);
+    return announced >= HEADER_SIZE ? announced : 0;
+}
+
+bool parse_header(const uint8_t *data, size_t size, BlockHeader &out) noexcept {
+    const size_t announced = header_size(data, size);
+    if (announced == 0 || size < announced ||
+        data[5] > static_cast<uint8_t>(Codec::Lz) ||
+        record::get_u32(data + HEADER_CRC_OFFSET) != header_crc(data, announced)) {
+        return false;
+    }
+    out.codec = static_cast<Codec>(data[5]);
+    out.record_count = record::get_u32(data + 8);
+    out.raw_size = record::get_u32(data + 12);
+    out.stored_size = record::get_u32(data + 16);
+    out.payload_crc = record::get_u32(data + 20);
+    out.min_ms = static_cast<int64_t>(record::get_u64(data + 24));
+    out.max_ms = static_cast<int64_t>(record::get_u64(data + 32));
+    out.extensions.assign(data + HEADER_SIZE, data + announced);
+    return true;
+}
+
+uint64_t tag_hash(std::string_view tag) noexcept {
+    return fnv1a(0, tag);
+}
+
+uint64_t token_hash(std::string_view token) noexcept {
+    return fnv1a(1, token);
+}
+
+void bloom_add(uint8_t *bloom, size_t size, uint64_t hash) noexcept {
+    for_each_bit(hash, BLOOM_HASHES, size, [&](size_t bit) {
+        bloom[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+    });
+}
+
+bool BlockSummary::may_contain(uint64_t hash) const noexcept {
+    if (!bloom) {
+        return true;
+    }
+    bool found = true;
+    for_each_bit(hash, hashes, bloom_size, [&](size_t bit) {
+        found = found && ((bloom[bit / 8] >> (bit % 8)) & 1);
+    });
+    return found;
+}
+
+BlockSummary summary(const BlockHeader &header) noexcept {
+    BlockSummary result;
+    const std::vector<uint8_t> &ext = header.extensions;
+    for (size_t pos = 0; pos + 3 <= ext.size();) {
+        const auto type = static_cast<Extension>(ext[pos]);
+        const size_t size = record::get_u16(ext.data() + pos + 1);
+        const uint8_t *body = ext.data() + pos + 3;
+        pos += 3 + size;
+        if (pos > ext.size()) {
+            break;
+        }
+        if (type == Extension::Levels && size == 1) {
+            result.levels = body[0];
+        } else if (type == Extension::Bloom && size > 1 && ((size - 1) & (size - 2)) == 0) {
+            result.hashes = body[0];
+            result.bloom = body + 1;
+            result.bloom_size = size - 1;
+        }
+    }
+    return result;
+}
+
+void encode_index_header(std::vector<uint8_t> &out) noexcept {
+    record::put_u32(out, INDEX_MAGIC);
+    out.push_back(INDEX_VERSION);
+    out.push_back(static_cast<uint8_t>(INDEX_ENTRY_SIZE));
+    record::put_u16(out, 0);
+}
+
+void encode_index_entry(const IndexEntry &entry, std::vector<uint8_t> &out) noexcept {
+    const size_t start = out.size();
+    record::put_u64(out, entry.offset);
+    record::put_u32(out, entry.size);
+    record::put_u32(out, entry.record_count);
+    record::put_u64(out, static_cast<uint64_t>(entry.min_ms));
+    record::put_u64(out, static_cast<uint64_t>(entry.max_ms));
+    record::put_u32(out, record::crc32(out.data() + start, 32));
+}
+
+bool parse_index_entry(const uint8_t *data, IndexEntry &out) noexcept {
+    if (record::get_u32(data + 32) != record::crc32(data, 32)) {
+        return false;
+    }
+    out.offset = record::get_u64(data);
+    out.size = record::get_u32(data + 8);
+    out.record_count = record::get_u32(data + 12);
+    out.min_ms = static_cast<int64_t>(record::get_u64(data + 16));
+    out.max_ms = static_cast<int64_t>(record::get_u64(data + 24));
+    return true;
+}
+
+bool load_index(const std::string &path, std::vector<IndexEntry> &entries) noexcept {
+    entries.clear();
+    std::FILE *file = std::fopen(index_path(path).c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    std::array<uint8_t, INDEX_HEADER_SIZE> header{};
+    const bool valid = std::fread(header.data(), 1, header.size(), file) == header.size() &&
+                       record::get_u32(header.data()) == INDEX_MAGIC &&
+                       header[4] == INDEX_VERSION && header[5] >= INDEX_ENTRY_SIZE;
+    if (valid) {
+        std::vector<uint8_t> entry(header[5]);
+        IndexEntry parsed;
+        while (std::fread(entry.data(), 1, entry.size(), file) == entry.size() &&
+               parse_index_entry(entry.data(), parsed)) {
+            entries.push_back(parsed);
+        }
+    }
+    std::fclose(file);
+    return valid;
+}
+
+} // namespace block
+
+// --- BlockFileSink ---
+
+BlockFileSink::BlockFileSink(std::string path, BlockFileConfig config) noexcept
+    : _path(std::move(path)), _config(config) {
+    _config.block_size = std::max<size_t>(_config.block_size, record::HEADER_SIZE);
+    _raw.reserve(_config.block_size);
+    _column.reserve(_config.block_size / 16);
+    _header_bytes.reserve(block::HEADER_SIZE);
+    if (_config.compress) {
+        _stored.reserve(lz::compress_bound(_config.block_size));
+        _lz = std::make_unique<lz::CompressState>();
+    }
+    if (_config.summary_bits > 0) {
+        size_t size = block::MIN_BLOOM_SIZE;
+        while (size * 16 <= _config.summary_bits && size < 8192) {
+            size *= 2;
+        }
+        _bloom.resize(size);
+        _header.extensions.reserve(8 + size);
+    }
+    _file = std::fopen(_path.c_str(), "ab");
+    if (_file) {
+        // Offsets in the index are absolute: start from the current end
+        (void)std::fseek(_file, 0, SEEK_END);
+    }
+    if (_file && _config.index) {
+        _index = std::fopen(block::index_path(_path).c_str(), "ab");
+        if (_index && std::fseek(_index, 0, SEEK_END) == 0 && std::ftell(_index) == 0) {
+            _header_bytes.clear();
+            block::encode_index_header(_header_bytes);
+            (void)std::fwrite(_header_bytes.data(), 1, _header_bytes.size(), _index);
+        }
+    }
+}
+
+BlockFileSink::~BlockFileSink() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_file) {
+        (void)_write_block();
+        std::fclose(_file);
+    }
+    if (_index) {
+        std::fclose(_index);
+    }
+}
+
+void BlockFileSink::consume(const LogMessage &message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_file) {
+        return;
+    }
+
+    const int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        message.get_timestamp().time_since_epoch()).count();
+    if (!_raw.empty()) {
+        const bool full = _raw.size() + _column.size() + record::encoded_size(message) >
+                          _config.block_size;
+        const bool aged = _config.max_block_age_ms > 0 &&
+            std::max(timestamp_ms, _header.max_ms) - _header.min_ms >= _config.max_block_age_ms;
+        if (full || aged) {
+            (void)_write_block();
+        }
+    }
+
+    if (_raw.empty()) {
+        _header.min_ms = timestamp_ms;
+        _header.max_ms = timestamp_ms;
+        _first_ms = timestamp_ms;
+    } else {
+        _header.min_ms = std::min(_header.min_ms, timestamp_ms);
+        _header.max_ms = std::max(_header.max_ms, timestamp_ms);
+        record::put_varint(_column, record::zigzag(timestamp_ms - _last_ms));
+    }
+    _last_ms = timestamp_ms;
+
+    // The timestamp goes to the column; zero it in the record
+    const size_t start = _raw.size();
+    (void)record::encode(message, _raw);
+    std::fill_n(_raw.begin() + static_cast<std::ptrdiff_t>(start), 8, uint8_t{0});
+    ++_header.record_count;
+
+    if (!_bloom.empty()) {
+        _levels |= static_cast<uint8_t>(1u << static_cast<uint8_t>(message.get_level()));
+        const std::string_view tag =
+            std::string_view(message.get_tag()).substr(0, record::MAX_TAG_SIZE);
+        block::bloom_add(_bloom.data(), _bloom.size(), block::tag_hash(tag));
+        block::for_each_token(
+            message.get_message_view().substr(0, record::MAX_MESSAGE_SIZE),
+            [this](std::string_view token) {
+                block::bloom_add(_bloom.data(), _bloom.size(), block::token_hash(token));
+            });
+    }
+}
+
+bool BlockFileSink::flush() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _file && _write_block();
+}
+
+BlockFileSink::Stats BlockFileSink::stats() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+bool BlockFileSink::_write_block() noexcept {
+    if (_raw.empty()) {
+        return true;
+    }
+
+    // The column starts relative to the earliest timestamp, now known
+    record::put_varint(_raw, record::zigzag(_first_ms - _header.min_ms));
+    _raw.insert(_raw.end(), _column.begin(), _column.end());
+
+    const uint8_t *payload = _raw.data();
+    size_t payload_size = _raw.size();
+    _header.codec = block::Codec::Stored;
+    if (_lz) {
+        // Kept only if it actually saves space
+        _stored.resize(lz::compress_bound(_raw.size()));
+        const size_t compressed = lz::compress(_raw.data(), _raw.size(), _stored.data(),
+                                               _stored.size(), *_lz);
+        if (compressed > 0 && compressed < _raw.size()) {
+            _header.codec = block::Codec::Lz;
+            payload = _stored.data();
+            payload_size = compressed;
+        }
+    }
+    _header.raw_size = static_cast<uint32_t>(_raw.size());
+    _header.stored_size = static_cast<uint32_t>(payload_size);
+    _header.payload_crc = record::crc32(payload, payload_size);
+    _write_summary();
+
+    const long offset = std::ftell(_file);
+    _header_bytes.clear();
+    block::encode_header(_header, _header_bytes);
+    const bool written =
+        std::fwrite(_header_bytes.data(), 1, _header_bytes.size(), _file) == _header_bytes.size() &&
+        std::fwrite(payload, 1, payload_size, _file) == payload_size &&
+        std::fflush(_file) == 0;
+
+    if (written) {
+        ++_stats.blocks;
+        _stats.records += _header.record_count;
+        _stats.raw_bytes += _raw.size();
+        _stats.stored_bytes += _header_bytes.size() + payload_size;
+        if (_index && offset >= 0) {
+            // After the block itself, so an entry never points past the data
+            const block::IndexEntry entry{
+                .offset = static_cast<uint64_t>(offset),
+                .size = static_cast<uint32_t>(_header_bytes.size() + payload_size),
+                .record_count = _header.record_count,
+                .min_ms = _header.min_ms,
+                .max_ms = _header.max_ms};
+            _header_bytes.clear();
+            block::encode_index_entry(entry, _header_bytes);
+            (void)std::fwrite(_header_bytes.data(), 1, _header_bytes.size(), _index);
+            (void)std::fflush(_index);
+        }
+    } else {
+        ++_stats.write_errors; // The block is lost; readers resync past a torn one
+    }
+    _raw.clear();
+    _column.clear();
+    _header.record_count = 0;
+    _header.extensions.clear();
+    _levels = 0;
+    std::fill(_bloom.begin(), _bloom.end(), uint8_t{0});
+    return written;
+}
+
+void BlockFileSink::_write_summary() noexcept {
+    if (_bloom.empty()) {
+        return;
+    }
+    // Fold in half while the result stays at most a quarter full, about
+    // 1.6% false positives with three hashes: few keys, small filter
+    size_t size = _bloom.size();
+    while (size > block::MIN_BLOOM_SIZE) {
+        const size_t half = size / 2;
+        size_t set = 0;
+        for (size_t i = 0; i < half; ++i) {
+            set += static_cast<size_t>(std::popcount(static_cast<uint8_t>(_bloom[i] | _bloom[i + half])));
+        }
+        if (set * 4 > half * 8) {
+            break;
+        }
+        for (size_t i = 0; i < half; ++i) {
+            _bloom[i] |= _bloom[i + half];
+        }
+        size = half;
+    }
+
+    std::vector<uint8_t> &ext = _header.extensions;
+    ext.push_back(static_cast<uint8_t>(block::Extension::Levels));
+    record::put_u16(ext, 1);
+    ext.push_back(_levels);
+    ext.push_back(static_cast<uint8_t>(block::Extension::Bloom));
+    record::put_u16(ext, static_cast<uint16_t>(1 + size));
+    ext.push_back(block::BLOOM_HASHES);
+    ext.insert(ext.end(), _bloom.begin(), _bloom.begin() + static_cast<std::ptrdiff_t>(size));
+}
+
+// --- BlockFileReader ---
+
+BlockFileReader::BlockFileReader(const std::string &path) noexcept {
+    _file = std::fopen(path.c_str(), "rb");
+}
+
+BlockFileReader::~BlockFileReader() {
+    if (_file) {
+        std::fclose(_file);
+    }
+}
+
+bool BlockFileReader::next(block::BlockHeader &header) noexcept {
+    if (!_file) {
+        return false;
+    }
+    while (true) {
+        _buffer.resize(block::HEADER_SIZE);
+        const size_t got = std::fread(_buffer.data(), 1, _buffer.size(), _file);
+        if (got < block::HEADER_SIZE) {
+            _skipped += got;
+            _offset += got;
+            return false;
+        }
+
+        const size_t size = block::header_size(_buffer.data(), got);
+        if (size > 0) {
+            _buffer.resize(size);
+            const size_t rest = size - block::HEADER_SIZE;
+            if (std::fread(_buffer.data() + block::HEADER_SIZE, 1, rest, _file) == rest &&
+                block::parse_header(_buffer.data(), size, header)) {
+                _block_offset = _offset;
+                _offset += size;
+                return true;
+            }
+        }
+
+        // Not a header: resume at the next byte that could start one
+        const auto first = static_cast<uint8_t>(block::MAGIC);
+        const auto candidate = std::find(_buffer.begin() + 1, _buffer.begin() + block::HEADER_SIZE, first);
+        const auto advance = static_cast<uint64_t>(candidate - _buffer.begin());
+        _skipped += advance;
+        if (!seek(_offset + advance)) {
+            return false;
+        }
+    }
+}
+
+bool BlockFileReader::read_payload(const block::BlockHeader &header,
+                                   std::vector<uint8_t> &raw) noexcept {
+    const uint64_t block_offset = _block_offset;
+    _buffer.resize(header.stored_size);
+    const size_t got = std::fread(_buffer.data(), 1, _buffer.size(), _file);
+    _offset += got;
+
+    bool valid = got == header.stored_size &&
+                 record::crc32(_buffer.data(), got) == header.payload_crc;
+    if (valid && header.codec == block::Codec::Stored) {
+        valid = header.raw_size == header.stored_size;
+        raw.assign(_buffer.begin(), _buffer.end());
+    } else if (valid) {
+        raw.resize(header.raw_size);
+        valid = lz::decompress(_buffer.data(), _buffer.size(), raw.data(), raw.size()) ==
+                header.raw_size;
+    }
+    if (!valid) {
+        // The header may belong to a torn block with good ones inside its
+        // announced payload: rescan from just past it
+        (void)seek(block_offset + 1);
+        ++_skipped;
+    }
+    return valid;
+}
+
+bool BlockFileReader::skip_payload(const block::BlockHeader &header) noexcept {
+    return seek(_offset + header.stored_size);
+}
+
+bool BlockFileReader::seek(uint64_t offset) noexcept {
+    if (!_file || std::fseek(_file, static_cast<long>(offset), SEEK_SET) != 0) {
+        return false;
+    }
+    _offset = offset;
+    return true;
+}
+
+} // namespace loggable
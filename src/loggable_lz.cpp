@@ -0,0 +1,188 @@
+#include "loggable_lz.hpp"
+
+#include <cstring>
+
+namespace loggable::lz {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 0xFFFF;
+/// Matches never start in, or extend into, the last few bytes, which
+/// always end up in the final literal run.
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MATCH_LIMIT = 12;
+
+[[nodiscard]] uint32_t read32(const uint8_t *p) noexcept {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] uint32_t hash(uint32_t sequence) noexcept {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * @brief Bounded output cursor; sticks at failure once it overflows.
+ */
+struct Writer {
+    uint8_t *out;
+    size_t capacity;
+    size_t pos{0};
+    bool ok{true};
+
+    uint8_t *reserve(size_t count) noexcept {
+        if (!ok || capacity - pos < count) {
+            ok = false;
+            return nullptr;
+        }
+        uint8_t *p = out + pos;
+        pos += count;
+        return p;
+    }
+
+    void length(size_t extra) noexcept {
+        while (extra >= 255) {
+            if (uint8_t *p = reserve(1)) {
+                *p = 255;
+            }
+            extra -= 255;
+        }
+        if (uint8_t *p = reserve(1)) {
+            *p = static_cast<uint8_t>(extra);
+        }
+    }
+
+    void sequence(const uint8_t *literals, size_t literal_count, size_t offset,
+                  size_t match_length) noexcept {
+        uint8_t *token = reserve(1);
+        if (!token) {
+            return;
+        }
+        const size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+        *token = static_cast<uint8_t>(((literal_count < 15 ? literal_count : 15) << 4) |
+                                      (match_code < 15 ? match_code : 15));
+        if (literal_count >= 15) {
+            length(literal_count - 15);
+        }
+        if (uint8_t *p = reserve(literal_count)) {
+            std::memcpy(p, literals, literal_count);
+        }
+        if (match_length == 0) {
+            return;
+        }
+        if (uint8_t *p = reserve(2)) {
+            p[0] = static_cast<uint8_t>(offset);
+            p[1] = static_cast<uint8_t>(offset >> 8);
+        }
+        if (match_code >= 15) {
+            length(match_code - 15);
+        }
+    }
+};
+
+/**
+ * @brief Read an extended length; false on truncated input.
+ */
+[[nodiscard]] bool read_length(const uint8_t *src, size_t size, size_t &pos,
+                               size_t &length) noexcept {
+    uint8_t byte;
+    do {
+        if (pos >= size) {
+            return false;
+        }
+        byte = src[pos++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity,
+                CompressState &state) noexcept {
+    Writer writer{.out = dst, .capacity = capacity};
+    state.table.fill(0);
+
+    size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        const size_t limit = size - MATCH_LIMIT;
+        size_t pos = 0;
+        while (pos < limit) {
+            const uint32_t sequence = read32(src + pos);
+            uint32_t &slot = state.table[hash(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(pos);
+            if (candidate >= pos || pos - candidate > MAX_OFFSET ||
+                read32(src + candidate) != sequence) {
+                ++pos;
+                continue;
+            }
+
+            size_t length = MIN_MATCH;
+            while (pos + length < size - LAST_LITERALS &&
+                   src[candidate + length] == src[pos + length]) {
+                ++length;
+            }
+            while (pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1]) {
+                --pos;
+                --candidate;
+                ++length;
+            }
+
+            writer.sequence(src + anchor, pos - anchor, pos - candidate, length);
+            pos += length;
+            anchor = pos;
+            if (pos - 2 < limit) {
+                state.table[hash(read32(src + pos - 2))] = static_cast<uint32_t>(pos - 2);
+            }
+        }
+    }
+    writer.sequence(src + anchor, size - anchor, 0, 0);
+    return writer.ok ? writer.pos : 0;
+}
+
+size_t decompress(const uint8_t *src, size_t size, uint8_t *dst,
+                  size_t capacity) noexcept {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < size) {
+        const uint8_t token = src[in++];
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !read_length(src, size, in, literals)) {
+            return 0;
+        }
+        if (size - in < literals || capacity - out < literals) {
+            return 0;
+        }
+        std::memcpy(dst + out, src + in, literals);
+        in += literals;
+        out += literals;
+        if (in == size) {
+            break; // The final sequence has no match
+        }
+
+        if (size - in < 2) {
+            return 0;
+        }
+        const size_t offset = static_cast<size_t>(src[in]) | (static_cast<size_t>(src[in + 1]) << 8);
+        in += 2;
+        size_t length = token & 0x0F;
+        if (length == 15 && !read_length(src, size, in, length)) {
+            return 0;
+        }
+        length += MIN_MATCH;
+        if (offset == 0 || offset > out || capacity - out < length) {
+            return 0;
+        }
+        // Byte by byte: the match may overlap the bytes it produces
+        for (size_t i = 0; i < length; ++i, ++out) {
+            dst[out] = dst[out - offset];
+        }
+    }
+    return out;
+}
+
+} // namespace loggable::lz
@@ -0,0 +1,661 @@
+#include "loggable_net.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "loggable_backend.hpp"
+
+namespace loggable {
+
+namespace net {
+
+namespace {
+
+/// Wait before retrying datagrams the socket refused.
+constexpr uint32_t SEND_RETRY_MS = 10;
+/// Room for the syslog header and the binary datagram header.
+constexpr size_t MIN_DATAGRAM = 512;
+/// Widest RFC 6587 octet count prefix, "4294967295 ".
+constexpr size_t MAX_OCTET_COUNT = 11;
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL; // A closed peer must not raise SIGPIPE
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+[[nodiscard]] uint8_t severity(LogLevel level) noexcept {
+    switch (level) {
+    case LogLevel::Error:
+        return 3;
+    case LogLevel::Warning:
+        return 4;
+    case LogLevel::Info:
+        return 6;
+    case LogLevel::Debug:
+    case LogLevel::Verbose:
+        return 7;
+    case LogLevel::None:
+        break;
+    }
+    return 5; // notice
+}
+
+/// Header field: printable ASCII without spaces, "-" when empty.
+void put_field(std::vector<uint8_t> &out, std::string_view text, size_t max_size) noexcept {
+    text = text.substr(0, max_size);
+    if (text.empty()) {
+        out.push_back('-');
+    }
+    for (const char c : text) {
+        out.push_back(c > ' ' && c <= '~' ? static_cast<uint8_t>(c) : uint8_t{'_'});
+    }
+    out.push_back(' ');
+}
+
+/// STRUCTURED-DATA element for a diagnostic context.
+void put_context(std::vector<uint8_t> &out, const LogContext &context) noexcept {
+    out.push_back('[');
+    out.insert(out.end(), CONTEXT_SD_ID.begin(), CONTEXT_SD_ID.end());
+    context.for_each([&](const std::string &key, const std::string &value) {
+        // PARAM-NAME: up to 32 printable characters other than = ] " and space
+        out.push_back(' ');
+        size_t kept = 0;
+        for (const char c : key) {
+            if (c > ' ' && c <= '~' && c != '=' && c != ']' && c != '"' && kept < 32) {
+                out.push_back(static_cast<uint8_t>(c));
+                ++kept;
+            }
+        }
+        if (kept == 0) {
+            out.push_back('_');
+        }
+        out.push_back('=');
+        out.push_back('"');
+        for (const char c : value) {
+            if (c == '"' || c == '\\' || c == ']') {
+                out.push_back('\\');
+            }
+            out.push_back(c == '\n' || c == '\r' ? uint8_t{' '} : static_cast<uint8_t>(c));
+        }
+        out.push_back('"');
+    });
+    out.push_back(']');
+    out.push_back(' ');
+}
+
+/// RFC 3339 UTC time, e.g. 2023-11-14T22:13:20.123Z
+void put_timestamp(std::vector<uint8_t> &out, int64_t timestamp_ms) noexcept {
+    timestamp_ms = std::max<int64_t>(timestamp_ms, 0);
+    const int64_t days = timestamp_ms / 86'400'000;
+    const int64_t ms_of_day = timestamp_ms % 86'400'000;
+
+    // Civil date from days since 1970-01-01 (H. Hinnant's algorithm)
+    const int64_t z = days + 719'468;
+    const int64_t era = z / 146'097;
+    const int64_t doe = z - era * 146'097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36'524 - doe / 146'096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    const int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+    char text[32];
+    const int size = std::snprintf(
+        text, sizeof(text), "%04lld-%02lld-%02lldT%02lld:%02lld:%02lld.%03lldZ ",
+        static_cast<long long>(year), static_cast<long long>(month),
+        static_cast<long long>(day), static_cast<long long>(ms_of_day / 3'600'000),
+        static_cast<long long>(ms_of_day / 60'000 % 60),
+        static_cast<long long>(ms_of_day / 1000 % 60), static_cast<long long>(ms_of_day % 1000));
+    out.insert(out.end(), text, text + std::min<int>(size, sizeof(text) - 1));
+}
+
+[[nodiscard]] uint32_t now_ms() noexcept {
+    auto *backend = os::bound_backend();
+    return backend ? backend->get_time_ms() : 0;
+}
+
+/// IPv4 address of @p host in network byte order, or 0.
+[[nodiscard]] uint32_t resolve(const std::string &host, int socket_type) noexcept {
+    in_addr address{};
+    if (inet_pton(AF_INET, host.c_str(), &address) == 1) {
+        return address.s_addr;
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = socket_type;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found) {
+        return 0;
+    }
+    address = reinterpret_cast<const sockaddr_in *>(found->ai_addr)->sin_addr;
+    freeaddrinfo(found);
+    return address.s_addr;
+}
+
+[[nodiscard]] bool set_nonblocking(int socket) noexcept {
+    const int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) >= 0;
+}
+
+/// Append @p message in @p format, cut to at most @p limit bytes.
+template <typename Config>
+void encode_record(const LogMessage &message, const Config &config, size_t limit,
+                   std::vector<uint8_t> &out) noexcept {
+    if (config.format == NetFormat::Binary) {
+        (void)record::encode(message, out, limit);
+        return;
+    }
+    const size_t start = out.size();
+    const record::RecordView view{
+        .timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            message.get_timestamp().time_since_epoch()).count(),
+        .level = message.get_level(),
+        .tag = message.get_tag(),
+        .message = message.get_message_view()};
+    format_syslog(view, config.facility, config.hostname, config.app_name, out,
+                  message.get_context().get());
+    out.resize(std::min(out.size(), start + limit));
+}
+
+/// Size of the stream frame at the front of @p data, or 0 if incomplete.
+[[nodiscard]] size_t frame_size(NetFormat format, const uint8_t *data, size_t size) noexcept {
+    if (format == NetFormat::Binary) {
+        record::RecordView view;
+        return record::parse(data, size, view);
+    }
+    size_t length = 0;
+    size_t pos = 0;
+    for (; pos < size && pos < MAX_OCTET_COUNT && data[pos] >= '0' && data[pos] <= '9'; ++pos) {
+        length = length * 10 + (data[pos] - '0');
+    }
+    if (pos == 0 || pos >= size || data[pos] != ' ' || length > size - pos - 1) {
+        return 0;
+    }
+    return pos + 1 + length;
+}
+
+} // namespace
+
+void format_syslog(const record::RecordView &view, uint8_t facility,
+                   std::string_view hostname, std::string_view app_name,
+                   std::vector<uint8_t> &out, const LogContext *context) noexcept {
+    char pri[8];
+    const int size = std::snprintf(pri, sizeof(pri), "<%u>1 ",
+                                   static_cast<unsigned>((facility & 0x1F) * 8 + severity(view.level)));
+    out.insert(out.end(), pri, pri + size);
+    put_timestamp(out, view.timestamp_ms);
+    put_field(out, hostname, 255);
+    put_field(out, app_name, 48);
+    put_field(out, {}, 0);        // PROCID
+    put_field(out, view.tag, 32); // MSGID
+    if (context) {
+        put_context(out, *context);
+    } else {
+        put_field(out, {}, 0);    // STRUCTURED-DATA
+    }
+    // Line breaks would split the record when batched
+    for (const char c : view.message) {
+        out.push_back(c == '\n' || c == '\r' ? uint8_t{' '} : static_cast<uint8_t>(c));
+    }
+}
+
+} // namespace net
+
+UdpSink::UdpSink(UdpSinkConfig config) noexcept : _config(std::move(config)) {
+    _config.max_datagram = std::max(_config.max_datagram, net::MIN_DATAGRAM);
+    _slots.resize(std::max<size_t>(2, _config.max_buffered / _config.max_datagram + 1));
+    for (auto &slot : _slots) {
+        slot.bytes.reserve(_config.max_datagram);
+    }
+    _scratch.reserve(_config.max_datagram);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(_config.port);
+    address.sin_addr.s_addr = net::resolve(_config.host, SOCK_DGRAM);
+    if (address.sin_addr.s_addr == 0) {
+        return;
+    }
+
+    _socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_socket < 0) {
+        return;
+    }
+    if (!net::set_nonblocking(_socket) ||
+        connect(_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0) {
+        close(_socket);
+        _socket = -1;
+    }
+}
+
+UdpSink::~UdpSink() {
+    (void)flush();
+    if (_socket >= 0) {
+        close(_socket);
+    }
+}
+
+void UdpSink::consume(const LogMessage &message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socket < 0) {
+        return;
+    }
+
+    // Encode the record alone first, cut to fit an empty datagram
+    _scratch.clear();
+    net::encode_record(message, _config,
+                       _config.format == NetFormat::Binary
+                           ? _config.max_datagram - net::DATAGRAM_HEADER_SIZE
+                           : _config.max_datagram,
+                       _scratch);
+
+    const size_t separator = _config.format == NetFormat::Syslog ? 1 : 0;
+    if (_open_datagram().records > 0 &&
+        _open_datagram().bytes.size() + separator + _scratch.size() > _config.max_datagram) {
+        _seal();
+    }
+
+    Datagram &open = _open_datagram();
+    if (open.records == 0) {
+        open.bytes.clear();
+        if (_config.format == NetFormat::Binary) {
+            record::put_u32(open.bytes, net::DATAGRAM_MAGIC);
+            record::put_u32(open.bytes, _sequence++);
+        }
+        _open_since_ms = net::now_ms();
+    } else if (separator) {
+        open.bytes.push_back('\n');
+    }
+    open.bytes.insert(open.bytes.end(), _scratch.begin(), _scratch.end());
+    ++open.records;
+    ++_stats.records;
+
+    if (_config.max_records > 0 && open.records >= _config.max_records) {
+        _seal();
+    }
+    _send_ready();
+}
+
+uint32_t UdpSink::on_idle() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socket < 0) {
+        return os::WAIT_FOREVER;
+    }
+
+    uint32_t wait_ms = os::WAIT_FOREVER;
+    if (_open_datagram().records > 0) {
+        const uint32_t age_ms = net::now_ms() - _open_since_ms;
+        if (age_ms >= _config.linger_ms || !os::bound_backend()) {
+            _seal();
+        } else {
+            wait_ms = _config.linger_ms - age_ms;
+        }
+    }
+    _send_ready();
+    return _sealed > 0 ? std::min(wait_ms, net::SEND_RETRY_MS) : wait_ms;
+}
+
+bool UdpSink::flush() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socket < 0) {
+        return true;
+    }
+    _seal();
+    _send_ready();
+    return _sealed == 0;
+}
+
+UdpSink::Stats UdpSink::stats() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+SinkBackpressure UdpSink::backpressure() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    SinkBackpressure result{.dropped_count = _stats.records_dropped, .stalled = _socket < 0};
+    for (size_t i = 0; i < _sealed; ++i) {
+        result.buffered_bytes += _slots[(_head + i) % _slots.size()].bytes.size();
+    }
+    return result;
+}
+
+void UdpSink::_seal() noexcept {
+    if (_open_datagram().records == 0) {
+        return;
+    }
+    if (_sealed == _slots.size() - 1) {
+        // No slot left to open next: the oldest datagram goes
+        Datagram &oldest = _slots[_head];
+        ++_stats.datagrams_dropped;
+        _stats.records_dropped += oldest.records;
+        oldest.records = 0;
+        _head = (_head + 1) % _slots.size();
+        --_sealed;
+    }
+    ++_sealed;
+    _open_datagram().records = 0;
+}
+
+void UdpSink::_send_ready() noexcept {
+    while (_sealed > 0) {
+        Datagram &datagram = _slots[_head];
+        const ssize_t sent = send(_socket, datagram.bytes.data(), datagram.bytes.size(), 0);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS ||
+                         errno == ENOMEM)) {
+            return; // The stack is out of buffers; retry when idle
+        }
+        if (sent < 0) {
+            ++_stats.datagrams_dropped;
+            _stats.records_dropped += datagram.records;
+        } else {
+            ++_stats.datagrams_sent;
+            _stats.bytes_sent += static_cast<uint64_t>(sent);
+        }
+        datagram.records = 0;
+        _head = (_head + 1) % _slots.size();
+        --_sealed;
+    }
+}
+
+TcpSink::TcpSink(TcpSinkConfig config) noexcept : _config(std::move(config)) {
+    _config.batch_bytes = std::max(_config.batch_bytes, net::MIN_DATAGRAM);
+    _config.backoff_min_ms = std::max<uint32_t>(_config.backoff_min_ms, 1);
+    _config.backoff_max_ms = std::max(_config.backoff_max_ms, _config.backoff_min_ms);
+    _slots.resize(std::max<size_t>(2, _config.buffer_bytes / _config.batch_bytes + 1));
+    for (auto &slot : _slots) {
+        slot.bytes.reserve(_config.batch_bytes);
+    }
+    _inflight.bytes.reserve(_config.batch_bytes);
+    _scratch.reserve(_config.batch_bytes);
+    _address = net::resolve(_config.host, SOCK_STREAM);
+    _retry_at_ms = net::now_ms();
+}
+
+TcpSink::~TcpSink() {
+    (void)flush();
+    if (_socket >= 0) {
+        close(_socket);
+    }
+}
+
+void TcpSink::consume(const LogMessage &message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Frame the record alone first, cut to fit an empty batch
+    _scratch.clear();
+    if (_config.format == NetFormat::Binary) {
+        net::encode_record(message, _config, _config.batch_bytes, _scratch);
+    } else {
+        // RFC 6587 octet counting: "LEN SP MSG"
+        net::encode_record(message, _config, _config.batch_bytes - net::MAX_OCTET_COUNT, _scratch);
+        char prefix[net::MAX_OCTET_COUNT + 1];
+        const int size = std::snprintf(prefix, sizeof(prefix), "%zu ", _scratch.size());
+        _scratch.insert(_scratch.begin(), prefix, prefix + size);
+    }
+
+    if (_open_batch().records > 0 &&
+        _open_batch().bytes.size() + _scratch.size() > _config.batch_bytes) {
+        _seal();
+    }
+    Batch &open = _open_batch();
+    if (open.records == 0) {
+        open.bytes.clear();
+        _open_since_ms = net::now_ms();
+    }
+    open.bytes.insert(open.bytes.end(), _scratch.begin(), _scratch.end());
+    ++open.records;
+    ++_stats.records;
+    _pump();
+}
+
+uint32_t TcpSink::on_idle() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint32_t wait_ms = os::WAIT_FOREVER;
+    if (_open_batch().records > 0) {
+        const uint32_t age_ms = net::now_ms() - _open_since_ms;
+        if (age_ms >= _config.linger_ms || !os::bound_backend()) {
+            _seal();
+        } else {
+            wait_ms = _config.linger_ms - age_ms;
+        }
+    }
+
+    if (_state == State::Connected) {
+        // A collector does not talk back; a readable socket means it hung up
+        uint8_t discard[64];
+        const ssize_t got = recv(_socket, discard, sizeof(discard), MSG_DONTWAIT);
+        if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            _close();
+        }
+    }
+    _pump();
+
+    if (!_has_unsent()) {
+        return wait_ms;
+    }
+    if (_state == State::Disconnected) {
+        if (_address == 0) {
+            return wait_ms;
+        }
+        const auto until_retry = static_cast<int32_t>(_retry_at_ms - net::now_ms());
+        return std::min(wait_ms, static_cast<uint32_t>(std::max<int32_t>(until_retry, 1)));
+    }
+    return std::min(wait_ms, net::SEND_RETRY_MS); // Connecting, or the socket is full
+}
+
+bool TcpSink::flush() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _seal();
+    _pump();
+    return !_has_unsent();
+}
+
+bool TcpSink::is_connected() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _state == State::Connected;
+}
+
+TcpSink::Stats TcpSink::stats() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+SinkBackpressure TcpSink::backpressure() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    SinkBackpressure result{.buffered_bytes = _inflight.bytes.size() - _sent,
+                            .dropped_count = _stats.records_dropped,
+                            .stalled = _has_unsent() && _state != State::Connected};
+    for (size_t i = 0; i <= _sealed; ++i) {
+        const Batch &batch = _slots[(_head + i) % _slots.size()];
+        result.buffered_bytes += batch.records > 0 ? batch.bytes.size() : 0;
+    }
+    if (_stored > 0) {
+        result.buffered_bytes += _config.overflow_store->size_bytes();
+    }
+    return result;
+}
+
+bool TcpSink::_has_unsent() const noexcept {
+    return _sent < _inflight.bytes.size() || _stored > 0 || _sealed > 0;
+}
+
+void TcpSink::_seal() noexcept {
+    if (_open_batch().records == 0) {
+        return;
+    }
+    if (_sealed == _slots.size() - 1) {
+        _evict_oldest(); // No slot left to open next
+    }
+    ++_sealed;
+    _open_batch().records = 0;
+}
+
+void TcpSink::_evict_oldest() noexcept {
+    Batch &oldest = _slots[_head];
+    bool kept = false;
+    if (_config.overflow_store) {
+        _frame.clear();
+        record::put_u32(_frame, static_cast<uint32_t>(oldest.records));
+        _frame.insert(_frame.end(), oldest.bytes.begin(), oldest.bytes.end());
+        kept = _config.overflow_store->append(_frame.data(), _frame.size());
+    }
+    if (kept) {
+        ++_stored;
+        ++_stats.batches_stored;
+    } else {
+        _stats.records_dropped += oldest.records;
+    }
+    oldest.records = 0;
+    _head = (_head + 1) % _slots.size();
+    --_sealed;
+}
+
+bool TcpSink::_next_batch() noexcept {
+    if (_sent < _inflight.bytes.size()) {
+        return true;
+    }
+    _inflight.bytes.clear();
+    _inflight.records = 0;
+    _sent = 0;
+
+    // Stored batches are older than any in memory
+    while (_stored > 0) {
+        --_stored;
+        if (_config.overflow_store->read(_frame) && _frame.size() > 4) {
+            _inflight.records = record::get_u32(_frame.data());
+            _inflight.bytes.assign(_frame.begin() + 4, _frame.end());
+            return true;
+        }
+        if (_config.overflow_store->size_bytes() == 0) {
+            _stored = 0;
+        }
+    }
+    if (_sealed == 0) {
+        return false;
+    }
+    Batch &oldest = _slots[_head];
+    std::swap(_inflight.bytes, oldest.bytes);
+    _inflight.records = oldest.records;
+    oldest.records = 0;
+    _head = (_head + 1) % _slots.size();
+    --_sealed;
+    return true;
+}
+
+void TcpSink::_pump() noexcept {
+    while (_has_unsent() && _connection_ready() && _next_batch()) {
+        const ssize_t sent = send(_socket, _inflight.bytes.data() + _sent,
+                                  _inflight.bytes.size() - _sent, net::SEND_FLAGS);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return; // The collector is slow; retry when idle
+        }
+        if (sent < 0) {
+            _close();
+            return;
+        }
+        _sent += static_cast<size_t>(sent);
+        _stats.bytes_sent += static_cast<uint64_t>(sent);
+    }
+}
+
+bool TcpSink::_connection_ready() noexcept {
+    if (_state == State::Connected) {
+        return true;
+    }
+    const uint32_t now = net::now_ms();
+    if (_state == State::Disconnected) {
+        if (_address == 0 ||
+            (os::bound_backend() && static_cast<int32_t>(now - _retry_at_ms) < 0)) {
+            return false;
+        }
+        _socket = socket(AF_INET, SOCK_STREAM, 0);
+        if (_socket < 0 || !net::set_nonblocking(_socket)) {
+            _close();
+            return false;
+        }
+        const int one = 1;
+        (void)setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(_config.port);
+        address.sin_addr.s_addr = _address;
+        if (connect(_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 &&
+            errno != EINPROGRESS) {
+            _close();
+            return false;
+        }
+        _state = State::Connecting;
+        _connect_started_ms = now;
+    }
+
+    pollfd fd{.fd = _socket, .events = POLLOUT, .revents = 0};
+    if (poll(&fd, 1, 0) == 1) {
+        int error = 0;
+        socklen_t size = sizeof(error);
+        if (getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &size) < 0 || error != 0) {
+            _close();
+            return false;
+        }
+        _state = State::Connected;
+        _backoff_ms = 0;
+        ++_stats.connects;
+        return true;
+    }
+    if (now - _connect_started_ms >= _config.connect_timeout_ms) {
+        _close();
+    }
+    return false;
+}
+
+void TcpSink::_close() noexcept {
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+    if (_state == State::Connected) {
+        ++_stats.disconnects;
+    } else {
+        ++_stats.connect_failures;
+    }
+    _state = State::Disconnected;
+    _backoff_ms = _backoff_ms == 0 ? _config.backoff_min_ms
+                                   : std::min(_backoff_ms * 2, _config.backoff_max_ms);
+    _retry_at_ms = net::now_ms() + _backoff_ms;
+
+    // Resend from the first record not wholly written; the collector
+    // never sees half a frame at the start of a connection
+    size_t boundary = 0;
+    size_t frames = 0;
+    while (boundary < _sent) {
+        const size_t size = net::frame_size(_config.format, _inflight.bytes.data() + boundary,
+                                            _inflight.bytes.size() - boundary);
+        if (size == 0 || boundary + size > _sent) {
+            break;
+        }
+        boundary += size;
+        ++frames;
+    }
+    if (_sent < _inflight.bytes.size()) {
+        _sent = boundary;
+        _inflight.records -= std::min(frames, _inflight.records);
+    }
+}
+
+} // namespace loggable
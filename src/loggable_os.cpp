@@ -1,8 +1,19 @@
-#include "loggable_os.hpp"
+#include "loggable_backend.hpp"
 #include <atomic>
 
 namespace loggable::os {
 
+#if defined(LOGGABLE_BACKEND_TYPE)
+
+// The backend is bound at compile time; the runtime registry is inert.
+void set_backend(IAsyncBackend* /*backend*/) noexcept {}
+
+IAsyncBackend* get_backend() noexcept {
+    return bound_backend();
+}
+
+#else
+
 namespace {
 std::atomic<IAsyncBackend*> g_backend{nullptr};
 } // namespace
@@ -15,5 +26,6 @@ IAsyncBackend* get_backend() noexcept {
     return g_backend.load(std::memory_order_acquire);
 }
 
-} // namespace loggable::os
+#endif
 
+} // namespace loggable::os
@@ -0,0 +1,274 @@
+#include "loggable_pool.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace loggable {
+
+namespace {
+
+constexpr uint32_t NO_BLOCK = UINT32_MAX;
+constexpr uint32_t INDEX_MASK = PayloadPool::MAX_BLOCKS;
+constexpr unsigned TAG_SHIFT = 16;
+
+// The 16-bit tag wraps after 65536 updates; a thread preempted between
+// loading the head and exchanging it for that long could still see ABA
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "PayloadPool needs a lock-free 32-bit atomic");
+
+/// Guards every pool's cache list and every ThreadCache::pool.
+std::mutex &caches_mutex() noexcept {
+    static std::mutex mutex;
+    return mutex;
+}
+
+/// Smallest class holding @p bytes, or CLASS_COUNT if none does.
+[[nodiscard]] size_t class_index(size_t bytes, size_t alignment) noexcept {
+    if (alignment > alignof(std::max_align_t)) {
+        return PayloadPool::CLASS_COUNT;
+    }
+    const auto &sizes = PayloadPoolConfig::BLOCK_SIZES;
+    return static_cast<size_t>(std::lower_bound(sizes.begin(), sizes.end(), bytes) - sizes.begin());
+}
+
+/// Blocks moved between a thread cache and the shared list at once.
+[[nodiscard]] size_t batch_size(uint32_t cache_limit) noexcept {
+    return std::max<size_t>(cache_limit / 2, 1);
+}
+
+} // namespace
+
+/**
+ * @brief Free blocks one thread keeps for one pool.
+ *
+ * Only its thread touches the blocks; pool changes under caches_mutex().
+ */
+struct PayloadPool::ThreadCache {
+    struct Blocks {
+        std::array<uint32_t, CACHE_BLOCKS> indices{};
+        size_t count{0};
+    };
+
+    std::atomic<PayloadPool *> pool{nullptr};
+    std::array<Blocks, CLASS_COUNT> classes{};
+    ThreadCache *next{nullptr}; ///< In pool->_caches
+
+    ~ThreadCache() {
+        std::lock_guard<std::mutex> lock(caches_mutex());
+        if (auto *owner = pool.load(std::memory_order_relaxed)) {
+            owner->_detach(*this);
+        }
+    }
+};
+
+PayloadPool::PayloadPool(PayloadPoolConfig config) noexcept
+    : _upstream(config.upstream ? config.upstream : std::pmr::get_default_resource()) {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        Class &cls = _classes[i];
+        cls.capacity = std::min(config.blocks[i], MAX_BLOCKS);
+        if (cls.capacity == 0) {
+            continue;
+        }
+        cls.cache_limit = std::clamp<uint32_t>(cls.capacity / 8, 1, CACHE_BLOCKS);
+        cls.slab = static_cast<std::byte *>(_upstream->allocate(
+            size_t{cls.capacity} * PayloadPoolConfig::BLOCK_SIZES[i], alignof(std::max_align_t)));
+        cls.next = static_cast<std::atomic<uint32_t> *>(_upstream->allocate(
+            cls.capacity * sizeof(std::atomic<uint32_t>), alignof(std::atomic<uint32_t>)));
+        // Every block starts on the shared list, in address order
+        for (uint32_t block = 0; block < cls.capacity; ++block) {
+            std::construct_at(&cls.next[block], block + 1 < cls.capacity ? block + 2 : 0);
+        }
+        cls.head.store(1, std::memory_order_relaxed);
+    }
+}
+
+PayloadPool::~PayloadPool() {
+    {
+        // Blocks still cached by other threads go away with the slabs
+        std::lock_guard<std::mutex> lock(caches_mutex());
+        for (ThreadCache *cache = _caches; cache; cache = cache->next) {
+            cache->pool.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        Class &cls = _classes[i];
+        if (cls.capacity == 0) {
+            continue;
+        }
+        std::destroy_n(cls.next, cls.capacity);
+        _upstream->deallocate(cls.next, cls.capacity * sizeof(std::atomic<uint32_t>),
+                              alignof(std::atomic<uint32_t>));
+        _upstream->deallocate(cls.slab, size_t{cls.capacity} * PayloadPoolConfig::BLOCK_SIZES[i],
+                              alignof(std::max_align_t));
+    }
+}
+
+PayloadPool::Stats PayloadPool::stats() const noexcept {
+    Stats stats;
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        const Class &cls = _classes[i];
+        stats.classes[i] = SizeClass{
+            .block_size = PayloadPoolConfig::BLOCK_SIZES[i],
+            .capacity = cls.capacity,
+            .in_use = cls.in_use.load(std::memory_order_relaxed),
+            .peak_in_use = cls.peak_in_use.load(std::memory_order_relaxed),
+            .exhausted = cls.exhausted.load(std::memory_order_relaxed)};
+    }
+    stats.oversize = _oversize.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void *PayloadPool::do_allocate(size_t bytes, size_t alignment) {
+    const size_t index = class_index(bytes, alignment);
+    if (index == CLASS_COUNT) {
+        _oversize.fetch_add(1, std::memory_order_relaxed);
+        return _upstream->allocate(bytes, alignment);
+    }
+
+    Class &cls = _classes[index];
+    auto &blocks = _cache().classes[index];
+    if (blocks.count == 0) {
+        const size_t batch = batch_size(cls.cache_limit);
+        while (blocks.count < batch) {
+            const uint32_t block = _pop(cls);
+            if (block == NO_BLOCK) {
+                break;
+            }
+            blocks.indices[blocks.count++] = block;
+        }
+        if (blocks.count == 0) {
+            cls.exhausted.fetch_add(1, std::memory_order_relaxed);
+            return _upstream->allocate(bytes, alignment);
+        }
+    }
+
+    const uint32_t block = blocks.indices[--blocks.count];
+    const size_t in_use = cls.in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t peak = cls.peak_in_use.load(std::memory_order_relaxed);
+    while (in_use > peak &&
+           !cls.peak_in_use.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    return cls.slab + size_t{block} * PayloadPoolConfig::BLOCK_SIZES[index];
+}
+
+void PayloadPool::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    const size_t index = class_index(bytes, alignment);
+    if (index == CLASS_COUNT) {
+        _upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+
+    // Blocks from an exhausted class came from upstream
+    Class &cls = _classes[index];
+    const size_t block_size = PayloadPoolConfig::BLOCK_SIZES[index];
+    auto *block = static_cast<std::byte *>(p);
+    const std::less<std::byte *> before;
+    if (cls.capacity == 0 || before(block, cls.slab) ||
+        !before(block, cls.slab + size_t{cls.capacity} * block_size)) {
+        _upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+
+    auto &blocks = _cache().classes[index];
+    if (blocks.count >= cls.cache_limit) {
+        // Hand the oldest to the other threads
+        const size_t batch = batch_size(cls.cache_limit);
+        _push(cls, blocks.indices.data(), batch);
+        std::copy(blocks.indices.begin() + static_cast<ptrdiff_t>(batch),
+                  blocks.indices.begin() + static_cast<ptrdiff_t>(blocks.count),
+                  blocks.indices.begin());
+        blocks.count -= batch;
+    }
+    blocks.indices[blocks.count++] = static_cast<uint32_t>((block - cls.slab) / block_size);
+    cls.in_use.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool PayloadPool::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+PayloadPool::ThreadCache &PayloadPool::_cache() noexcept {
+    thread_local std::array<ThreadCache, CACHED_POOLS> caches;
+    thread_local size_t victim = 0;
+    ThreadCache *unused = nullptr;
+    for (auto &cache : caches) {
+        const PayloadPool *owner = cache.pool.load(std::memory_order_relaxed);
+        if (owner == this) {
+            return cache;
+        }
+        if (!owner && !unused) {
+            unused = &cache;
+        }
+    }
+    // Otherwise the caches take turns moving to a new pool
+    ThreadCache &cache = unused ? *unused : caches[victim++ % CACHED_POOLS];
+    _attach(cache);
+    return cache;
+}
+
+void PayloadPool::_attach(ThreadCache &cache) noexcept {
+    std::lock_guard<std::mutex> lock(caches_mutex());
+    if (auto *previous = cache.pool.load(std::memory_order_relaxed)) {
+        previous->_detach(cache);
+    }
+    for (auto &blocks : cache.classes) {
+        blocks.count = 0; // Left over from a pool destroyed meanwhile
+    }
+    cache.next = _caches;
+    _caches = &cache;
+    cache.pool.store(this, std::memory_order_relaxed);
+}
+
+void PayloadPool::_detach(ThreadCache &cache) noexcept {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        auto &blocks = cache.classes[i];
+        _push(_classes[i], blocks.indices.data(), blocks.count);
+        blocks.count = 0;
+    }
+    for (ThreadCache **link = &_caches; *link; link = &(*link)->next) {
+        if (*link == &cache) {
+            *link = cache.next;
+            break;
+        }
+    }
+    cache.next = nullptr;
+    cache.pool.store(nullptr, std::memory_order_relaxed);
+}
+
+uint32_t PayloadPool::_pop(Class &cls) noexcept {
+    uint32_t head = cls.head.load(std::memory_order_acquire);
+    while ((head & INDEX_MASK) != 0) {
+        const uint32_t block = (head & INDEX_MASK) - 1;
+        // May be stale if another thread takes the block first; the tag
+        // then fails the exchange
+        const uint32_t next = cls.next[block].load(std::memory_order_relaxed);
+        const uint32_t desired = (((head >> TAG_SHIFT) + 1) << TAG_SHIFT) | next;
+        if (cls.head.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                           std::memory_order_acquire)) {
+            return block;
+        }
+    }
+    return NO_BLOCK;
+}
+
+void PayloadPool::_push(Class &cls, const uint32_t *indices, size_t count) noexcept {
+    if (count == 0) {
+        return;
+    }
+    // Link the batch first, then splice it in with one exchange
+    for (size_t i = 0; i + 1 < count; ++i) {
+        cls.next[indices[i]].store(indices[i + 1] + 1, std::memory_order_relaxed);
+    }
+    const uint32_t last = indices[count - 1];
+    uint32_t head = cls.head.load(std::memory_order_relaxed);
+    uint32_t desired = 0;
+    do {
+        cls.next[last].store(head & INDEX_MASK, std::memory_order_relaxed);
+        desired = (((head >> TAG_SHIFT) + 1) << TAG_SHIFT) | (indices[0] + 1);
+    } while (!cls.head.compare_exchange_weak(head, desired, std::memory_order_release,
+                                             std::memory_order_relaxed));
+}
+
+} // namespace loggable
@@ -0,0 +1,135 @@
+#include "loggable_query.hpp"
+
+#include <algorithm>
+
+namespace loggable {
+
+namespace {
+
+/**
+ * @brief Does the block at @p entry have the header the index promises?
+ */
+[[nodiscard]] bool at_entry(BlockFileReader &reader, const block::IndexEntry &entry,
+                            block::BlockHeader &header) noexcept {
+    return reader.seek(entry.offset) && reader.next(header) &&
+           reader.block_offset() == entry.offset &&
+           block::HEADER_SIZE + header.extensions.size() + header.stored_size == entry.size &&
+           header.record_count == entry.record_count && header.min_ms == entry.min_ms &&
+           header.max_ms == entry.max_ms;
+}
+
+[[nodiscard]] bool has_token(std::string_view text, std::string_view word) noexcept {
+    bool found = false;
+    block::for_each_token(text, [&](std::string_view token) { found = found || token == word; });
+    return found;
+}
+
+} // namespace
+
+bool LogQuery::may_match(const block::BlockHeader &header) const noexcept {
+    const block::BlockSummary summary = block::summary(header);
+    bool level = false;
+    for (auto l = static_cast<uint8_t>(most_severe); l <= static_cast<uint8_t>(least_severe); ++l) {
+        level = level || summary.may_have(static_cast<LogLevel>(l));
+    }
+    const bool tag = tags.empty() || std::any_of(tags.begin(), tags.end(), [&](const std::string &t) {
+        return summary.may_contain(block::tag_hash(t));
+    });
+    const bool word = std::all_of(words.begin(), words.end(), [&](const std::string &w) {
+        return summary.may_contain(block::token_hash(w));
+    });
+    return level && tag && word;
+}
+
+bool LogQuery::matches(const record::RecordView &view) const noexcept {
+    if (view.timestamp_ms < from_ms || view.timestamp_ms > to_ms ||
+        view.level < most_severe || view.level > least_severe) {
+        return false;
+    }
+    if (!tags.empty() && std::find(tags.begin(), tags.end(), view.tag) == tags.end()) {
+        return false;
+    }
+    return std::all_of(words.begin(), words.end(),
+                       [&](const std::string &w) { return has_token(view.message, w); });
+}
+
+QueryStats run_query(const std::string &path, const LogQuery &query,
+                     const std::function<void(const record::RecordView &)> &fn) {
+    QueryStats stats;
+    BlockFileReader reader(path);
+    if (!reader.is_open()) {
+        return stats;
+    }
+
+    block::BlockHeader header;
+    std::vector<uint8_t> raw;
+    // Called with the reader positioned at the payload of `header`
+    const auto visit = [&] {
+        if (!query.overlaps(header.min_ms, header.max_ms)) {
+            (void)reader.skip_payload(header);
+            return;
+        }
+        if (!query.may_match(header)) {
+            ++stats.blocks_filtered;
+            (void)reader.skip_payload(header);
+            return;
+        }
+        if (!reader.read_payload(header, raw)) {
+            ++stats.blocks_damaged;
+            return;
+        }
+        ++stats.blocks_read;
+        const bool whole = block::for_each_record(header, raw, [&](const record::RecordView &view) {
+            if (query.matches(view)) {
+                ++stats.records_matched;
+                fn(view);
+            }
+        });
+        if (!whole) {
+            ++stats.blocks_damaged;
+        }
+    };
+
+    // Check every entry to be used before emitting anything, so a stale
+    // index falls back to a full scan without duplicate output
+    std::vector<block::IndexEntry> index;
+    std::vector<const block::IndexEntry *> hits;
+    size_t filtered = 0;
+    bool usable = block::load_index(path, index) && !index.empty() &&
+                  at_entry(reader, index.back(), header);
+    for (size_t i = 0; usable && i < index.size(); ++i) {
+        if (!query.overlaps(index[i].min_ms, index[i].max_ms)) {
+            continue;
+        }
+        usable = at_entry(reader, index[i], header);
+        if (query.may_match(header)) {
+            hits.push_back(&index[i]);
+        } else {
+            ++filtered;
+        }
+    }
+
+    uint64_t resume = 0;
+    if (usable) {
+        stats.used_index = true;
+        stats.blocks_total = index.size();
+        stats.blocks_filtered = filtered;
+        for (const block::IndexEntry *entry : hits) {
+            (void)reader.seek(entry->offset);
+            if (reader.next(header)) {
+                visit();
+            }
+        }
+        // Blocks written after the last indexed one
+        resume = index.back().offset + index.back().size;
+    }
+
+    (void)reader.seek(resume);
+    while (reader.next(header)) {
+        ++stats.blocks_total;
+        visit();
+    }
+    return stats;
+}
+
+} // namespace loggable
@@ -0,0 +1,79 @@
+#include "loggable_record.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace loggable::record {
+
+size_t encoded_size(const LogMessage &message) noexcept {
+    return HEADER_SIZE + std::min(message.get_tag().size(), MAX_TAG_SIZE) +
+           std::min(message.get_message_view().size(), MAX_MESSAGE_SIZE);
+}
+
+size_t encode(const LogMessage &message, std::vector<uint8_t> &out, size_t max_size) noexcept {
+    const size_t room = std::max(max_size, HEADER_SIZE) - HEADER_SIZE;
+    const std::string_view tag =
+        std::string_view(message.get_tag()).substr(0, std::min(MAX_TAG_SIZE, room));
+    const std::string_view text = message.get_message_view()
+        .substr(0, std::min(MAX_MESSAGE_SIZE, room - tag.size()));
+    const auto timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        message.get_timestamp().time_since_epoch()).count();
+
+    const size_t start = out.size();
+    put_u64(out, static_cast<uint64_t>(timestamp_ms));
+    out.push_back(static_cast<uint8_t>(message.get_level()));
+    out.push_back(static_cast<uint8_t>(tag.size()));
+    put_u16(out, static_cast<uint16_t>(text.size()));
+    out.insert(out.end(), tag.begin(), tag.end());
+    out.insert(out.end(), text.begin(), text.end());
+    return out.size() - start;
+}
+
+size_t parse(const uint8_t *data, size_t size, RecordView &out) noexcept {
+    if (size < HEADER_SIZE || data[8] > static_cast<uint8_t>(LogLevel::Verbose)) {
+        return 0;
+    }
+    const size_t tag_size = data[9];
+    const size_t text_size = get_u16(data + 10);
+    const size_t total = HEADER_SIZE + tag_size + text_size;
+    if (size < total) {
+        return 0;
+    }
+
+    const auto *chars = reinterpret_cast<const char *>(data + HEADER_SIZE);
+    out.timestamp_ms = static_cast<int64_t>(get_u64(data));
+    out.level = static_cast<LogLevel>(data[8]);
+    out.tag = std::string_view(chars, tag_size);
+    out.message = std::string_view(chars + tag_size, text_size);
+    return total;
+}
+
+size_t decode(const uint8_t *data, size_t size, LogMessage &out) noexcept {
+    RecordView view;
+    const size_t consumed = parse(data, size, view);
+    if (consumed == 0) {
+        return 0;
+    }
+    out = LogMessage(std::chrono::system_clock::time_point(
+                         std::chrono::milliseconds(view.timestamp_ms)),
+                     view.level, LogMessage::Tag(view.tag), LogMessage::Text(view.message));
+    return consumed;
+}
+
+uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc) noexcept {
+    // Nibble table: 64 bytes of flash instead of 1 KiB
+    static constexpr uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+} // namespace loggable::record
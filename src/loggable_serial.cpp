@@ -0,0 +1,182 @@
+#include "loggable_serial.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <unistd.h>
+
+namespace loggable {
+
+namespace serial {
+
+namespace {
+
+/// Wait before retrying bytes the port refused.
+constexpr uint32_t WRITE_RETRY_MS = 5;
+/// A COBS block holds up to 254 data bytes after its code byte.
+constexpr uint8_t MAX_CODE = 0xFF;
+
+} // namespace
+
+void cobs_encode(const uint8_t *data, size_t size, std::vector<uint8_t> &out) noexcept {
+    size_t code_pos = out.size();
+    uint8_t code = 1;
+    out.push_back(0);
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != 0) {
+            out.push_back(data[i]);
+            ++code;
+        }
+        if (data[i] == 0 || code == MAX_CODE) {
+            out[code_pos] = code;
+            code_pos = out.size();
+            code = 1;
+            out.push_back(0);
+        }
+    }
+    out[code_pos] = code;
+}
+
+bool cobs_decode(const uint8_t *data, size_t size, std::vector<uint8_t> &out) noexcept {
+    out.clear();
+    for (size_t pos = 0; pos < size;) {
+        const uint8_t code = data[pos++];
+        if (code == 0 || code - 1u > size - pos) {
+            return false;
+        }
+        const uint8_t *block = data + pos;
+        if (std::find(block, block + code - 1, uint8_t{0}) != block + code - 1) {
+            return false;
+        }
+        out.insert(out.end(), block, block + code - 1);
+        pos += code - 1;
+        if (code != MAX_CODE && pos < size) {
+            out.push_back(0);
+        }
+    }
+    return true;
+}
+
+void encode_frame(const uint8_t *record, size_t size, uint16_t sequence,
+                  std::vector<uint8_t> &payload, std::vector<uint8_t> &out) noexcept {
+    payload.clear();
+    record::put_u16(payload, sequence);
+    payload.insert(payload.end(), record, record + size);
+    record::put_u32(payload, record::crc32(payload.data(), payload.size()));
+
+    // Leading delimiter: whatever came before, e.g. console text, ends there
+    out.push_back(DELIMITER);
+    cobs_encode(payload.data(), payload.size(), out);
+    out.push_back(DELIMITER);
+}
+
+bool FrameDecoder::_finish(record::RecordView &view) noexcept {
+    const bool overlong = _overlong;
+    _overlong = false;
+    if (_frame.empty() && !overlong) {
+        return false; // Delimiters back to back
+    }
+
+    bool valid = !overlong && cobs_decode(_frame.data(), _frame.size(), _payload) &&
+                 _payload.size() >= FRAME_OVERHEAD + record::HEADER_SIZE;
+    _frame.clear();
+    if (valid) {
+        const size_t body = _payload.size() - 4;
+        valid = record::crc32(_payload.data(), body) == record::get_u32(_payload.data() + body) &&
+                record::parse(_payload.data() + 2, body - 2, view) == body - 2;
+    }
+    if (!valid) {
+        ++_stats.bad_frames;
+        return false;
+    }
+
+    // Sequence 0 out of turn is the sender starting over, e.g. after a reset
+    const uint16_t sequence = record::get_u16(_payload.data());
+    if (_synced && !(sequence == 0 && _expected != 0)) {
+        _stats.lost_frames += static_cast<uint16_t>(sequence - _expected);
+    }
+    _synced = true;
+    _expected = static_cast<uint16_t>(sequence + 1);
+    ++_stats.frames;
+    return true;
+}
+
+} // namespace serial
+
+SerialSink::SerialSink(int fd, SerialSinkConfig config) noexcept : _fd(fd), _config(config) {
+    _config.max_record = std::max(_config.max_record, record::HEADER_SIZE);
+    _pending.reserve(_config.buffer_bytes);
+    _record.reserve(_config.max_record);
+    _payload.reserve(_config.max_record + serial::FRAME_OVERHEAD);
+    _frame.reserve(_config.max_record + serial::FRAME_OVERHEAD + _config.max_record / 254 + 4);
+}
+
+SerialSink::~SerialSink() {
+    (void)flush();
+}
+
+void SerialSink::consume(const LogMessage &message) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _record.clear();
+    (void)record::encode(message, _record, _config.max_record);
+    _frame.clear();
+    serial::encode_frame(_record.data(), _record.size(), _sequence++, _payload, _frame);
+
+    _write_pending(); // Make room first
+    if (_pending.size() - _written + _frame.size() > _config.buffer_bytes) {
+        ++_stats.frames_dropped;
+        return;
+    }
+    if (_pending.size() + _frame.size() > _config.buffer_bytes) {
+        _pending.erase(_pending.begin(), _pending.begin() + static_cast<ptrdiff_t>(_written));
+        _written = 0;
+    }
+    _pending.insert(_pending.end(), _frame.begin(), _frame.end());
+    ++_stats.frames;
+    _write_pending();
+}
+
+uint32_t SerialSink::on_idle() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _write_pending();
+    return _pending.empty() ? os::WAIT_FOREVER : serial::WRITE_RETRY_MS;
+}
+
+bool SerialSink::flush() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _write_pending();
+    return _pending.empty();
+}
+
+SinkBackpressure SerialSink::backpressure() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return {.buffered_bytes = _pending.size() - _written,
+            .dropped_count = _stats.frames_dropped};
+}
+
+SerialSink::Stats SerialSink::stats() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void SerialSink::_write_pending() noexcept {
+    while (_written < _pending.size()) {
+        const ssize_t written = write(_fd, _pending.data() + _written, _pending.size() - _written);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return; // The port is busy; retry when idle
+        }
+        if (written < 0) {
+            ++_stats.write_errors;
+            break;
+        }
+        _written += static_cast<size_t>(written);
+        _stats.bytes_written += static_cast<uint64_t>(written);
+    }
+    _pending.clear();
+    _written = 0;
+}
+
+} // namespace loggable
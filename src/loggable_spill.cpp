@@ -0,0 +1,99 @@
+#include "loggable_spill.hpp"
+
+#include <array>
+#include <utility>
+
+namespace loggable {
+
+FileSpillStore::FileSpillStore(std::string path, size_t max_bytes) noexcept
+    : _path(std::move(path)), _max_bytes(max_bytes) {
+    _file = std::fopen(_path.c_str(), "w+b");
+}
+
+FileSpillStore::~FileSpillStore() {
+    if (_file) {
+        std::fclose(_file);
+        std::remove(_path.c_str());
+    }
+}
+
+bool FileSpillStore::append(const uint8_t *data, size_t size) noexcept {
+    const size_t needed = LENGTH_SIZE + size;
+    if (!_file || size > UINT32_MAX) {
+        return false;
+    }
+
+    // Records are never split: wrap to the start once the end is too short
+    if (!_wrapped && _head + needed > _max_bytes) {
+        if (needed > _tail) {
+            return false;
+        }
+        _wrap_at = _head;
+        _head = 0;
+        _wrapped = true;
+    }
+    if (_wrapped && _head + needed > _tail) {
+        return false;
+    }
+
+    const std::array<uint8_t, LENGTH_SIZE> length{
+        static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8),
+        static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 24)};
+    if (std::fseek(_file, static_cast<long>(_head), SEEK_SET) != 0 ||
+        std::fwrite(length.data(), 1, length.size(), _file) != length.size() ||
+        std::fwrite(data, 1, size, _file) != size) {
+        return false;
+    }
+    _head += needed;
+    _used += needed;
+    ++_records;
+    return true;
+}
+
+bool FileSpillStore::read(std::vector<uint8_t> &record) noexcept {
+    if (!_file || _records == 0) {
+        return false;
+    }
+    if (_wrapped && _tail == _wrap_at) {
+        _tail = 0;
+        _wrapped = false;
+    }
+
+    std::array<uint8_t, LENGTH_SIZE> length{};
+    if (std::fseek(_file, static_cast<long>(_tail), SEEK_SET) != 0 ||
+        std::fread(length.data(), 1, length.size(), _file) != length.size()) {
+        return false; // Nothing consumed; the caller may try again
+    }
+    const size_t size = static_cast<size_t>(length[0]) | (static_cast<size_t>(length[1]) << 8) |
+                        (static_cast<size_t>(length[2]) << 16) | (static_cast<size_t>(length[3]) << 24);
+    // A length running past the written data is corrupt, and so is
+    // everything after it: there is no telling where the next record starts
+    const size_t end = _wrapped ? _wrap_at : _head;
+    if (LENGTH_SIZE + size > end - _tail) {
+        _clear();
+        return false;
+    }
+
+    record.resize(size);
+    const bool complete = std::fread(record.data(), 1, size, _file) == size;
+    _pop(LENGTH_SIZE + size);
+    return complete; // A record that cannot be read is skipped
+}
+
+void FileSpillStore::_pop(size_t bytes) noexcept {
+    _tail += bytes;
+    _used -= bytes;
+    if (--_records == 0) {
+        _clear(); // Empty: start over at the beginning of the file
+    }
+}
+
+void FileSpillStore::_clear() noexcept {
+    _head = 0;
+    _tail = 0;
+    _wrapped = false;
+    _records = 0;
+    _used = 0;
+}
+
+} // namespace loggable
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+namespace loggable::test {
+
+/**
+ * @brief Number of heap allocations made by the calling thread so far.
+ *
+ * Counted by the replacement global operator new in alloc_counter.cpp.
+ */
+[[nodiscard]] size_t thread_allocation_count() noexcept;
+
+/**
+ * @brief Number of heap allocations made by all threads so far.
+ */
+[[nodiscard]] size_t total_allocation_count() noexcept;
+
+/**
+ * @brief Counts the allocations made by the current thread while in scope.
+ */
+class AllocationScope {
+public:
+    AllocationScope() noexcept : _start(thread_allocation_count()) {}
+
+    [[nodiscard]] size_t count() const noexcept {
+        return thread_allocation_count() - _start;
+    }
+
+private:
+    size_t _start;
+};
+
+} // namespace loggable::test
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <memory>
+
+#include "loggable.hpp"
+#include "sim_backend.hpp"
+
+using namespace loggable;
+
+// Prints the simulated cost of a few canonical workloads. Unlike wall-clock
+// benchmarks the numbers are exact, so two builds can be diffed directly.
+
+namespace {
+
+test::SimBackend g_sim;
+
+class CostSink : public ISink {
+public:
+    void consume(const LogMessage& /*msg*/) override {
+        g_sim.spend(cost_ms);
+    }
+    uint32_t cost_ms{0};
+};
+
+void report(const char* scenario, size_t messages) {
+    const auto c = g_sim.counters();
+    printf("%-22s %8zu %8zu %8zu %8zu %8zu %8zu %8zu %8zu\n", scenario, messages,
+           c.semaphore_gives, c.task_notifies + c.event_sets,
+           c.semaphore_takes + c.notify_waits + c.event_waits, c.blocking_waits,
+           c.task_wakeups, c.context_switches, c.delays);
+}
+
+} // namespace
+
+int main() {
+    os::set_backend(&g_sim);
+    auto sink = std::make_shared<CostSink>();
+    auto& sinker = Sinker::instance();
+    sinker.add_sinker(sink);
+    sinker.init();
+    Logger logger("bench");
+
+    printf("%-22s %8s %8s %8s %8s %8s %8s %8s %8s\n", "scenario", "msgs", "gives",
+           "notifies", "waits", "blocking", "wakeups", "switches", "delays");
+
+    // Producer outruns a free sink: one burst, then a flush
+    g_sim.run_until_idle();
+    g_sim.reset_counters();
+    for (int i = 0; i < 100; ++i) {
+        logger.log(LogLevel::Info, "burst");
+    }
+    (void)sinker.flush();
+    report("burst x100", 100);
+
+    // Producer paced against the worker: every message wakes it
+    g_sim.reset_counters();
+    for (int i = 0; i < 100; ++i) {
+        logger.log(LogLevel::Info, "paced");
+        g_sim.run_until_idle();
+    }
+    report("paced x100", 100);
+
+    // Slow sink: 2 ms per message, bursts of ten every 50 ms
+    sink->cost_ms = 2;
+    g_sim.reset_counters();
+    for (int burst = 0; burst < 10; ++burst) {
+        for (int i = 0; i < 10; ++i) {
+            logger.log(LogLevel::Info, "slow");
+        }
+        g_sim.advance(50);
+    }
+    report("slow sink 10x10", 100);
+    sink->cost_ms = 0;
+
+    // Idle for ten virtual seconds
+    g_sim.run_until_idle();
+    g_sim.reset_counters();
+    g_sim.advance(10000);
+    report("idle 10 s", 0);
+
+    g_sim.reset_counters();
+    sinker.shutdown();
+    report("shutdown", 0);
+
+    sinker.remove_sinker(sink);
+    return 0;
+}
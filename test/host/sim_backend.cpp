@@ -0,0 +1,441 @@
+#include "sim_backend.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace loggable::test {
+
+namespace {
+thread_local const void* t_sim = nullptr;
+thread_local void* t_task = nullptr;
+
+[[noreturn]] void sim_fatal(const char* what) noexcept {
+    std::fprintf(stderr, "SimBackend: %s\n", what);
+    std::abort();
+}
+} // namespace
+
+SimBackend::SimBackend() {
+    auto driver = std::make_unique<Task>();
+    driver->state = State::Running;
+    _current = driver.get();
+    t_sim = this;
+    t_task = driver.get();
+    _tasks.push_back(std::move(driver));
+}
+
+SimBackend::~SimBackend() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 1; i < _tasks.size(); ++i) {
+            if (_tasks[i]->state != State::Done) {
+                sim_fatal("destroyed while tasks are still alive (missing shutdown?)");
+            }
+        }
+    }
+    for (auto& task : _tasks) {
+        if (task->thread.joinable()) {
+            task->thread.join();
+        }
+    }
+    if (t_sim == this) {
+        t_sim = nullptr;
+        t_task = nullptr;
+    }
+}
+
+void SimBackend::set_capabilities(os::Capabilities caps) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _caps = caps;
+}
+
+os::Capabilities SimBackend::capabilities() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _caps;
+}
+
+// --- Semaphores ---
+
+os::SemaphoreHandle SimBackend::semaphore_create_binary() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_counters.semaphores_created;
+    return os::SemaphoreHandle{new Semaphore{}};
+}
+
+os::SemaphoreHandle SimBackend::semaphore_create_counting(uint32_t max_count,
+                                                          uint32_t initial_count) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_counters.semaphores_created;
+    return os::SemaphoreHandle{new Semaphore{.count = initial_count, .max_count = max_count, .waiters = {}}};
+}
+
+void SimBackend::semaphore_destroy(os::SemaphoreHandle sem) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* s = static_cast<Semaphore*>(sem._handle);
+    if (!s->waiters.empty()) {
+        sim_fatal("semaphore destroyed with waiters");
+    }
+    ++_counters.semaphores_destroyed;
+    delete s;
+}
+
+void SimBackend::semaphore_give(os::SemaphoreHandle sem) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* s = static_cast<Semaphore*>(sem._handle);
+    ++_counters.semaphore_gives;
+
+    if (!s->waiters.empty()) {
+        // Hand the unit straight to the longest waiter; the giver keeps the CPU
+        Task* waiter = s->waiters.front();
+        s->waiters.pop_front();
+        waiter->waiting_on = nullptr;
+        waiter->deadline = NO_DEADLINE;
+        _make_ready(waiter);
+    } else if (s->count < s->max_count) {
+        ++s->count;
+    }
+}
+
+bool SimBackend::semaphore_take(os::SemaphoreHandle sem, uint32_t timeout_ms) noexcept {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto* s = static_cast<Semaphore*>(sem._handle);
+    ++_counters.semaphore_takes;
+
+    if (s->count > 0) {
+        --s->count;
+        return true;
+    }
+
+    Task* self = _self();
+    self->waiting_on = s;
+    s->waiters.push_back(self);
+    return _block_until(lock, self, timeout_ms);
+}
+
+// --- Task notifications ---
+
+os::TaskHandle SimBackend::task_current() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return os::TaskHandle{_self()};
+}
+
+void SimBackend::task_notify(os::TaskHandle task, uint32_t bits) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* t = static_cast<Task*>(task._handle);
+    ++_counters.task_notifies;
+    t->notify_bits |= bits;
+    t->notify_pending = true;
+    if (t->waiting_notify) {
+        t->waiting_notify = false;
+        t->deadline = NO_DEADLINE;
+        _make_ready(t);
+    }
+}
+
+bool SimBackend::task_notify_wait(uint32_t timeout_ms, uint32_t* bits) noexcept {
+    std::unique_lock<std::mutex> lock(_mutex);
+    Task* self = _self();
+    ++_counters.notify_waits;
+
+    if (!self->notify_pending) {
+        self->waiting_notify = true;
+        if (!_block_until(lock, self, timeout_ms)) {
+            return false;
+        }
+    }
+    if (bits) {
+        *bits = self->notify_bits;
+    }
+    self->notify_bits = 0;
+    self->notify_pending = false;
+    return true;
+}
+
+// --- Event groups ---
+
+os::EventHandle SimBackend::event_create() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return os::EventHandle{new Event{}};
+}
+
+void SimBackend::event_destroy(os::EventHandle event) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* e = static_cast<Event*>(event._handle);
+    if (!e->waiters.empty()) {
+        sim_fatal("event group destroyed with waiters");
+    }
+    delete e;
+}
+
+void SimBackend::event_set(os::EventHandle event, uint32_t bits) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* e = static_cast<Event*>(event._handle);
+    ++_counters.event_sets;
+    e->bits |= bits;
+    for (auto it = e->waiters.begin(); it != e->waiters.end();) {
+        Task* waiter = *it;
+        if ((waiter->event_mask & e->bits) == 0) {
+            ++it;
+            continue;
+        }
+        it = e->waiters.erase(it);
+        waiter->waiting_event = nullptr;
+        waiter->deadline = NO_DEADLINE;
+        _make_ready(waiter);
+    }
+}
+
+void SimBackend::event_clear(os::EventHandle event, uint32_t bits) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    static_cast<Event*>(event._handle)->bits &= ~bits;
+}
+
+uint32_t SimBackend::event_wait(os::EventHandle event, uint32_t bits,
+                                bool clear_on_exit, uint32_t timeout_ms) noexcept {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto* e = static_cast<Event*>(event._handle);
+    ++_counters.event_waits;
+
+    if ((e->bits & bits) == 0) {
+        Task* self = _self();
+        self->waiting_event = e;
+        self->event_mask = bits;
+        e->waiters.push_back(self);
+        if (!_block_until(lock, self, timeout_ms)) {
+            return 0;
+        }
+    }
+    const uint32_t matched = e->bits & bits;
+    if (clear_on_exit) {
+        e->bits &= ~bits;
+    }
+    return matched;
+}
+
+// --- Tasks ---
+
+os::TaskHandle SimBackend::task_create(const os::TaskConfig& /*config*/,
+                                       os::TaskFunction fn,
+                                       void* arg) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto task = std::make_unique<Task>();
+    task->id = _tasks.size();
+    task->fn = fn;
+    task->arg = arg;
+    Task* raw = task.get();
+    _tasks.push_back(std::move(task));
+    _ready.push_back(raw);
+    ++_counters.tasks_created;
+    raw->thread = std::thread(&SimBackend::_thread_main, this, raw);
+    return os::TaskHandle{raw};
+}
+
+void SimBackend::task_delete(os::TaskHandle task) noexcept {
+    std::unique_lock<std::mutex> lock(_mutex);
+    Task* self = _self();
+    if (task && task._handle != self) {
+        sim_fatal("deleting another task is not supported");
+    }
+    // Hand the CPU on without waiting; the thread unwinds and is joined later
+    self->state = State::Done;
+    _switch_away(lock, self);
+}
+
+void SimBackend::_thread_main(SimBackend* sim, Task* task) noexcept {
+    t_sim = sim;
+    t_task = task;
+    {
+        std::unique_lock<std::mutex> lock(sim->_mutex);
+        sim->_wait_for_cpu(lock, task);
+    }
+
+    task->fn(task->arg);
+
+    std::unique_lock<std::mutex> lock(sim->_mutex);
+    if (task->state != State::Done) {
+        task->state = State::Done;
+        sim->_switch_away(lock, task);
+    }
+}
+
+// --- Timing ---
+
+void SimBackend::delay_ms(uint32_t ms) noexcept {
+    if (ms == 0) {
+        yield();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    Task* self = _self();
+    ++_counters.delays;
+    self->deadline = _now_ms + ms;
+    self->state = State::Blocked;
+    _block(lock, self);
+}
+
+uint32_t SimBackend::get_time_ms() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return static_cast<uint32_t>(_now_ms);
+}
+
+void SimBackend::spend(uint32_t ms) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _now_ms += ms;
+}
+
+uint64_t SimBackend::now() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _now_ms;
+}
+
+// --- Scheduling control ---
+
+void SimBackend::yield() noexcept {
+    std::unique_lock<std::mutex> lock(_mutex);
+    Task* self = _self();
+    _make_ready(self);
+    _block(lock, self);
+}
+
+void SimBackend::run_until_idle() noexcept {
+    std::unique_lock<std::mutex> lock(_mutex);
+    Task* self = _self();
+    if (self->id != 0) {
+        sim_fatal("run_until_idle() is reserved for the driver");
+    }
+    self->state = State::Idle;
+    _block(lock, self);
+}
+
+SimBackend::Counters SimBackend::counters() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _counters;
+}
+
+void SimBackend::reset_counters() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters = Counters{};
+}
+
+// --- Scheduler core (all called with _mutex held) ---
+
+SimBackend::Task* SimBackend::_self() const noexcept {
+    if (t_sim != this || t_task == nullptr) {
+        sim_fatal("blocking call from a thread that is not a simulated task");
+    }
+    return static_cast<Task*>(t_task);
+}
+
+void SimBackend::_make_ready(Task* task) noexcept {
+    task->state = State::Ready;
+    _ready.push_back(task);
+}
+
+bool SimBackend::_block_until(std::unique_lock<std::mutex>& lock, Task* self,
+                              uint32_t timeout_ms) noexcept {
+    // The caller has registered the wait; undo it for a non-blocking poll
+    if (timeout_ms == 0) {
+        if (self->waiting_on) {
+            self->waiting_on->waiters.pop_back();
+            self->waiting_on = nullptr;
+        }
+        if (self->waiting_event) {
+            self->waiting_event->waiters.pop_back();
+            self->waiting_event = nullptr;
+        }
+        self->waiting_notify = false;
+        ++_counters.wait_timeouts;
+        return false;
+    }
+
+    ++_counters.blocking_waits;
+    self->deadline = timeout_ms == os::WAIT_FOREVER ? NO_DEADLINE : _now_ms + timeout_ms;
+    self->timed_out = false;
+    self->state = State::Blocked;
+    _block(lock, self);
+
+    if (self->timed_out) {
+        ++_counters.wait_timeouts;
+        return false;
+    }
+    return true;
+}
+
+void SimBackend::_block(std::unique_lock<std::mutex>& lock, Task* self) noexcept {
+    const bool sleeping = self->state == State::Blocked;
+    _switch_away(lock, self);
+    _wait_for_cpu(lock, self);
+    if (sleeping && self->id != 0) {
+        ++_counters.task_wakeups;
+    }
+}
+
+void SimBackend::_switch_away(std::unique_lock<std::mutex>& /*lock*/, Task* self) noexcept {
+    Task* next = _pick_next();
+    if (next == self) {
+        self->state = State::Running;
+        return;
+    }
+    ++_counters.context_switches;
+    _current = next;
+    _cv.notify_all();
+}
+
+void SimBackend::_wait_for_cpu(std::unique_lock<std::mutex>& lock, Task* self) noexcept {
+    _cv.wait(lock, [this, self] { return _current == self; });
+    self->state = State::Running;
+}
+
+SimBackend::Task* SimBackend::_pick_next() noexcept {
+    for (;;) {
+        if (!_ready.empty()) {
+            Task* next = _ready.front();
+            _ready.pop_front();
+            return next;
+        }
+
+        Task* driver = _tasks.front().get();
+        if (driver->state == State::Idle) {
+            return driver;
+        }
+
+        // Everyone is blocked: jump the clock to the earliest deadline
+        uint64_t earliest = NO_DEADLINE;
+        for (const auto& task : _tasks) {
+            if (task->state == State::Blocked) {
+                earliest = std::min(earliest, task->deadline);
+            }
+        }
+        if (earliest == NO_DEADLINE) {
+            sim_fatal("deadlock: every task is blocked without a timeout");
+        }
+        _now_ms = std::max(_now_ms, earliest);
+
+        for (const auto& task : _tasks) {
+            if (task->state != State::Blocked || task->deadline > _now_ms) {
+                continue;
+            }
+            if (task->waiting_on) {
+                auto& waiters = task->waiting_on->waiters;
+                waiters.erase(std::find(waiters.begin(), waiters.end(), task.get()));
+                task->waiting_on = nullptr;
+                task->timed_out = true;
+            }
+            if (task->waiting_event) {
+                auto& waiters = task->waiting_event->waiters;
+                waiters.erase(std::find(waiters.begin(), waiters.end(), task.get()));
+                task->waiting_event = nullptr;
+                task->timed_out = true;
+            }
+            if (task->waiting_notify) {
+                task->waiting_notify = false;
+                task->timed_out = true;
+            }
+            task->deadline = NO_DEADLINE;
+            _make_ready(task.get());
+        }
+    }
+}
+
+} // namespace loggable::test
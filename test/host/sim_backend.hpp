@@ -0,0 +1,176 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "loggable_os.hpp"
+
+namespace loggable::test {
+
+/**
+ * @brief Deterministic IAsyncBackend with a virtual clock.
+ *
+ * Every task runs on its own thread, but only one holds the CPU at a time
+ * and control changes hands only inside backend calls, like a
+ * non-preemptive uniprocessor scheduler. Ready tasks run in FIFO order.
+ * The virtual clock only moves when every task is blocked, jumping to the
+ * earliest pending timeout, or when a task explicitly spend()s time.
+ * The same sequence of calls therefore always yields the same interleaving
+ * and the same counters, which makes semaphore traffic and wakeups exact,
+ * assertable quantities.
+ *
+ * The thread that constructs the backend becomes the driver task: it owns
+ * the CPU initially and steers the simulation with yield(),
+ * run_until_idle() and advance(). Tasks must not block on simulated
+ * primitives while holding a std::mutex another task may need.
+ */
+class SimBackend final : public os::IAsyncBackend {
+public:
+    /// Instrumentation counters; all are exact for a given call sequence.
+    struct Counters {
+        size_t semaphores_created{0};
+        size_t semaphores_destroyed{0};
+        size_t semaphore_gives{0};
+        size_t semaphore_takes{0};     ///< All take calls, including polls
+        size_t task_notifies{0};
+        size_t notify_waits{0};        ///< All task_notify_wait() calls
+        size_t event_sets{0};
+        size_t event_waits{0};         ///< All event_wait() calls
+        size_t blocking_waits{0};      ///< Takes and waits that had to block
+        size_t wait_timeouts{0};       ///< Takes and waits that timed out
+        size_t delays{0};              ///< delay_ms() calls
+        size_t tasks_created{0};
+        size_t task_wakeups{0};        ///< Non-driver tasks resumed after blocking
+        size_t context_switches{0};
+    };
+
+    SimBackend();
+    ~SimBackend() override;
+
+    SimBackend(const SimBackend&) = delete;
+    SimBackend& operator=(const SimBackend&) = delete;
+
+    /**
+     * @brief Restrict the optional primitives reported to the core.
+     *
+     * Everything is available by default. Takes effect for queues and
+     * flush events created afterwards.
+     */
+    void set_capabilities(os::Capabilities caps) noexcept;
+
+    // --- IAsyncBackend ---
+    [[nodiscard]] os::Capabilities capabilities() const noexcept override;
+    [[nodiscard]] os::SemaphoreHandle semaphore_create_binary() noexcept override;
+    [[nodiscard]] os::SemaphoreHandle semaphore_create_counting(uint32_t max_count,
+                                                                uint32_t initial_count) noexcept override;
+    void semaphore_destroy(os::SemaphoreHandle sem) noexcept override;
+    void semaphore_give(os::SemaphoreHandle sem) noexcept override;
+    [[nodiscard]] bool semaphore_take(os::SemaphoreHandle sem, uint32_t timeout_ms) noexcept override;
+    [[nodiscard]] os::TaskHandle task_create(const os::TaskConfig& config,
+                                             os::TaskFunction fn,
+                                             void* arg) noexcept override;
+    void task_delete(os::TaskHandle task) noexcept override;
+    [[nodiscard]] os::TaskHandle task_current() noexcept override;
+    void task_notify(os::TaskHandle task, uint32_t bits) noexcept override;
+    [[nodiscard]] bool task_notify_wait(uint32_t timeout_ms, uint32_t* bits) noexcept override;
+    [[nodiscard]] os::EventHandle event_create() noexcept override;
+    void event_destroy(os::EventHandle event) noexcept override;
+    void event_set(os::EventHandle event, uint32_t bits) noexcept override;
+    void event_clear(os::EventHandle event, uint32_t bits) noexcept override;
+    [[nodiscard]] uint32_t event_wait(os::EventHandle event, uint32_t bits,
+                                      bool clear_on_exit, uint32_t timeout_ms) noexcept override;
+    void delay_ms(uint32_t ms) noexcept override;
+    uint32_t get_time_ms() noexcept override;
+
+    // --- Scheduling control ---
+
+    /**
+     * @brief Let every currently ready task run once, then resume the caller.
+     */
+    void yield() noexcept;
+
+    /**
+     * @brief Driver only: run other tasks until all of them are blocked.
+     *
+     * Virtual time does not advance.
+     */
+    void run_until_idle() noexcept;
+
+    /**
+     * @brief Sleep the calling task for @p ms of virtual time.
+     *
+     * Other tasks run and their timeouts fire as the clock moves.
+     */
+    void advance(uint32_t ms) noexcept { delay_ms(ms); }
+
+    /**
+     * @brief Consume @p ms of virtual CPU time without giving up the CPU.
+     *
+     * Models work such as a slow sink write.
+     */
+    void spend(uint32_t ms) noexcept;
+
+    [[nodiscard]] uint64_t now() const noexcept;
+    [[nodiscard]] Counters counters() const noexcept;
+    void reset_counters() noexcept;
+
+private:
+    static constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+    enum class State : uint8_t { Ready, Running, Blocked, Idle, Done };
+
+    struct Semaphore;
+    struct Event;
+
+    struct Task {
+        size_t id{0};
+        State state{State::Ready};
+        Semaphore* waiting_on{nullptr};
+        Event* waiting_event{nullptr};
+        uint32_t event_mask{0};
+        bool waiting_notify{false};
+        uint32_t notify_bits{0};
+        bool notify_pending{false};
+        uint64_t deadline{NO_DEADLINE};
+        bool timed_out{false};
+        os::TaskFunction fn{nullptr};
+        void* arg{nullptr};
+        std::thread thread;
+    };
+
+    struct Semaphore {
+        uint32_t count{0};
+        uint32_t max_count{1};
+        std::deque<Task*> waiters;
+    };
+
+    struct Event {
+        uint32_t bits{0};
+        std::deque<Task*> waiters;
+    };
+
+    Task* _self() const noexcept;
+    bool _block_until(std::unique_lock<std::mutex>& lock, Task* self, uint32_t timeout_ms) noexcept;
+    void _block(std::unique_lock<std::mutex>& lock, Task* self) noexcept;
+    void _switch_away(std::unique_lock<std::mutex>& lock, Task* self) noexcept;
+    void _wait_for_cpu(std::unique_lock<std::mutex>& lock, Task* self) noexcept;
+    Task* _pick_next() noexcept;
+    void _make_ready(Task* task) noexcept;
+    static void _thread_main(SimBackend* sim, Task* task) noexcept;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<std::unique_ptr<Task>> _tasks; ///< _tasks[0] is the driver
+    std::deque<Task*> _ready;
+    Task* _current{nullptr};
+    uint64_t _now_ms{0};
+    Counters _counters{};
+    os::Capabilities _caps{.counting_semaphore = true, .task_notify = true, .event_group = true};
+};
+
+} // namespace loggable::test
@@ -0,0 +1,233 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#include "loggable_os.hpp"
+
+namespace loggable::test {
+
+/**
+ * @brief IAsyncBackend implemented on the C++ standard library.
+ *
+ * Lets the async dispatch path run on a host with real threads, so it can
+ * be exercised under ThreadSanitizer. Tasks are joined when the backend
+ * is destroyed. It is final and provides instance(), so it can also be
+ * bound at compile time (LOGGABLE_BACKEND_TYPE). All optional primitives
+ * are implemented; set_capabilities() hides some of them to exercise the
+ * fallback paths.
+ */
+class StdBackend final : public os::IAsyncBackend {
+public:
+    StdBackend() noexcept : _epoch(std::chrono::steady_clock::now()) {}
+
+    ~StdBackend() override {
+        std::lock_guard<std::mutex> lock(_tasks_mutex);
+        for (auto& task : _tasks) {
+            if (task.thread.joinable()) {
+                task.thread.join();
+            }
+        }
+    }
+
+    StdBackend(const StdBackend&) = delete;
+    StdBackend& operator=(const StdBackend&) = delete;
+
+    /**
+     * @brief Shared instance used when bound at compile time.
+     */
+    [[nodiscard]] static StdBackend& instance() noexcept {
+        static StdBackend backend;
+        return backend;
+    }
+
+    void set_capabilities(os::Capabilities caps) noexcept { _caps = caps; }
+
+    [[nodiscard]] os::Capabilities capabilities() const noexcept override {
+        return _caps;
+    }
+
+    // --- Semaphores ---
+
+    [[nodiscard]] os::SemaphoreHandle semaphore_create_binary() noexcept override {
+        return os::SemaphoreHandle{new Semaphore{}};
+    }
+
+    [[nodiscard]] os::SemaphoreHandle semaphore_create_counting(uint32_t max_count,
+                                                                uint32_t initial_count) noexcept override {
+        auto* s = new Semaphore{};
+        s->max_count = max_count;
+        s->count = initial_count;
+        return os::SemaphoreHandle{s};
+    }
+
+    void semaphore_destroy(os::SemaphoreHandle sem) noexcept override {
+        delete static_cast<Semaphore*>(sem._handle);
+    }
+
+    void semaphore_give(os::SemaphoreHandle sem) noexcept override {
+        auto* s = static_cast<Semaphore*>(sem._handle);
+        // Notify under the lock: the waiter may destroy the semaphore as
+        // soon as it observes the give.
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (s->count < s->max_count) {
+            ++s->count;
+        }
+        s->cv.notify_one();
+    }
+
+    [[nodiscard]] bool semaphore_take(os::SemaphoreHandle sem, uint32_t timeout_ms) noexcept override {
+        auto* s = static_cast<Semaphore*>(sem._handle);
+        std::unique_lock<std::mutex> lock(s->mutex);
+        auto ready = [s] { return s->count > 0; };
+        if (!wait(s->cv, lock, timeout_ms, ready)) {
+            return false;
+        }
+        --s->count;
+        return true;
+    }
+
+    // --- Tasks ---
+
+    [[nodiscard]] os::TaskHandle task_create(const os::TaskConfig& /*config*/,
+                                             os::TaskFunction fn,
+                                             void* arg) noexcept override {
+        std::lock_guard<std::mutex> lock(_tasks_mutex);
+        Task& task = _tasks.emplace_back();
+        task.thread = std::thread([&task, fn, arg] {
+            t_current = &task;
+            fn(arg);
+        });
+        return os::TaskHandle{&task};
+    }
+
+    void task_delete(os::TaskHandle /*task*/) noexcept override {
+        // Threads finish by returning from their entry function and are
+        // joined in the destructor.
+    }
+
+    [[nodiscard]] os::TaskHandle task_current() noexcept override {
+        return os::TaskHandle{t_current};
+    }
+
+    void task_notify(os::TaskHandle task, uint32_t bits) noexcept override {
+        auto* t = static_cast<Task*>(task._handle);
+        std::lock_guard<std::mutex> lock(t->mutex);
+        t->notify_bits |= bits;
+        t->notify_pending = true;
+        t->cv.notify_one();
+    }
+
+    [[nodiscard]] bool task_notify_wait(uint32_t timeout_ms, uint32_t* bits) noexcept override {
+        Task* t = t_current;
+        if (!t) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(t->mutex);
+        if (!wait(t->cv, lock, timeout_ms, [t] { return t->notify_pending; })) {
+            return false;
+        }
+        if (bits) {
+            *bits = t->notify_bits;
+        }
+        t->notify_bits = 0;
+        t->notify_pending = false;
+        return true;
+    }
+
+    // --- Event groups ---
+
+    [[nodiscard]] os::EventHandle event_create() noexcept override {
+        return os::EventHandle{new Event{}};
+    }
+
+    void event_destroy(os::EventHandle event) noexcept override {
+        delete static_cast<Event*>(event._handle);
+    }
+
+    void event_set(os::EventHandle event, uint32_t bits) noexcept override {
+        auto* e = static_cast<Event*>(event._handle);
+        std::lock_guard<std::mutex> lock(e->mutex);
+        e->bits |= bits;
+        e->cv.notify_all();
+    }
+
+    void event_clear(os::EventHandle event, uint32_t bits) noexcept override {
+        auto* e = static_cast<Event*>(event._handle);
+        std::lock_guard<std::mutex> lock(e->mutex);
+        e->bits &= ~bits;
+    }
+
+    [[nodiscard]] uint32_t event_wait(os::EventHandle event, uint32_t bits,
+                                      bool clear_on_exit, uint32_t timeout_ms) noexcept override {
+        auto* e = static_cast<Event*>(event._handle);
+        std::unique_lock<std::mutex> lock(e->mutex);
+        if (!wait(e->cv, lock, timeout_ms, [e, bits] { return (e->bits & bits) != 0; })) {
+            return 0;
+        }
+        const uint32_t matched = e->bits & bits;
+        if (clear_on_exit) {
+            e->bits &= ~bits;
+        }
+        return matched;
+    }
+
+    // --- Timing ---
+
+    void delay_ms(uint32_t ms) noexcept override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+
+    uint32_t get_time_ms() noexcept override {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - _epoch).count());
+    }
+
+    uint64_t get_time_us() noexcept override {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _epoch).count());
+    }
+
+private:
+    struct Semaphore {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t count{0};
+        uint32_t max_count{1};
+    };
+
+    struct Task {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t notify_bits{0};
+        bool notify_pending{false};
+    };
+
+    struct Event {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t bits{0};
+    };
+
+    template <typename Pred>
+    static bool wait(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                     uint32_t timeout_ms, Pred ready) {
+        if (timeout_ms == os::WAIT_FOREVER) {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    }
+
+    static inline thread_local Task* t_current = nullptr;
+
+    std::chrono::steady_clock::time_point _epoch;
+    os::Capabilities _caps{.counting_semaphore = true, .task_notify = true, .event_group = true};
+    std::mutex _tasks_mutex;
+    std::list<Task> _tasks;
+};
+
+} // namespace loggable::test
@@ -0,0 +1,778 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "loggable.hpp"
+#include "loggable_ringbuffer.hpp"
+#include "std_backend.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+namespace {
+
+constexpr int PRODUCERS = 8;
+constexpr int MESSAGES_PER_PRODUCER = 2000;
+
+/**
+ * @brief Counts messages and checks that each producer's sequence arrives in order.
+ *
+ * Producers log with tag "p<index>" and the message text set to a running
+ * counter. consume() is serialized by the Sinker, so no locking is needed.
+ */
+class OrderCheckingSink : public ISink {
+public:
+    void consume(const LogMessage& msg) override {
+        ++received;
+        const auto& tag = msg.get_tag();
+        if (tag.size() < 2 || tag.c_str()[0] != 'p') {
+            return;
+        }
+        const auto producer = static_cast<size_t>(std::atoi(tag.c_str() + 1));
+        const long value = std::atol(msg.get_message().c_str());
+        if (producer >= last_seen.size()) {
+            ++unknown;
+            return;
+        }
+        if (value <= last_seen[producer]) {
+            ++out_of_order;
+        }
+        last_seen[producer] = value;
+    }
+
+    bool requires_ordering() const noexcept override { return ordered; }
+
+    void reset() {
+        received = 0;
+        out_of_order = 0;
+        unknown = 0;
+        last_seen.assign(PRODUCERS, -1);
+    }
+
+    bool ordered{false};
+    size_t received{0};
+    size_t out_of_order{0};
+    size_t unknown{0};
+    std::vector<long> last_seen = std::vector<long>(PRODUCERS, -1);
+};
+
+/**
+ * @brief FileSpillStore whose every 50th read fails without removing
+ * anything, like a transient flash error.
+ */
+class FlakySpillStore : public ISpillStore {
+public:
+    explicit FlakySpillStore(const char* path) : _store(path, 1024 * 1024) {}
+
+    bool append(const uint8_t* data, size_t size) noexcept override {
+        return _store.append(data, size);
+    }
+    bool read(std::vector<uint8_t>& record) noexcept override {
+        if (++_reads % 50 == 0) {
+            ++failed_reads;
+            return false;
+        }
+        return _store.read(record);
+    }
+    size_t size_bytes() const noexcept override { return _store.size_bytes(); }
+
+    size_t failed_reads{0};
+
+private:
+    FileSpillStore _store;
+    size_t _reads{0};
+};
+
+/**
+ * @brief Sink that blocks the dispatch worker until opened.
+ */
+class GateSink : public ISink {
+public:
+    void consume(const LogMessage& msg) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _entered = true;
+        _cv.notify_all();
+        _cv.wait(lock, [this] { return _open; });
+        messages.emplace_back(msg.get_message_view());
+    }
+
+    void wait_entered() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this] { return _entered; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _open = true;
+        _cv.notify_all();
+    }
+
+    std::vector<std::string> messages;
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _entered{false};
+    bool _open{false};
+};
+
+test::StdBackend g_backend;
+std::shared_ptr<OrderCheckingSink> g_sink;
+
+void produce(int index, int count, int warning_every) {
+    const std::string tag = "p" + std::to_string(index);
+    Logger logger(tag);
+    for (int i = 0; i < count; ++i) {
+        const bool warning = warning_every > 0 && i % warning_every == 0;
+        logger.logf(warning ? LogLevel::Warning : LogLevel::Info, "{}", i);
+    }
+}
+
+void run_producers(int producers, int count, int warning_every = 0) {
+    std::vector<std::thread> threads;
+    threads.reserve(producers);
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back(produce, p, count, warning_every);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief A RingBuffer drained by one backend task while threads push.
+ */
+struct SignalingFixture {
+    RingBuffer<long, 64> buffer{&g_backend};
+    std::atomic<bool> producers_done{false};
+    std::atomic<bool> consumer_done{false};
+    bool notify_bound{false};
+    size_t received{0};
+    size_t out_of_order{0};
+    std::vector<long> last_seen = std::vector<long>(PRODUCERS, -1);
+};
+
+void signaling_consumer(void* arg) {
+    auto* fixture = static_cast<SignalingFixture*>(arg);
+    fixture->notify_bound = fixture->buffer.bind_consumer(g_backend.task_current());
+    while (!fixture->producers_done.load() || !fixture->buffer.empty()) {
+        auto item = fixture->buffer.pop(10);
+        if (!item) {
+            continue;
+        }
+        const auto producer = static_cast<size_t>(*item / MESSAGES_PER_PRODUCER);
+        if (*item <= fixture->last_seen[producer]) {
+            ++fixture->out_of_order;
+        }
+        fixture->last_seen[producer] = *item;
+        ++fixture->received;
+    }
+    (void)fixture->buffer.bind_consumer(os::TaskHandle{});
+    fixture->consumer_done.store(true);
+}
+
+} // namespace
+
+void test_ringbuffer_signaling_modes() {
+    using Signaling = RingBuffer<long, 64>::Signaling;
+    const struct {
+        os::Capabilities caps;
+        Signaling expected;
+    } modes[] = {
+        {os::Capabilities{}, Signaling::Binary},
+        {os::Capabilities{.counting_semaphore = true}, Signaling::Counting},
+        {os::Capabilities{.counting_semaphore = true, .task_notify = true}, Signaling::Notify},
+    };
+
+    for (const auto& mode : modes) {
+        g_backend.set_capabilities(mode.caps);
+        auto fixture = std::make_unique<SignalingFixture>();
+        TEST_ASSERT_TRUE(static_cast<bool>(g_backend.task_create(os::TaskConfig{}, &signaling_consumer, fixture.get())));
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            threads.emplace_back([&fixture, p] {
+                for (long i = 0; i < MESSAGES_PER_PRODUCER; ++i) {
+                    fixture->buffer.push(p * MESSAGES_PER_PRODUCER + i);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        fixture->producers_done.store(true);
+        while (!fixture->consumer_done.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        TEST_ASSERT_EQUAL(mode.expected == Signaling::Notify, fixture->notify_bound);
+        TEST_ASSERT_EQUAL(static_cast<size_t>(PRODUCERS * MESSAGES_PER_PRODUCER),
+                          fixture->received + fixture->buffer.dropped_count());
+        TEST_ASSERT_EQUAL(0u, fixture->out_of_order);
+    }
+    g_backend.set_capabilities(os::Capabilities{
+        .counting_semaphore = true, .task_notify = true, .event_group = true});
+}
+
+void test_async_many_producers() {
+    g_sink->reset();
+    auto& sinker = Sinker::instance();
+    sinker.init();
+    TEST_ASSERT_TRUE(sinker.is_running());
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+
+    run_producers(PRODUCERS, MESSAGES_PER_PRODUCER);
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+
+    const size_t dropped = sinker.get_metrics().dropped_count - dropped_before;
+    TEST_ASSERT_EQUAL(static_cast<size_t>(PRODUCERS * MESSAGES_PER_PRODUCER), g_sink->received + dropped);
+    TEST_ASSERT_EQUAL(0u, g_sink->out_of_order);
+    TEST_ASSERT_EQUAL(0u, g_sink->unknown);
+
+    sinker.shutdown();
+    TEST_ASSERT_FALSE(sinker.is_running());
+}
+
+void test_async_worker_pool() {
+    auto& sinker = Sinker::instance();
+    std::vector<std::shared_ptr<OrderCheckingSink>> sinks{g_sink};
+    for (int i = 0; i < 3; ++i) {
+        sinks.push_back(std::make_shared<OrderCheckingSink>());
+        sinker.add_sinker(sinks.back());
+    }
+    for (auto& sink : sinks) {
+        sink->reset();
+    }
+
+    SinkerConfig config;
+    config.worker_count = 3;
+    sinker.init(config);
+    TEST_ASSERT_EQUAL(3u, sinker.get_metrics().worker_count);
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+
+    run_producers(PRODUCERS, MESSAGES_PER_PRODUCER);
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    TEST_ASSERT_EQUAL(0u, sinker.get_metrics().queued_count);
+
+    // A sink misses at most the queue's drops plus those of its own lane
+    const size_t dropped = sinker.get_metrics().dropped_count - dropped_before;
+    for (auto& sink : sinks) {
+        TEST_ASSERT_TRUE(sink->received + dropped >= static_cast<size_t>(PRODUCERS * MESSAGES_PER_PRODUCER));
+        TEST_ASSERT_EQUAL(0u, sink->out_of_order);
+        TEST_ASSERT_EQUAL(0u, sink->unknown);
+    }
+
+    sinker.shutdown();
+    TEST_ASSERT_EQUAL(0u, sinker.get_metrics().worker_count);
+    for (size_t i = 1; i < sinks.size(); ++i) {
+        sinker.remove_sinker(sinks[i]);
+    }
+}
+
+void test_fan_out_shares_payload() {
+    /// Keeps where the text of each message lives.
+    class AddressSink : public ISink {
+    public:
+        explicit AddressSink(bool ordered) : _ordered(ordered) {}
+        void consume(const LogMessage& msg) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            texts[std::string(msg.get_message_view())] = msg.get_message().data();
+        }
+        bool requires_ordering() const noexcept override { return _ordered; }
+        std::mutex mutex;
+        std::map<std::string, const char*> texts;
+
+    private:
+        bool _ordered;
+    };
+
+    // Consecutive slots spread the sinks over the workers
+    auto& sinker = Sinker::instance();
+    std::vector<std::shared_ptr<AddressSink>> sinks;
+    for (const bool ordered : {false, true, false}) {
+        sinks.push_back(std::make_shared<AddressSink>(ordered));
+        sinker.add_sinker(sinks.back());
+    }
+    SinkerConfig config;
+    config.worker_count = 4;
+    sinker.init(config);
+
+    // Priority messages are held back for the ordering sink in the meantime
+    Logger logger("share");
+    for (int i = 0; i < 16; ++i) {
+        logger.logf(i % 2 ? LogLevel::Warning : LogLevel::Info, "{:064}", i);
+    }
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    sinker.shutdown();
+    for (auto& sink : sinks) {
+        sinker.remove_sinker(sink);
+    }
+
+    // Every stage passed the same payload on
+    TEST_ASSERT_EQUAL(16u, sinks[0]->texts.size());
+    for (size_t i = 1; i < sinks.size(); ++i) {
+        TEST_ASSERT_TRUE(sinks[i]->texts == sinks[0]->texts);
+    }
+}
+
+void test_async_priority_ordering() {
+    // Every tenth line is a Warning and takes the priority queue; the
+    // ordering sink must still see each producer's lines in sequence
+    auto& sinker = Sinker::instance();
+    auto ordered = std::make_shared<OrderCheckingSink>();
+    ordered->ordered = true;
+    sinker.add_sinker(ordered);
+    g_sink->reset();
+
+    SinkerConfig config;
+    config.worker_count = 2;
+    sinker.init(config);
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+
+    run_producers(PRODUCERS, MESSAGES_PER_PRODUCER, 10);
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+
+    const auto metrics = sinker.get_metrics();
+    const size_t dropped = metrics.dropped_count - dropped_before;
+    TEST_ASSERT_EQUAL(0u, metrics.priority_queued_count);
+    TEST_ASSERT_TRUE(ordered->received + dropped >= static_cast<size_t>(PRODUCERS * MESSAGES_PER_PRODUCER));
+    TEST_ASSERT_EQUAL(0u, ordered->out_of_order);
+    TEST_ASSERT_EQUAL(0u, ordered->unknown);
+
+    sinker.shutdown();
+    sinker.remove_sinker(ordered);
+}
+
+void test_async_add_remove_concurrent() {
+    g_sink->reset();
+    auto& sinker = Sinker::instance();
+    sinker.init();
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+
+    std::atomic<bool> done{false};
+    std::thread churn([&] {
+        while (!done.load()) {
+            auto temp = std::make_shared<OrderCheckingSink>();
+            sinker.add_sinker(temp);
+            std::this_thread::yield();
+            sinker.remove_sinker(temp);
+        }
+    });
+
+    run_producers(PRODUCERS / 2, MESSAGES_PER_PRODUCER);
+    done.store(true);
+    churn.join();
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+
+    const size_t dropped = sinker.get_metrics().dropped_count - dropped_before;
+    TEST_ASSERT_EQUAL(static_cast<size_t>(PRODUCERS / 2 * MESSAGES_PER_PRODUCER), g_sink->received + dropped);
+    TEST_ASSERT_EQUAL(0u, g_sink->out_of_order);
+
+    sinker.shutdown();
+}
+
+void test_flush_shutdown_race() {
+    auto& sinker = Sinker::instance();
+    for (int round = 0; round < 10; ++round) {
+        g_sink->reset();
+        sinker.init();
+        const auto before = sinker.get_metrics();
+
+        std::thread producers([] { run_producers(4, 500); });
+        (void)sinker.flush(1);
+        sinker.shutdown();
+        producers.join();
+
+        // Producers that lost the race with shutdown either fell back to the
+        // synchronous path or left their message queued for the next init().
+        const auto after = sinker.get_metrics();
+        const size_t accounted = g_sink->received +
+                                 (after.dropped_count - before.dropped_count) +
+                                 after.queued_count - before.queued_count;
+        TEST_ASSERT_EQUAL(static_cast<size_t>(4 * 500), accounted);
+        TEST_ASSERT_FALSE(sinker.is_running());
+    }
+}
+
+void test_overflow_drops_oldest() {
+    auto& sinker = Sinker::instance();
+    auto gate = std::make_shared<GateSink>();
+    sinker.remove_sinker(g_sink);
+    sinker.add_sinker(gate);
+    sinker.init();
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+    const size_t capacity = sinker.get_metrics().capacity;
+
+    Logger logger("overflow");
+    logger.log(LogLevel::Info, "first");
+    gate->wait_entered(); // Worker is now parked inside consume()
+
+    const size_t overflow = 10;
+    for (size_t i = 0; i < capacity + overflow; ++i) {
+        logger.logf(LogLevel::Info, "{}", i);
+    }
+
+    auto metrics = sinker.get_metrics();
+    TEST_ASSERT_EQUAL(overflow, metrics.dropped_count - dropped_before);
+    TEST_ASSERT_EQUAL(capacity, metrics.queued_count);
+
+    gate->open();
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    sinker.shutdown();
+    sinker.remove_sinker(gate);
+    sinker.add_sinker(g_sink);
+
+    TEST_ASSERT_EQUAL(capacity + 1, gate->messages.size());
+    TEST_ASSERT_EQUAL_STRING("first", gate->messages.front().c_str());
+    TEST_ASSERT_EQUAL_STRING(std::to_string(overflow).c_str(), gate->messages[1].c_str());
+    TEST_ASSERT_EQUAL_STRING(std::to_string(capacity + overflow - 1).c_str(),
+                             gate->messages.back().c_str());
+}
+
+/**
+ * @brief Parks the worker while four producers overflow the queue into
+ * @p store, then checks that the overflow comes back in order.
+ */
+void check_spills_in_order(std::shared_ptr<ISpillStore> store) {
+    auto& sinker = Sinker::instance();
+    auto gate = std::make_shared<GateSink>();
+    sinker.remove_sinker(g_sink);
+    sinker.add_sinker(gate);
+    sinker.add_sinker(g_sink);
+    g_sink->reset();
+
+    SinkerConfig config;
+    config.spill_store = std::move(store);
+    sinker.init(config);
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+    const size_t spilled_before = sinker.get_metrics().spilled_count;
+
+    Logger logger("spill");
+    logger.log(LogLevel::Info, "first");
+    gate->wait_entered();
+    run_producers(4, 500);
+    const auto pressured = sinker.get_metrics();
+
+    gate->open();
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    const auto drained = sinker.get_metrics();
+    sinker.shutdown();
+    sinker.remove_sinker(gate);
+    sinker.init(); // Releases the spill store
+    sinker.shutdown();
+
+    TEST_ASSERT_TRUE(pressured.spill_pending_count > 0);
+    TEST_ASSERT_TRUE(pressured.spill_bytes > 0);
+    TEST_ASSERT_EQUAL(0u, drained.dropped_count - dropped_before);
+    TEST_ASSERT_TRUE(drained.spilled_count - spilled_before >= pressured.spill_pending_count);
+    TEST_ASSERT_EQUAL(0u, drained.spill_pending_count);
+    TEST_ASSERT_EQUAL(0u, drained.spill_bytes);
+    TEST_ASSERT_EQUAL(static_cast<size_t>(1 + 4 * 500), g_sink->received);
+    TEST_ASSERT_EQUAL(0u, g_sink->out_of_order);
+    TEST_ASSERT_EQUAL(static_cast<size_t>(1 + 4 * 500), gate->messages.size());
+}
+
+void test_overflow_spills_in_order() {
+    check_spills_in_order(std::make_shared<FileSpillStore>("loggable_spill_test.bin", 1024 * 1024));
+}
+
+void test_spill_read_errors_keep_order() {
+    // Reads that fail without removing anything are retried, not dropped
+    auto store = std::make_shared<FlakySpillStore>("loggable_spill_test.bin");
+    check_spills_in_order(store);
+    TEST_ASSERT_TRUE(store->failed_reads > 0);
+}
+
+void test_log_context() {
+#ifdef LOGGABLE_NO_HEAP
+    // Pushing a key and value needs the heap; nothing is current
+    TEST_ASSERT_TRUE(LogContext::current() == nullptr);
+#else
+    /// Keeps the context snapshot of every message.
+    class ContextSink : public ISink {
+    public:
+        void consume(const LogMessage& msg) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            contexts.push_back(msg.get_context());
+        }
+        std::string text(size_t index) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::string out;
+            if (contexts[index]) {
+                contexts[index]->format(out);
+            }
+            return out;
+        }
+        std::mutex mutex;
+        std::vector<std::shared_ptr<const LogContext>> contexts;
+    };
+
+    auto& sinker = Sinker::instance();
+    auto sink = std::make_shared<ContextSink>();
+    sinker.add_sinker(sink);
+    Logger logger("ctx");
+
+    logger.log(LogLevel::Info, "none");
+    {
+        ScopedContext connection("conn", "7");
+        {
+            ScopedContext request("req", "42");
+            logger.log(LogLevel::Info, "nested");
+            ScopedContext shadow("req", "43");
+            logger.log(LogLevel::Info, "shadowed");
+        }
+        logger.log(LogLevel::Info, "outer");
+
+        // Another thread starts empty, and can adopt a captured snapshot
+        const std::shared_ptr<const LogContext> snapshot = LogContext::current();
+        std::thread([&] {
+            logger.log(LogLevel::Info, "other thread");
+            ScopedContext adopted(snapshot);
+            logger.log(LogLevel::Info, "adopted");
+        }).join();
+    }
+    logger.log(LogLevel::Info, "after");
+    sinker.remove_sinker(sink);
+
+    // Messages keep their snapshot after the scopes have ended
+    TEST_ASSERT_EQUAL(7u, sink->contexts.size());
+    TEST_ASSERT_TRUE(sink->contexts[0] == nullptr);
+    TEST_ASSERT_EQUAL_STRING("conn=7 req=42", sink->text(1).c_str());
+    TEST_ASSERT_EQUAL_STRING("conn=7 req=42 req=43", sink->text(2).c_str());
+    TEST_ASSERT_EQUAL_STRING("43", sink->contexts[2]->find("req")->c_str());
+    TEST_ASSERT_TRUE(sink->contexts[2]->find("user") == nullptr);
+    TEST_ASSERT_EQUAL_STRING("conn=7", sink->text(3).c_str());
+    TEST_ASSERT_TRUE(sink->contexts[4] == nullptr);
+    TEST_ASSERT_TRUE(sink->contexts[5] == sink->contexts[3]); // Shared, not copied
+    TEST_ASSERT_TRUE(sink->contexts[6] == nullptr);
+    TEST_ASSERT_TRUE(LogContext::current() == nullptr);
+#endif
+}
+
+void test_zero_allocation_paths() {
+    auto& sinker = Sinker::instance();
+    Logger logger("alloc");
+
+    // Filtered messages never reach formatting
+    sinker.set_level(LogLevel::Info);
+    {
+        test::AllocationScope scope;
+        logger.log(LogLevel::Debug, "filtered out by level");
+        logger.logf(LogLevel::Verbose, "filtered {} {}", 1, "two");
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+
+    sinker.init();
+    {
+        // Short tag and text fit the small-string buffer: no heap on the producer
+        test::AllocationScope scope;
+        logger.log(LogLevel::Info, "ok");
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+#ifndef LOGGABLE_NO_HEAP // Pushing a key and value needs the heap
+    {
+        // The diagnostic context is attached by reference
+        ScopedContext context("request", "0123456789abcdef0123456789abcdef");
+        test::AllocationScope scope;
+        logger.log(LogLevel::Info, "ok");
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+#endif
+    {
+        // Pre-built payloads are moved, not copied, into the queue
+        const std::string tag(64, 't');
+        const std::string text(256, 'm');
+        LogMessage msg(std::chrono::system_clock::now(), LogLevel::Info,
+                       LogMessage::Tag(tag), LogMessage::Text(text));
+        test::AllocationScope scope;
+        sinker.dispatch(std::move(msg));
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+    {
+        test::AllocationScope scope;
+        (void)sinker.get_metrics();
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    sinker.shutdown();
+}
+
+void test_static_text() {
+    /// Keeps where the text of each message lives.
+    class ViewSink : public ISink {
+    public:
+        explicit ViewSink(bool static_text) : _static_text(static_text) {}
+        void consume(const LogMessage& msg) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_static.push_back(msg.has_static_text());
+            views.push_back(msg.get_message_view().data());
+            messages.emplace_back(msg.get_message());
+        }
+        bool supports_static_text() const noexcept override { return _static_text; }
+        std::mutex mutex;
+        std::vector<bool> is_static;
+        std::vector<const char*> views;
+        std::vector<std::string> messages;
+
+    private:
+        bool _static_text;
+    };
+
+    static constexpr char CONNECTED[] = "Connected to the access point";
+    static_assert(StaticText(CONNECTED).view() == "Connected to the access point");
+
+    // The static text shares the storage of owned text rather than
+    // adding a view next to it
+    struct Fields {
+        std::chrono::system_clock::time_point timestamp;
+        LogLevel level;
+        LogMessage::Tag tag;
+        LogMessage::Text text;
+        std::shared_ptr<const LogContext> context;
+    };
+    static_assert(sizeof(LogMessage) < sizeof(Fields) + sizeof(std::string_view));
+    const auto now = std::chrono::system_clock::now();
+    const LogMessage fixed(now, LogLevel::Info, "static", StaticText(CONNECTED));
+    LogMessage copy(now, LogLevel::Info, "static", LogMessage::Text("owned"));
+    copy = fixed;
+    TEST_ASSERT_TRUE(copy.has_static_text());
+    TEST_ASSERT_TRUE(copy.get_message_view().data() == CONNECTED);
+    TEST_ASSERT_TRUE(copy.get_message().empty());
+    LogMessage moved(std::move(copy));
+    TEST_ASSERT_TRUE(moved.get_message_view().data() == CONNECTED);
+    moved = LogMessage(now, LogLevel::Info, "static", LogMessage::Text("owned"));
+    TEST_ASSERT_FALSE(moved.has_static_text());
+    TEST_ASSERT_EQUAL_STRING("owned", moved.get_message().c_str());
+
+    auto& sinker = Sinker::instance();
+    auto viewer = std::make_shared<ViewSink>(true);
+    auto legacy = std::make_shared<ViewSink>(false);
+    sinker.add_sinker(viewer);
+    sinker.add_sinker(legacy);
+    Logger logger("static");
+
+    // Sinks that opt in see the literal itself, the others a copy
+    logger.log(LogLevel::Info, StaticText(CONNECTED));
+    sinker.init();
+    {
+        test::AllocationScope scope;
+        logger.log(LogLevel::Info, StaticText(CONNECTED));
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    sinker.shutdown();
+
+    // The same with each sink on a worker lane of its own
+    SinkerConfig config;
+    config.worker_count = 2;
+    sinker.init(config);
+    logger.log(LogLevel::Info, StaticText(CONNECTED));
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    sinker.shutdown();
+    sinker.remove_sinker(viewer);
+    sinker.remove_sinker(legacy);
+
+    TEST_ASSERT_EQUAL(3u, viewer->views.size());
+    TEST_ASSERT_EQUAL(3u, legacy->views.size());
+    for (size_t i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(viewer->is_static[i]);
+        TEST_ASSERT_TRUE(viewer->views[i] == CONNECTED);
+        TEST_ASSERT_TRUE(viewer->messages[i].empty());
+        TEST_ASSERT_FALSE(legacy->is_static[i]);
+        TEST_ASSERT_EQUAL_STRING(CONNECTED, legacy->messages[i].c_str());
+    }
+}
+
+static int vlog_line_helper(Logger& logger, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int len = logger.vlog_line(format, args);
+    va_end(args);
+    return len;
+}
+
+void test_printf_formats_into_payload() {
+    /// Keeps the text of every message.
+    class TextSink : public ISink {
+    public:
+        void consume(const LogMessage& msg) override { messages.emplace_back(msg.get_message()); }
+        std::vector<std::string> messages;
+    };
+
+    auto& sinker = Sinker::instance();
+    auto sink = std::make_shared<TextSink>();
+    sinker.add_sinker(sink);
+    sinker.set_level(LogLevel::Info);
+    Logger logger("printf");
+    const std::string long_text(2 * Logger::LINE_BUFFER_SIZE, 'x');
+
+    sinker.init();
+#ifdef LOGGABLE_NO_HEAP
+    constexpr size_t long_line_allocations = 0; // Cut to the stack buffer
+#else
+    constexpr size_t long_line_allocations = 1;
+#endif
+    int len = 0;
+    {
+        // A line longer than the stack buffer is formatted into its own
+        // text, which the queue takes over: one allocation, no copy
+        test::AllocationScope scope;
+        len = vlog_line_helper(logger, "I (%d) %s: %s\n", 42, "wifi", long_text.c_str());
+        TEST_ASSERT_EQUAL(long_line_allocations, scope.count());
+    }
+    TEST_ASSERT_EQUAL(static_cast<int>(long_text.size()) + 14, len);
+    {
+        // Filtered lines allocate nothing but still report their length
+        test::AllocationScope scope;
+        TEST_ASSERT_EQUAL(14, vlog_line_helper(logger, "D (%d) %s: %s\n", 1, "wifi", "x"));
+        TEST_ASSERT_EQUAL(0u, scope.count());
+    }
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    sinker.shutdown();
+    sinker.remove_sinker(sink);
+
+    TEST_ASSERT_EQUAL(1u, sink->messages.size());
+#ifdef LOGGABLE_NO_HEAP
+    TEST_ASSERT_TRUE(!sink->messages[0].empty() && long_text.starts_with(sink->messages[0]));
+#else
+    TEST_ASSERT_TRUE(sink->messages[0] == long_text);
+#endif
+}
+
+int main() {
+    printf("Starting loggable host tests...\n");
+
+    os::set_backend(&g_backend);
+    g_sink = std::make_shared<OrderCheckingSink>();
+    Sinker::instance().add_sinker(g_sink);
+    Sinker::instance().set_level(LogLevel::Info);
+
+    RUN_TEST(test_ringbuffer_signaling_modes);
+    RUN_TEST(test_async_many_producers);
+    RUN_TEST(test_async_worker_pool);
+    RUN_TEST(test_fan_out_shares_payload);
+    RUN_TEST(test_async_priority_ordering);
+    RUN_TEST(test_async_add_remove_concurrent);
+    RUN_TEST(test_flush_shutdown_race);
+    RUN_TEST(test_overflow_drops_oldest);
+    RUN_TEST(test_overflow_spills_in_order);
+    RUN_TEST(test_spill_read_errors_keep_order);
+    RUN_TEST(test_log_context);
+    RUN_TEST(test_zero_allocation_paths);
+    RUN_TEST(test_static_text);
+    RUN_TEST(test_printf_formats_into_payload);
+
+    Sinker::instance().remove_sinker(g_sink);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
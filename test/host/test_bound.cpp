@@ -0,0 +1,67 @@
+#include <cstdio>
+#include <memory>
+#include <type_traits>
+
+#include "loggable.hpp"
+#include "std_backend.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+// Built against a copy of the library compiled with
+// LOGGABLE_BACKEND_TYPE=loggable::test::StdBackend.
+
+static_assert(std::is_same_v<os::BoundBackend, test::StdBackend>,
+              "library must be compiled with the bound backend");
+static_assert(std::is_same_v<decltype(os::bound_backend()), test::StdBackend*>,
+              "bound backend calls must go through the final type");
+
+namespace {
+
+class CountingSink : public ISink {
+public:
+    void consume(const LogMessage& /*msg*/) override { ++received; }
+    size_t received{0};
+};
+
+} // namespace
+
+void test_bound_backend_registry() {
+    TEST_ASSERT_TRUE(os::get_backend() == &test::StdBackend::instance());
+    // The runtime registry cannot unbind a compile-time backend
+    os::set_backend(nullptr);
+    TEST_ASSERT_TRUE(os::get_backend() == &test::StdBackend::instance());
+}
+
+void test_bound_async_delivery() {
+    auto sink = std::make_shared<CountingSink>();
+    auto& sinker = Sinker::instance();
+    sinker.add_sinker(sink);
+    sinker.init();
+    TEST_ASSERT_TRUE(sinker.is_running());
+
+    Logger logger("bound");
+    for (int i = 0; i < 50; ++i) {
+        logger.log(LogLevel::Info, "direct call");
+    }
+    const bool flushed = sinker.flush(5000);
+    sinker.shutdown();
+    sinker.remove_sinker(sink);
+
+    TEST_ASSERT_TRUE(flushed);
+    TEST_ASSERT_EQUAL(50u, sink->received + sinker.get_metrics().dropped_count);
+}
+
+int main() {
+    printf("Starting loggable bound-backend tests...\n");
+
+    // Construct the backend before the Sinker so it is destroyed after it
+    (void)test::StdBackend::instance();
+    Sinker::instance().set_level(LogLevel::Info);
+
+    RUN_TEST(test_bound_backend_registry);
+    RUN_TEST(test_bound_async_delivery);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
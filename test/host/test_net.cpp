@@ -0,0 +1,515 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "loggable.hpp"
+#include "loggable_net.hpp"
+#include "std_backend.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+// Network sinks, each sending to a receiver socket on the loopback
+// interface.
+
+namespace {
+
+test::StdBackend g_backend;
+
+/**
+ * @brief UDP socket bound to an ephemeral loopback port.
+ */
+class LoopbackReceiver {
+public:
+    LoopbackReceiver() {
+        _socket = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        (void)bind(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        socklen_t size = sizeof(address);
+        (void)getsockname(_socket, reinterpret_cast<sockaddr*>(&address), &size);
+        _port = ntohs(address.sin_port);
+        const int buffer = 1 << 20; // Hold a whole test's traffic
+        (void)setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+
+    ~LoopbackReceiver() { close(_socket); }
+
+    [[nodiscard]] uint16_t port() const { return _port; }
+
+    /// Next datagram, or false after @p timeout_ms without one.
+    bool receive(std::vector<uint8_t>& datagram, int timeout_ms) {
+        pollfd fd{.fd = _socket, .events = POLLIN, .revents = 0};
+        if (poll(&fd, 1, timeout_ms) != 1) {
+            return false;
+        }
+        datagram.resize(65536);
+        const ssize_t size = recv(_socket, datagram.data(), datagram.size(), 0);
+        datagram.resize(size > 0 ? static_cast<size_t>(size) : 0);
+        return size >= 0;
+    }
+
+private:
+    int _socket{-1};
+    uint16_t _port{0};
+};
+
+/**
+ * @brief Records of all binary datagrams arriving within @p timeout_ms of each other.
+ */
+struct Received {
+    size_t datagrams{0};
+    size_t largest{0};
+    size_t bad{0};
+    size_t sequence_gaps{0};
+    std::vector<std::string> messages;
+};
+
+Received receive_binary(LoopbackReceiver& receiver, int timeout_ms = 200) {
+    Received result;
+    std::vector<uint8_t> datagram;
+    uint32_t expected = 0;
+    while (receiver.receive(datagram, timeout_ms)) {
+        ++result.datagrams;
+        result.largest = std::max(result.largest, datagram.size());
+        uint32_t sequence = 0;
+        const bool whole = net::parse_datagram(datagram.data(), datagram.size(), sequence,
+                                               [&](const record::RecordView& view) {
+            result.messages.emplace_back(view.message);
+        });
+        result.bad += whole ? 0 : 1;
+        result.sequence_gaps += sequence == expected ? 0 : 1;
+        expected = sequence + 1;
+    }
+    return result;
+}
+
+LogMessage make_message(int64_t ms, LogLevel level, std::string_view tag, std::string_view text) {
+    return LogMessage(std::chrono::system_clock::time_point(std::chrono::milliseconds(ms)),
+                      level, LogMessage::Tag(tag), LogMessage::Text(text));
+}
+
+/**
+ * @brief TCP listener on an ephemeral loopback port, reading one client at a time.
+ *
+ * Bound right away so the port is known; connections are refused until
+ * listen().
+ */
+class LoopbackServer {
+public:
+    explicit LoopbackServer(bool listening = true) {
+        _socket = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        (void)bind(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        socklen_t size = sizeof(address);
+        (void)getsockname(_socket, reinterpret_cast<sockaddr*>(&address), &size);
+        _port = ntohs(address.sin_port);
+        if (listening) {
+            listen();
+        }
+    }
+
+    ~LoopbackServer() {
+        drop_client();
+        close(_socket);
+    }
+
+    [[nodiscard]] uint16_t port() const { return _port; }
+
+    void listen() { (void)::listen(_socket, 4); }
+
+    void drop_client() {
+        if (_client >= 0) {
+            close(_client);
+            _client = -1;
+        }
+    }
+
+    /// Append everything arriving within @p timeout_ms of the last bytes,
+    /// accepting a connection first if there is none.
+    std::vector<uint8_t>& read(int timeout_ms = 200) {
+        if (_client < 0) {
+            pollfd fd{.fd = _socket, .events = POLLIN, .revents = 0};
+            if (poll(&fd, 1, timeout_ms) != 1) {
+                return _stream;
+            }
+            _client = accept(_socket, nullptr, nullptr);
+        }
+        uint8_t buffer[4096];
+        pollfd fd{.fd = _client, .events = POLLIN, .revents = 0};
+        while (poll(&fd, 1, timeout_ms) == 1) {
+            const ssize_t size = recv(_client, buffer, sizeof(buffer), 0);
+            if (size <= 0) {
+                break;
+            }
+            _stream.insert(_stream.end(), buffer, buffer + size);
+        }
+        return _stream;
+    }
+
+private:
+    int _socket{-1};
+    int _client{-1};
+    uint16_t _port{0};
+    std::vector<uint8_t> _stream;
+};
+
+/// Messages of a stream of binary records; stops at the first bad one.
+std::vector<std::string> stream_messages(const std::vector<uint8_t>& stream) {
+    std::vector<std::string> messages;
+    record::RecordView view;
+    for (size_t pos = 0; pos < stream.size();) {
+        const size_t consumed = record::parse(stream.data() + pos, stream.size() - pos, view);
+        if (consumed == 0) {
+            break;
+        }
+        messages.emplace_back(view.message);
+        pos += consumed;
+    }
+    return messages;
+}
+
+TcpSinkConfig tcp_config(const LoopbackServer& server) {
+    TcpSinkConfig config;
+    config.port = server.port();
+    config.format = NetFormat::Binary;
+    config.linger_ms = 0;
+    config.backoff_min_ms = 10;
+    config.backoff_max_ms = 40;
+    return config;
+}
+
+/// Drive @p sink as the dispatch worker would, until all is sent.
+bool drain(TcpSink& sink, int timeout_ms = 2000) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!sink.flush()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        const uint32_t wait_ms = sink.on_idle();
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min<uint32_t>(wait_ms, 10)));
+    }
+    return true;
+}
+
+std::vector<std::string> numbered(const std::string& prefix, int from, int count) {
+    std::vector<std::string> messages;
+    for (int i = from; i < from + count; ++i) {
+        messages.push_back(prefix + std::to_string(i));
+    }
+    return messages;
+}
+
+UdpSinkConfig binary_config(const LoopbackReceiver& receiver) {
+    UdpSinkConfig config;
+    config.port = receiver.port();
+    config.format = NetFormat::Binary;
+    config.linger_ms = 0;
+    return config;
+}
+
+} // namespace
+
+void test_udp_batches_records() {
+    LoopbackReceiver receiver;
+    constexpr int COUNT = 1000;
+    UdpSink sink(binary_config(receiver));
+    TEST_ASSERT_TRUE(sink.is_open());
+    for (int i = 0; i < COUNT; ++i) {
+        sink.consume(make_message(i, LogLevel::Info, "sensor", "reading " + std::to_string(i)));
+    }
+    TEST_ASSERT_EQUAL(os::WAIT_FOREVER, sink.on_idle()); // Sends the partial datagram
+
+    const Received got = receive_binary(receiver);
+    const UdpSink::Stats stats = sink.stats();
+    TEST_ASSERT_EQUAL(static_cast<size_t>(COUNT), got.messages.size());
+    TEST_ASSERT_TRUE(got.messages.front() == "reading 0");
+    TEST_ASSERT_TRUE(got.messages.back() == "reading 999");
+    TEST_ASSERT_EQUAL(0u, got.bad);
+    TEST_ASSERT_EQUAL(0u, got.sequence_gaps);
+    TEST_ASSERT_EQUAL(stats.datagrams_sent, got.datagrams);
+    TEST_ASSERT_EQUAL(0u, stats.datagrams_dropped);
+    // About 40 records per datagram, each within the size limit
+    TEST_ASSERT_TRUE(got.datagrams * 30 < static_cast<size_t>(COUNT));
+    TEST_ASSERT_TRUE(got.largest <= 1232);
+}
+
+void test_udp_syslog_lines() {
+    LoopbackReceiver receiver;
+    UdpSinkConfig config;
+    config.port = receiver.port();
+    config.linger_ms = 0;
+    config.hostname = "gw 01";
+    {
+        UdpSink sink(config);
+        sink.consume(make_message(1'700'000'000'123, LogLevel::Warning, "wifi", "lost\nlink"));
+        sink.consume(make_message(951'782'400'000, LogLevel::Error, "", "leap day"));
+    } // Destruction sends the open datagram
+
+    std::vector<uint8_t> datagram;
+    TEST_ASSERT_TRUE(receiver.receive(datagram, 200));
+    const std::string text(datagram.begin(), datagram.end());
+    TEST_ASSERT_EQUAL_STRING(
+        "<12>1 2023-11-14T22:13:20.123Z gw_01 loggable - wifi - lost link\n"
+        "<11>1 2000-02-29T00:00:00.000Z gw_01 loggable - - - leap day",
+        text.c_str());
+
+    // One record per datagram for strict RFC 5426 receivers
+    config.max_records = 1;
+    {
+        UdpSink sink(config);
+        for (int i = 0; i < 3; ++i) {
+            sink.consume(make_message(0, LogLevel::Info, "t", std::to_string(i)));
+        }
+    }
+    size_t datagrams = 0;
+    while (receiver.receive(datagram, 200)) {
+        ++datagrams;
+        TEST_ASSERT_TRUE(datagram.back() == static_cast<uint8_t>('0' + datagrams - 1));
+    }
+    TEST_ASSERT_EQUAL(3u, datagrams);
+}
+
+void test_syslog_context() {
+#ifndef LOGGABLE_NO_HEAP // Pushing a key and value needs the heap
+    ScopedContext request("req id", "a\"b]c\\d");
+    ScopedContext connection("conn", "7");
+    const record::RecordView view{.timestamp_ms = 0, .level = LogLevel::Info, .tag = "t",
+                                  .message = "ok"};
+    std::vector<uint8_t> out;
+    net::format_syslog(view, 1, "-", "app", out, LogContext::current().get());
+    TEST_ASSERT_EQUAL_STRING(
+        "<14>1 1970-01-01T00:00:00.000Z - app - t [ctx@32473 reqid=\"a\\\"b\\]c\\\\d\" conn=\"7\"] ok",
+        std::string(out.begin(), out.end()).c_str());
+#endif
+}
+
+void test_udp_linger() {
+    LoopbackReceiver receiver;
+    UdpSinkConfig config = binary_config(receiver);
+    config.linger_ms = 100;
+    UdpSink sink(config);
+    sink.consume(make_message(0, LogLevel::Info, "t", "held"));
+
+    // Held back for more records until the linger time is up
+    const uint32_t wait_ms = sink.on_idle();
+    TEST_ASSERT_TRUE(wait_ms > 0 && wait_ms <= 100);
+    std::vector<uint8_t> datagram;
+    TEST_ASSERT_FALSE(receiver.receive(datagram, 0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms + 5));
+    TEST_ASSERT_EQUAL(os::WAIT_FOREVER, sink.on_idle());
+    TEST_ASSERT_TRUE(receiver.receive(datagram, 200));
+}
+
+void test_udp_through_sinker() {
+    LoopbackReceiver receiver;
+    UdpSinkConfig config = binary_config(receiver);
+    config.linger_ms = 20;
+    auto sink = std::make_shared<UdpSink>(config);
+    auto& sinker = Sinker::instance();
+    sinker.add_sinker(sink);
+    sinker.init();
+
+    // Bursts that fit the queue. The worker runs idle between them, and
+    // the linger time lets the next burst fill the open datagram.
+    constexpr int COUNT = 2000;
+    Logger logger("net");
+    for (int i = 0; i < COUNT; ++i) {
+        logger.logf(LogLevel::Info, "message {}", i);
+        if (i % 100 == 99) {
+            TEST_ASSERT_TRUE(sinker.flush(5000));
+        }
+    }
+    const Received got = receive_binary(receiver, 500);
+    const size_t dropped = sinker.get_metrics().dropped_count;
+
+    sinker.shutdown();
+    sinker.remove_sinker(sink);
+    TEST_ASSERT_EQUAL(0u, dropped);
+    TEST_ASSERT_EQUAL(static_cast<size_t>(COUNT), got.messages.size());
+    TEST_ASSERT_TRUE(got.messages.back() == "message 1999");
+    TEST_ASSERT_EQUAL(0u, got.sequence_gaps);
+    TEST_ASSERT_TRUE(got.datagrams * 20 < static_cast<size_t>(COUNT));
+}
+
+void test_tcp_streams_records() {
+    LoopbackServer server;
+    constexpr int COUNT = 1000;
+    TcpSink sink(tcp_config(server));
+    for (int i = 0; i < COUNT; ++i) {
+        sink.consume(make_message(i, LogLevel::Info, "sensor", "reading " + std::to_string(i)));
+    }
+    TEST_ASSERT_TRUE(drain(sink));
+    TEST_ASSERT_TRUE(sink.is_connected());
+
+    const std::vector<uint8_t>& stream = server.read();
+    const TcpSink::Stats stats = sink.stats();
+    TEST_ASSERT_TRUE(stream_messages(stream) == numbered("reading ", 0, COUNT));
+    TEST_ASSERT_EQUAL(stream.size(), static_cast<size_t>(stats.bytes_sent));
+    TEST_ASSERT_EQUAL(1u, stats.connects);
+    TEST_ASSERT_EQUAL(0u, stats.records_dropped);
+
+    // Syslog messages with RFC 6587 octet counting
+    LoopbackServer syslog_server;
+    TcpSinkConfig config = tcp_config(syslog_server);
+    config.format = NetFormat::Syslog;
+    TcpSink syslog_sink(config);
+    syslog_sink.consume(make_message(1'700'000'000'123, LogLevel::Warning, "wifi", "lost link"));
+    syslog_sink.consume(make_message(951'782'400'000, LogLevel::Error, "", "leap day"));
+    TEST_ASSERT_TRUE(drain(syslog_sink));
+    const std::vector<uint8_t>& text = syslog_server.read();
+    TEST_ASSERT_EQUAL_STRING("60 <12>1 2023-11-14T22:13:20.123Z - loggable - wifi - lost link"
+                             "56 <11>1 2000-02-29T00:00:00.000Z - loggable - - - leap day",
+                             std::string(text.begin(), text.end()).c_str());
+}
+
+void test_tcp_reconnects_with_backoff() {
+    LoopbackServer server(false);
+    TcpSink sink(tcp_config(server));
+    for (int i = 0; i < 10; ++i) {
+        sink.consume(make_message(i, LogLevel::Info, "t", "early " + std::to_string(i)));
+    }
+
+    // Refused; retries back off from 10 to 40 ms instead of spinning
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < until) {
+        const uint32_t wait_ms = sink.on_idle();
+        TEST_ASSERT_TRUE(wait_ms >= 1 && wait_ms <= 40);
+        std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
+    }
+    const TcpSink::Stats down = sink.stats();
+    TEST_ASSERT_TRUE(down.connect_failures >= 4 && down.connect_failures <= 12);
+    TEST_ASSERT_EQUAL(0u, down.connects);
+    const SinkBackpressure pressure = sink.backpressure();
+    TEST_ASSERT_TRUE(pressure.stalled);
+    TEST_ASSERT_TRUE(pressure.buffered_bytes > 0);
+
+    server.listen();
+    TEST_ASSERT_TRUE(drain(sink));
+    TEST_ASSERT_TRUE(stream_messages(server.read()) == numbered("early ", 0, 10));
+    TEST_ASSERT_EQUAL(1u, sink.stats().connects);
+    TEST_ASSERT_FALSE(sink.backpressure().stalled);
+    TEST_ASSERT_EQUAL(0u, sink.backpressure().buffered_bytes);
+}
+
+void test_tcp_overflow_store() {
+    LoopbackServer server(false);
+    TcpSinkConfig config = tcp_config(server);
+    config.batch_bytes = 512;
+    config.buffer_bytes = 1024;
+    constexpr int COUNT = 500;
+
+    // Without a store, batches beyond the memory buffer are dropped
+    {
+        TcpSink sink(config);
+        for (int i = 0; i < COUNT; ++i) {
+            sink.consume(make_message(i, LogLevel::Info, "t", "lost " + std::to_string(i)));
+        }
+        TEST_ASSERT_TRUE(sink.stats().records_dropped > COUNT / 2);
+        TEST_ASSERT_EQUAL(sink.stats().records_dropped, sink.backpressure().dropped_count);
+    }
+
+    config.overflow_store = std::make_shared<FileSpillStore>("loggable_tcp_test.bin", 1024 * 1024);
+    TcpSink sink(config);
+    for (int i = 0; i < COUNT; ++i) {
+        sink.consume(make_message(i, LogLevel::Info, "t", "kept " + std::to_string(i)));
+    }
+    const TcpSink::Stats down = sink.stats();
+    TEST_ASSERT_EQUAL(0u, down.records_dropped);
+    TEST_ASSERT_TRUE(down.batches_stored > 10);
+    TEST_ASSERT_TRUE(sink.backpressure().buffered_bytes > config.buffer_bytes);
+
+    server.listen();
+    TEST_ASSERT_TRUE(drain(sink));
+    TEST_ASSERT_TRUE(stream_messages(server.read()) == numbered("kept ", 0, COUNT));
+    TEST_ASSERT_EQUAL(0u, config.overflow_store->size_bytes());
+}
+
+void test_tcp_peer_close() {
+    LoopbackServer server;
+    TcpSink sink(tcp_config(server));
+    for (int i = 0; i < 10; ++i) {
+        sink.consume(make_message(i, LogLevel::Info, "t", "first " + std::to_string(i)));
+    }
+    TEST_ASSERT_TRUE(drain(sink));
+    TEST_ASSERT_EQUAL(10u, stream_messages(server.read()).size());
+
+    // The collector restarts; the next idle pass notices
+    server.drop_client();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    (void)sink.on_idle();
+    TEST_ASSERT_FALSE(sink.is_connected());
+    TEST_ASSERT_EQUAL(1u, sink.stats().disconnects);
+
+    for (int i = 10; i < 20; ++i) {
+        sink.consume(make_message(i, LogLevel::Info, "t", "first " + std::to_string(i)));
+    }
+    TEST_ASSERT_TRUE(drain(sink));
+    TEST_ASSERT_TRUE(stream_messages(server.read()) == numbered("first ", 0, 20));
+    TEST_ASSERT_EQUAL(2u, sink.stats().connects);
+}
+
+void test_tcp_backpressure_metrics() {
+    LoopbackServer server(false);
+    TcpSinkConfig config = tcp_config(server);
+    config.linger_ms = 5;
+    auto sink = std::make_shared<TcpSink>(config);
+    auto& sinker = Sinker::instance();
+    sinker.add_sinker(sink);
+    sinker.init();
+
+    Logger logger("net");
+    for (int i = 0; i < 50; ++i) {
+        logger.logf(LogLevel::Info, "queued {}", i);
+    }
+    TEST_ASSERT_TRUE(sinker.flush(5000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Past the linger time
+    const SinkerMetrics down = sinker.get_metrics();
+
+    // The worker keeps retrying while idle
+    server.listen();
+    const std::vector<std::string> messages = stream_messages(server.read(500));
+    const SinkerMetrics up = sinker.get_metrics();
+
+    sinker.shutdown();
+    sinker.remove_sinker(sink);
+    TEST_ASSERT_EQUAL(1u, down.stalled_sinks);
+    TEST_ASSERT_TRUE(down.sink_buffered_bytes > 0);
+    TEST_ASSERT_TRUE(messages == numbered("queued ", 0, 50));
+    TEST_ASSERT_EQUAL(0u, up.stalled_sinks);
+    TEST_ASSERT_EQUAL(0u, up.sink_buffered_bytes);
+    TEST_ASSERT_EQUAL(0u, up.sink_dropped_count);
+}
+
+int main() {
+    printf("Starting loggable network tests...\n");
+
+    os::set_backend(&g_backend);
+    Sinker::instance().set_level(LogLevel::Info);
+
+    RUN_TEST(test_udp_batches_records);
+    RUN_TEST(test_udp_syslog_lines);
+    RUN_TEST(test_syslog_context);
+    RUN_TEST(test_udp_linger);
+    RUN_TEST(test_udp_through_sinker);
+    RUN_TEST(test_tcp_streams_records);
+    RUN_TEST(test_tcp_reconnects_with_backoff);
+    RUN_TEST(test_tcp_overflow_store);
+    RUN_TEST(test_tcp_peer_close);
+    RUN_TEST(test_tcp_backpressure_metrics);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
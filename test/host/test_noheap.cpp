@@ -0,0 +1,161 @@
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "alloc_counter.hpp"
+#include "loggable.hpp"
+#include "std_backend.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+// Built against a copy of the library compiled with LOGGABLE_NO_HEAP.
+
+static_assert(std::is_same_v<LogMessage::Text, InlineString<LOGGABLE_MAX_MESSAGE>>,
+              "library must be compiled with LOGGABLE_NO_HEAP");
+
+namespace {
+
+/**
+ * @brief Counts deliveries and keeps the sizes of the last one; never allocates.
+ */
+class SizeSink : public ISink {
+public:
+    explicit SizeSink(bool ordered = false) noexcept : _ordered(ordered) {}
+
+    void consume(const LogMessage& msg) override {
+        last_tag_size.store(msg.get_tag().size(), std::memory_order_relaxed);
+        last_message_size.store(msg.get_message().size(), std::memory_order_relaxed);
+        if (msg.get_context()) {
+            with_context.fetch_add(1, std::memory_order_relaxed);
+        }
+        received.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool requires_ordering() const noexcept override { return _ordered; }
+
+    std::atomic<size_t> received{0};
+    std::atomic<size_t> with_context{0};
+    std::atomic<size_t> last_tag_size{0};
+    std::atomic<size_t> last_message_size{0};
+
+private:
+    bool _ordered;
+};
+
+void log_printf(Logger& logger, LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logger.vlogf(level, format, args);
+    va_end(args);
+}
+
+} // namespace
+
+void test_noheap_cuts_payloads() {
+    auto sink = std::make_shared<SizeSink>();
+    auto& sinker = Sinker::instance();
+    sinker.add_sinker(sink);
+
+    const std::string long_tag(64, 't');
+    const std::string long_text(300, 'm');
+    Logger logger(long_tag);
+    logger.log(LogLevel::Info, long_text);
+    TEST_ASSERT_EQUAL(size_t{LOGGABLE_MAX_TAG}, sink->last_tag_size.load());
+    TEST_ASSERT_EQUAL(size_t{LOGGABLE_MAX_MESSAGE}, sink->last_message_size.load());
+
+    logger.logf(LogLevel::Info, "{} {}", long_text, 42);
+    TEST_ASSERT_EQUAL(size_t{LOGGABLE_MAX_MESSAGE}, sink->last_message_size.load());
+    log_printf(logger, LogLevel::Info, "%s %d", long_text.c_str(), 42);
+    TEST_ASSERT_EQUAL(size_t{LOGGABLE_MAX_MESSAGE}, sink->last_message_size.load());
+
+    logger.log(LogLevel::Info, "short");
+    TEST_ASSERT_EQUAL(5u, sink->last_message_size.load());
+    TEST_ASSERT_EQUAL(4u, sink->received.load());
+    sinker.remove_sinker(sink);
+}
+
+void test_noheap_sink_table_bounded() {
+    auto& sinker = Sinker::instance();
+    std::shared_ptr<SizeSink> sinks[LOGGABLE_MAX_SINKS + 1];
+    for (auto& sink : sinks) {
+        sink = std::make_shared<SizeSink>();
+        sinker.add_sinker(sink); // The last one finds the table full
+    }
+
+    Logger("table").log(LogLevel::Info, "fan out");
+    for (size_t i = 0; i < LOGGABLE_MAX_SINKS; ++i) {
+        TEST_ASSERT_EQUAL(1u, sinks[i]->received.load());
+    }
+    TEST_ASSERT_EQUAL(0u, sinks[LOGGABLE_MAX_SINKS]->received.load());
+
+    // Removing one frees its entry
+    sinker.remove_sinker(sinks[0]);
+    sinker.add_sinker(sinks[LOGGABLE_MAX_SINKS]);
+    Logger("table").log(LogLevel::Info, "again");
+    TEST_ASSERT_EQUAL(1u, sinks[0]->received.load());
+    TEST_ASSERT_EQUAL(1u, sinks[LOGGABLE_MAX_SINKS]->received.load());
+    for (auto& sink : sinks) {
+        sinker.remove_sinker(sink);
+    }
+}
+
+void test_noheap_steady_state() {
+    // Startup: sinks, workers and contexts may allocate
+    auto& sinker = Sinker::instance();
+    auto unordered = std::make_shared<SizeSink>();
+    auto ordered = std::make_shared<SizeSink>(/*ordered=*/true);
+    sinker.add_sinker(unordered);
+    sinker.add_sinker(ordered);
+    SinkerConfig config;
+    config.worker_count = 2;
+    sinker.init(config);
+    TEST_ASSERT_TRUE(sinker.is_running());
+    const auto request = std::make_shared<const LogContext>("request", "42", nullptr);
+
+    constexpr size_t MESSAGES = 400;
+    const std::string long_text(200, 'x');
+    const size_t before = test::total_allocation_count();
+    {
+        ScopedContext context(request);
+        Logger logger("steady");
+        for (size_t i = 0; i < MESSAGES / 4; ++i) {
+            logger.log(LogLevel::Info, long_text);
+            logger.logf(LogLevel::Warning, "priority {} of {}", i, MESSAGES);
+            log_printf(logger, LogLevel::Info, "printf %zu", i);
+            auto span = logger.span<LogLevel::Info>("span");
+            if (i % 4 == 3) {
+                TEST_ASSERT_TRUE(sinker.flush(10000)); // Stay within the lane
+            }
+        }
+        (void)sinker.get_metrics();
+    }
+    const size_t allocations = test::total_allocation_count() - before;
+    const auto metrics = sinker.get_metrics();
+    sinker.shutdown();
+    sinker.remove_sinker(unordered);
+    sinker.remove_sinker(ordered);
+
+    TEST_ASSERT_EQUAL(0u, allocations);
+    TEST_ASSERT_EQUAL(0u, metrics.dropped_count);
+    TEST_ASSERT_EQUAL(MESSAGES, unordered->received.load());
+    TEST_ASSERT_EQUAL(MESSAGES, ordered->received.load());
+    TEST_ASSERT_EQUAL(MESSAGES, unordered->with_context.load());
+}
+
+int main() {
+    printf("Starting loggable no-heap tests...\n");
+
+    os::set_backend(&test::StdBackend::instance());
+    Sinker::instance().set_level(LogLevel::Info);
+
+    RUN_TEST(test_noheap_cuts_payloads);
+    RUN_TEST(test_noheap_sink_table_bounded);
+    RUN_TEST(test_noheap_steady_state);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
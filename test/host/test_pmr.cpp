@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "loggable.hpp"
+#include "loggable_pool.hpp"
+#include "std_backend.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+// Built against a copy of the library compiled with LOGGABLE_PMR.
+
+static_assert(std::is_same_v<LogMessage::Text, std::pmr::string>,
+              "library must be compiled with LOGGABLE_PMR");
+
+namespace {
+
+/**
+ * @brief Stand-in for a dedicated arena: malloc-backed, so it never shows up
+ * in the global operator new count, and it tracks what is still allocated.
+ */
+class ArenaResource : public std::pmr::memory_resource {
+public:
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> live_bytes{0};
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (alignment > alignof(std::max_align_t)) {
+            throw std::bad_alloc();
+        }
+        void* memory = std::malloc(bytes);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        return memory;
+    }
+
+    void do_deallocate(void* memory, size_t bytes, size_t /*alignment*/) override {
+        live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        std::free(memory);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * @brief Counts deliveries whose tag and text came from @p resource.
+ */
+class ResourceSink : public ISink {
+public:
+    ResourceSink(std::pmr::memory_resource* resource, bool ordered) noexcept
+        : _resource(resource), _ordered(ordered) {}
+
+    void consume(const LogMessage& msg) override {
+        if (msg.get_tag().get_allocator().resource() == _resource &&
+            msg.get_message().get_allocator().resource() == _resource) {
+            from_resource.fetch_add(1, std::memory_order_relaxed);
+        }
+        received.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool requires_ordering() const noexcept override { return _ordered; }
+
+    std::atomic<size_t> received{0};
+    std::atomic<size_t> from_resource{0};
+
+private:
+    std::pmr::memory_resource* _resource;
+    bool _ordered;
+};
+
+/**
+ * @brief Moves the Sinker back to the default resource and drops @p sinks on
+ * scope exit, so a failed assertion cannot leave it on a dead resource.
+ */
+class DefaultResourceGuard {
+public:
+    explicit DefaultResourceGuard(std::vector<std::shared_ptr<ISink>> sinks) noexcept
+        : _sinks(std::move(sinks)) {}
+
+    ~DefaultResourceGuard() {
+        auto& sinker = Sinker::instance();
+        sinker.shutdown();
+        if (sinker.memory_resource() != std::pmr::get_default_resource()) {
+            sinker.init(SinkerConfig{});
+            sinker.shutdown();
+        }
+        for (const auto& sink : _sinks) {
+            sinker.remove_sinker(sink);
+        }
+    }
+
+    DefaultResourceGuard(const DefaultResourceGuard&) = delete;
+    DefaultResourceGuard& operator=(const DefaultResourceGuard&) = delete;
+
+private:
+    std::vector<std::shared_ptr<ISink>> _sinks;
+};
+
+} // namespace
+
+void test_pmr_sync_uses_default_resource() {
+    auto& sinker = Sinker::instance();
+    TEST_ASSERT_TRUE(sinker.memory_resource() == std::pmr::get_default_resource());
+    auto sink = std::make_shared<ResourceSink>(std::pmr::get_default_resource(), false);
+    sinker.add_sinker(sink);
+
+    Logger("sync").log(LogLevel::Info, "a message too long for the small buffer");
+    TEST_ASSERT_EQUAL(1u, sink->from_resource.load());
+    sinker.remove_sinker(sink);
+}
+
+void test_pmr_pipeline_allocates_from_resource() {
+    ArenaResource arena;
+    auto& sinker = Sinker::instance();
+    auto unordered = std::make_shared<ResourceSink>(&arena, false);
+    auto ordered = std::make_shared<ResourceSink>(&arena, true);
+    DefaultResourceGuard guard({unordered, ordered});
+    sinker.add_sinker(unordered);
+    sinker.add_sinker(ordered);
+
+    SinkerConfig config;
+    config.worker_count = 2;
+    config.memory_resource = &arena;
+    sinker.init(config);
+    TEST_ASSERT_TRUE(sinker.is_running());
+    TEST_ASSERT_TRUE(sinker.memory_resource() == &arena);
+    const size_t startup = arena.allocations.load();
+    TEST_ASSERT_TRUE(startup > 0); // Queues, lanes and the sink table
+
+    constexpr size_t MESSAGES = 200;
+    const std::string long_text(100, 'x');
+    const size_t before = test::total_allocation_count();
+    {
+        Logger logger("a tag longer than the small string buffer");
+        for (size_t i = 0; i < MESSAGES / 2; ++i) {
+            logger.log(LogLevel::Info, long_text);
+            logger.logf(LogLevel::Warning, "priority {} of {} {}", i, MESSAGES, long_text);
+            if (i % 16 == 15) {
+                TEST_ASSERT_TRUE(sinker.flush(10000));
+            }
+        }
+        TEST_ASSERT_TRUE(sinker.flush(10000));
+    }
+    const size_t allocations = test::total_allocation_count() - before;
+    const auto metrics = sinker.get_metrics();
+    sinker.shutdown();
+
+    TEST_ASSERT_EQUAL(0u, allocations);
+    TEST_ASSERT_TRUE(arena.allocations.load() >= startup + 2 * MESSAGES);
+    TEST_ASSERT_EQUAL(0u, metrics.dropped_count);
+    TEST_ASSERT_EQUAL(MESSAGES, unordered->received.load());
+    TEST_ASSERT_EQUAL(MESSAGES, unordered->from_resource.load());
+    TEST_ASSERT_EQUAL(MESSAGES, ordered->received.load());
+    TEST_ASSERT_EQUAL(MESSAGES, ordered->from_resource.load());
+
+    // Another resource takes over everything, leaving the arena empty
+    sinker.init(SinkerConfig{});
+    TEST_ASSERT_TRUE(sinker.memory_resource() == std::pmr::get_default_resource());
+    sinker.shutdown();
+    sinker.remove_sinker(unordered);
+    sinker.remove_sinker(ordered);
+    TEST_ASSERT_EQUAL(0u, arena.live_bytes.load());
+}
+
+void test_pool_size_classes() {
+    ArenaResource upstream;
+    {
+        PayloadPoolConfig config;
+        config.blocks = {4, 4, 0, 0, 2};
+        config.upstream = &upstream;
+        PayloadPool pool(config);
+        const size_t setup = upstream.allocations.load(); // Slabs and links
+
+        void* small = pool.allocate(20);
+        void* medium = pool.allocate(64);
+        void* empty_class = pool.allocate(100); // No blocks
+        void* oversize = pool.allocate(1000);   // No class
+        void* large[3] = {pool.allocate(300), pool.allocate(512), pool.allocate(400)};
+        TEST_ASSERT_EQUAL(setup + 3, upstream.allocations.load());
+
+        auto stats = pool.stats();
+        TEST_ASSERT_EQUAL(32u, stats.classes[0].block_size);
+        TEST_ASSERT_EQUAL(4u, stats.classes[0].capacity);
+        TEST_ASSERT_EQUAL(1u, stats.classes[0].in_use);
+        TEST_ASSERT_EQUAL(1u, stats.classes[1].in_use);
+        TEST_ASSERT_EQUAL(1u, stats.classes[2].exhausted);
+        TEST_ASSERT_EQUAL(2u, stats.classes[4].in_use);
+        TEST_ASSERT_EQUAL(1u, stats.classes[4].exhausted);
+        TEST_ASSERT_EQUAL(1u, stats.oversize);
+
+        pool.deallocate(small, 20);
+        pool.deallocate(medium, 64);
+        pool.deallocate(empty_class, 100);
+        pool.deallocate(oversize, 1000);
+        pool.deallocate(large[0], 300);
+        pool.deallocate(large[1], 512);
+        pool.deallocate(large[2], 400);
+        stats = pool.stats();
+        for (const auto& cls : stats.classes) {
+            TEST_ASSERT_EQUAL(0u, cls.in_use);
+        }
+        TEST_ASSERT_EQUAL(2u, stats.classes[4].peak_in_use);
+
+        // Freed blocks are reused rather than taken from upstream
+        void* again = pool.allocate(500);
+        TEST_ASSERT_TRUE(again == large[0] || again == large[1]);
+        pool.deallocate(again, 500);
+        TEST_ASSERT_EQUAL(setup + 3, upstream.allocations.load());
+    }
+    TEST_ASSERT_EQUAL(0u, upstream.live_bytes.load());
+}
+
+void test_pool_thread_caches() {
+    // One thread moving between more pools than it keeps blocks for
+    ArenaResource upstream;
+    {
+        PayloadPoolConfig config;
+        config.blocks = {8, 0, 0, 0, 0};
+        config.upstream = &upstream;
+        std::vector<std::unique_ptr<PayloadPool>> pools;
+        for (size_t i = 0; i < PayloadPool::CACHED_POOLS + 1; ++i) {
+            pools.push_back(std::make_unique<PayloadPool>(config));
+        }
+        const size_t setup = upstream.allocations.load();
+
+        for (size_t round = 0; round < 100; ++round) {
+            for (auto& pool : pools) {
+                void* first = pool->allocate(16);
+                void* second = pool->allocate(32);
+                pool->deallocate(first, 16);
+                pool->deallocate(second, 32);
+            }
+        }
+        TEST_ASSERT_EQUAL(setup, upstream.allocations.load());
+        for (auto& pool : pools) {
+            const auto stats = pool->stats();
+            TEST_ASSERT_EQUAL(0u, stats.classes[0].in_use);
+            TEST_ASSERT_EQUAL(0u, stats.classes[0].exhausted);
+        }
+    }
+    TEST_ASSERT_EQUAL(0u, upstream.live_bytes.load());
+
+    // Caches left by destroyed pools are taken over
+    PayloadPoolConfig config;
+    config.upstream = &upstream;
+    PayloadPool pool(config);
+    void* block = pool.allocate(16);
+    pool.deallocate(block, 16);
+    TEST_ASSERT_EQUAL(0u, pool.stats().classes[0].exhausted);
+}
+
+void test_pool_serves_pipeline() {
+    ArenaResource upstream;
+    auto& sinker = Sinker::instance();
+    {
+        PayloadPoolConfig config;
+        config.upstream = &upstream;
+        PayloadPool pool(config);
+        auto unordered = std::make_shared<ResourceSink>(&pool, false);
+        auto ordered = std::make_shared<ResourceSink>(&pool, true);
+        DefaultResourceGuard guard({unordered, ordered});
+        sinker.add_sinker(unordered);
+        sinker.add_sinker(ordered);
+
+        SinkerConfig sinker_config;
+        sinker_config.worker_count = 2;
+        sinker_config.memory_resource = &pool;
+        sinker.init(sinker_config);
+        TEST_ASSERT_TRUE(sinker.is_running());
+
+        // Producers allocate, the workers free. Each round fits the priority
+        // queue even if no Warning is dispatched before the round ends.
+        constexpr size_t THREADS = 4;
+        constexpr size_t PER_THREAD = 100;
+        const size_t warnings_per_round = sinker.get_metrics().priority_capacity / THREADS;
+        const std::string long_text(100, 'x');
+        for (size_t round = 0; round * warnings_per_round < PER_THREAD / 2; ++round) {
+            std::vector<std::thread> producers;
+            for (size_t t = 0; t < THREADS; ++t) {
+                producers.emplace_back([&, round] {
+                    Logger logger("a tag longer than the small string buffer");
+                    const size_t first = round * warnings_per_round;
+                    const size_t last = std::min(first + warnings_per_round, PER_THREAD / 2);
+                    for (size_t i = first; i < last; ++i) {
+                        logger.log(LogLevel::Info, long_text);
+                        logger.logf(LogLevel::Warning, "priority {} {}", i, long_text);
+                    }
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+            TEST_ASSERT_TRUE(sinker.flush(10000));
+        }
+        TEST_ASSERT_TRUE(sinker.flush(10000));
+        const auto metrics = sinker.get_metrics();
+        sinker.shutdown();
+
+        TEST_ASSERT_EQUAL(0u, metrics.dropped_count);
+        TEST_ASSERT_EQUAL(THREADS * PER_THREAD, unordered->from_resource.load());
+        TEST_ASSERT_EQUAL(THREADS * PER_THREAD, ordered->from_resource.load());
+        auto stats = pool.stats();
+        TEST_ASSERT_TRUE(stats.classes[1].peak_in_use > 0); // Tags
+        TEST_ASSERT_TRUE(stats.classes[2].peak_in_use > 0); // Text
+
+        // Nothing is left in use once the pipeline moves off the pool
+        sinker.init(SinkerConfig{});
+        sinker.shutdown();
+        sinker.remove_sinker(unordered);
+        sinker.remove_sinker(ordered);
+        stats = pool.stats();
+        for (const auto& cls : stats.classes) {
+            TEST_ASSERT_EQUAL(0u, cls.in_use);
+        }
+    }
+    TEST_ASSERT_EQUAL(0u, upstream.live_bytes.load());
+}
+
+int main() {
+    printf("Starting loggable pmr tests...\n");
+
+    os::set_backend(&test::StdBackend::instance());
+    Sinker::instance().set_level(LogLevel::Info);
+
+    RUN_TEST(test_pmr_sync_uses_default_resource);
+    RUN_TEST(test_pmr_pipeline_allocates_from_resource);
+    RUN_TEST(test_pool_size_classes);
+    RUN_TEST(test_pool_thread_caches);
+    RUN_TEST(test_pool_serves_pipeline);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,587 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "loggable.hpp"
+#include "loggable_ringbuffer.hpp"
+#include "sim_backend.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+// Exact-count regression tests on the simulated backend. The expected
+// numbers are the engine's current cost model: when a change moves them,
+// update them deliberately and say why in the commit.
+
+namespace {
+
+// Constructed before the Sinker singleton so that it outlives the queue,
+// which keeps its semaphore across shutdown(). The main thread is the driver.
+test::SimBackend g_sim_backend;
+test::SimBackend* const g_sim = &g_sim_backend;
+
+/**
+ * @brief Records delivery count and worst queue latency in virtual ms.
+ */
+class LatencySink : public ISink {
+public:
+    void consume(const LogMessage& msg) override {
+        if (cost_ms > 0) {
+            g_sim->spend(cost_ms);
+        }
+        const auto sent = std::chrono::duration_cast<std::chrono::milliseconds>(
+            msg.get_timestamp().time_since_epoch()).count();
+        const auto latency = static_cast<uint64_t>(g_sim->get_time_ms() - sent);
+        max_latency_ms = std::max(max_latency_ms, latency);
+        last_message = msg.get_message();
+        ++received;
+    }
+
+    uint32_t cost_ms{0};
+    uint64_t max_latency_ms{0};
+    size_t received{0};
+    std::string last_message;
+};
+
+std::shared_ptr<LatencySink> g_sink;
+
+constexpr os::Capabilities ALL_CAPABILITIES{
+    .counting_semaphore = true, .task_notify = true, .event_group = true};
+
+struct RingBufferFixture {
+    RingBuffer<int, 8> buffer{g_sim};
+    int expected{0};
+    int received{0};
+};
+
+void ring_consumer(void* arg) {
+    auto* fixture = static_cast<RingBufferFixture*>(arg);
+    fixture->buffer.bind_consumer(g_sim->task_current());
+    while (fixture->received < fixture->expected) {
+        if (fixture->buffer.pop(os::WAIT_FOREVER)) {
+            ++fixture->received;
+        }
+    }
+    g_sim->task_delete(os::TaskHandle{});
+}
+
+/// Two bursts of three pushes against a parked consumer.
+void run_ring_bursts(os::Capabilities caps, test::SimBackend::Counters& out) {
+    g_sim->set_capabilities(caps);
+    auto fixture = std::make_unique<RingBufferFixture>();
+    fixture->expected = 6;
+    g_sim->reset_counters();
+    auto task = g_sim->task_create(os::TaskConfig{}, &ring_consumer, fixture.get());
+    TEST_ASSERT_TRUE(static_cast<bool>(task));
+
+    g_sim->run_until_idle(); // Consumer parks on the empty buffer
+    for (int burst = 0; burst < 2; ++burst) {
+        for (int i = 0; i < 3; ++i) {
+            fixture->buffer.push(i);
+        }
+        g_sim->run_until_idle();
+    }
+    out = g_sim->counters();
+    g_sim->set_capabilities(ALL_CAPABILITIES);
+    TEST_ASSERT_EQUAL(6, fixture->received);
+}
+
+void reset(uint32_t sink_cost_ms = 0) {
+    g_sink->cost_ms = sink_cost_ms;
+    g_sink->max_latency_ms = 0;
+    g_sink->received = 0;
+    g_sim->reset_counters();
+}
+
+} // namespace
+
+void test_sim_ringbuffer_binary_signaling() {
+    test::SimBackend::Counters c;
+    run_ring_bursts(os::Capabilities{}, c);
+    TEST_ASSERT_EQUAL(8u, c.semaphore_gives); // Every push, plus a re-give per woken burst
+    TEST_ASSERT_EQUAL(3u, c.semaphore_takes);  // Includes one stale unit after the first burst
+    TEST_ASSERT_EQUAL(2u, c.blocking_waits);
+    TEST_ASSERT_EQUAL(2u, c.task_wakeups);
+}
+
+void test_sim_ringbuffer_counting_signaling() {
+    test::SimBackend::Counters c;
+    run_ring_bursts(os::Capabilities{.counting_semaphore = true}, c);
+    TEST_ASSERT_EQUAL(6u, c.semaphore_gives); // One unit per item, no re-gives
+    TEST_ASSERT_EQUAL(6u, c.semaphore_takes);
+    TEST_ASSERT_EQUAL(2u, c.blocking_waits);
+    TEST_ASSERT_EQUAL(2u, c.task_wakeups);
+}
+
+void test_sim_ringbuffer_notify_signaling() {
+    test::SimBackend::Counters c;
+    run_ring_bursts(ALL_CAPABILITIES, c);
+    TEST_ASSERT_EQUAL(0u, c.semaphore_gives);
+    TEST_ASSERT_EQUAL(2u, c.task_notifies); // Only the empty -> non-empty pushes
+    TEST_ASSERT_EQUAL(2u, c.notify_waits);
+    TEST_ASSERT_EQUAL(2u, c.blocking_waits);
+    TEST_ASSERT_EQUAL(2u, c.task_wakeups);
+}
+
+void test_sim_async_delivery_and_latency() {
+    reset(/*sink_cost_ms=*/3);
+    auto& sinker = Sinker::instance();
+    sinker.init();
+
+    Logger logger("sim");
+    for (int i = 0; i < 5; ++i) {
+        logger.log(LogLevel::Info, "tick");
+    }
+    const bool flushed = sinker.flush(1000);
+    const auto c = g_sim->counters();
+    sinker.shutdown();
+
+    TEST_ASSERT_TRUE(flushed);
+    TEST_ASSERT_EQUAL(5u, g_sink->received);
+    TEST_ASSERT_EQUAL(15u, g_sink->max_latency_ms); // Fifth message lands after five 3 ms writes
+    TEST_ASSERT_EQUAL(5u, c.semaphore_gives); // Queued before the worker bound itself
+    TEST_ASSERT_EQUAL(1u, c.task_notifies);   // Those wakeups carried over on binding
+    TEST_ASSERT_EQUAL(1u, c.event_sets);      // flush() wakes exactly when the queue drains
+    TEST_ASSERT_EQUAL(1u, c.event_waits);
+    TEST_ASSERT_EQUAL(0u, c.delays);
+}
+
+void test_sim_idle_wakeups() {
+    auto& sinker = Sinker::instance();
+    sinker.init();
+    g_sim->run_until_idle();
+    reset();
+
+    g_sim->advance(1050);
+    const auto c = g_sim->counters();
+    sinker.shutdown();
+
+    TEST_ASSERT_EQUAL(0u, c.task_wakeups); // The worker sleeps until signaled
+    TEST_ASSERT_EQUAL(0u, c.notify_waits);
+    TEST_ASSERT_EQUAL(0u, c.wait_timeouts);
+}
+
+void test_sim_drop_report_wakeups() {
+    auto& sinker = Sinker::instance();
+    sinker.init();
+    g_sim->run_until_idle();
+    reset();
+
+    // Two overflowing bursts 100 ms apart: the second report is deferred
+    // to the end of the interval, then the worker sleeps again
+    Logger logger("sim");
+    for (int burst = 0; burst < 2; ++burst) {
+        for (int i = 0; i < 130; ++i) {
+            logger.log(LogLevel::Info, "flood");
+        }
+        g_sim->advance(100);
+    }
+    g_sim->advance(10000);
+    const auto c = g_sim->counters();
+    sinker.shutdown();
+
+    TEST_ASSERT_EQUAL(256u, g_sink->received);
+    TEST_ASSERT_EQUAL(3u, c.task_wakeups); // Two bursts and one report timer
+    TEST_ASSERT_EQUAL(1u, c.wait_timeouts);
+}
+
+void test_sim_worker_pool_overlaps_sinks() {
+    // Sinks that block on I/O: with one worker their waits add up, with
+    // one worker per sink they overlap
+    class BlockingSink : public ISink {
+    public:
+        void consume(const LogMessage& /*msg*/) override {
+            g_sim->delay_ms(3);
+            ++received;
+        }
+        size_t received{0};
+    };
+
+    auto& sinker = Sinker::instance();
+    sinker.remove_sinker(g_sink);
+    auto first = std::make_shared<BlockingSink>();
+    auto second = std::make_shared<BlockingSink>();
+    sinker.add_sinker(first);
+    sinker.add_sinker(second);
+
+    uint64_t elapsed[2]{};
+    for (size_t workers = 1; workers <= 2; ++workers) {
+        SinkerConfig config;
+        config.worker_count = workers;
+        sinker.init(config);
+        TEST_ASSERT_EQUAL(workers, sinker.get_metrics().worker_count);
+
+        Logger logger("sim");
+        const uint64_t start = g_sim->now();
+        for (int i = 0; i < 5; ++i) {
+            logger.log(LogLevel::Info, "io");
+        }
+        TEST_ASSERT_TRUE(sinker.flush(1000));
+        elapsed[workers - 1] = g_sim->now() - start;
+        sinker.shutdown();
+    }
+
+    sinker.remove_sinker(first);
+    sinker.remove_sinker(second);
+    sinker.add_sinker(g_sink);
+
+    TEST_ASSERT_EQUAL(10u, first->received);
+    TEST_ASSERT_EQUAL(10u, second->received);
+    TEST_ASSERT_EQUAL(30u, elapsed[0]); // 5 messages x 2 sinks x 3 ms, serialized
+    TEST_ASSERT_EQUAL(15u, elapsed[1]);
+}
+
+void test_sim_priority_lane() {
+    class RecordingSink : public ISink {
+    public:
+        explicit RecordingSink(bool ordered) : _ordered(ordered) {}
+        void consume(const LogMessage& msg) override {
+            g_sim->spend(3);
+            levels.push_back(msg.get_level());
+            if (msg.get_level() == LogLevel::Error) {
+                error_at_ms = g_sim->now();
+            }
+        }
+        bool requires_ordering() const noexcept override { return _ordered; }
+
+        std::vector<LogLevel> levels;
+        uint64_t error_at_ms{0};
+
+    private:
+        bool _ordered;
+    };
+
+    auto& sinker = Sinker::instance();
+    sinker.remove_sinker(g_sink);
+    auto fast = std::make_shared<RecordingSink>(false);
+    auto ordered = std::make_shared<RecordingSink>(true);
+    sinker.add_sinker(fast);
+    sinker.add_sinker(ordered);
+    sinker.init();
+
+    // The worker has not run yet: ten Info lines are queued ahead of the error
+    Logger logger("sim");
+    const uint64_t start = g_sim->now();
+    for (int i = 0; i < 10; ++i) {
+        logger.log(LogLevel::Info, "chatter");
+    }
+    logger.log(LogLevel::Error, "fault");
+    const auto queued = sinker.get_metrics();
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    sinker.shutdown();
+
+    sinker.remove_sinker(fast);
+    sinker.remove_sinker(ordered);
+    sinker.add_sinker(g_sink);
+
+    TEST_ASSERT_EQUAL(1u, queued.priority_queued_count);
+    TEST_ASSERT_EQUAL(10u, queued.queued_count);
+    TEST_ASSERT_EQUAL(11u, fast->levels.size());
+    TEST_ASSERT_EQUAL(11u, ordered->levels.size());
+    TEST_ASSERT_TRUE(fast->levels.front() == LogLevel::Error);
+    TEST_ASSERT_TRUE(ordered->levels.back() == LogLevel::Error);
+    TEST_ASSERT_EQUAL(3u, fast->error_at_ms - start); // Ahead of 60 ms of backlog
+    TEST_ASSERT_EQUAL(66u, ordered->error_at_ms - start);
+}
+
+void test_sim_adaptive_level() {
+    reset(/*sink_cost_ms=*/1);
+    auto& sinker = Sinker::instance();
+    sinker.set_level(LogLevel::Debug);
+    SinkerConfig config;
+    config.adaptive_level = true;
+    config.high_watermark = 8;
+    config.low_watermark = 2;
+    sinker.init(config);
+
+    // The worker has not run yet, so Debug lines pile up until shedding
+    Logger logger("sim");
+    for (int i = 0; i < 20; ++i) {
+        logger.log(LogLevel::Debug, "chatter");
+    }
+    const auto pressured = sinker.get_metrics();
+    logger.log(LogLevel::Info, "still accepted");
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    const auto relieved = sinker.get_metrics();
+    logger.log(LogLevel::Debug, "accepted again");
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    sinker.shutdown();
+    sinker.set_level(LogLevel::Info);
+
+    TEST_ASSERT_TRUE(pressured.level_shedding);
+    TEST_ASSERT_EQUAL(1u, pressured.level_shed_count);
+    TEST_ASSERT_FALSE(relieved.level_shedding);
+    TEST_ASSERT_EQUAL(0u, relieved.dropped_count - pressured.dropped_count);
+    TEST_ASSERT_EQUAL(10u, g_sink->received); // Eight Debug, the Info, the later Debug
+}
+
+void test_sim_window_metrics() {
+    reset(/*sink_cost_ms=*/3);
+    auto& sinker = Sinker::instance();
+    SinkerConfig config;
+    config.high_watermark = 8;
+    sinker.init(config);
+    g_sim->run_until_idle();
+    (void)sinker.reset_metrics();
+
+    // Ten messages at once, then 70 ms idle: 30 ms of sink work in a 100 ms window
+    Logger logger("sim");
+    for (int i = 0; i < 10; ++i) {
+        logger.log(LogLevel::Info, "tick");
+    }
+    g_sim->advance(100);
+    const auto first = sinker.reset_metrics();
+    g_sim->advance(100);
+    const Sinker& observer = sinker; // Readable through a const reference
+    const auto second = observer.get_metrics();
+    sinker.shutdown();
+
+    TEST_ASSERT_EQUAL(100u, first.window_ms);
+    TEST_ASSERT_EQUAL(10u, first.pending_high_watermark);
+    TEST_ASSERT_EQUAL(9u, first.time_above_high_ms); // Until the third delivery
+    TEST_ASSERT_TRUE(first.worker_busy_ratio > 0.29f && first.worker_busy_ratio < 0.31f);
+    TEST_ASSERT_TRUE(first.messages_per_second > 0.0f);
+
+    // The read reset the window; the rate keeps decaying across it
+    TEST_ASSERT_EQUAL(100u, second.window_ms);
+    TEST_ASSERT_EQUAL(0u, second.pending_high_watermark);
+    TEST_ASSERT_EQUAL(0u, second.time_above_high_ms);
+    TEST_ASSERT_TRUE(second.worker_busy_ratio == 0.0f);
+    TEST_ASSERT_TRUE(second.messages_per_second < first.messages_per_second);
+}
+
+void test_sim_spill_overflow() {
+    class SequenceSink : public ISink {
+    public:
+        void consume(const LogMessage& msg) override {
+            g_sim->spend(1);
+            if (std::stoi(std::string(msg.get_message_view())) != next++) {
+                ++out_of_order;
+            }
+        }
+        int next{0};
+        size_t out_of_order{0};
+    };
+
+    auto& sinker = Sinker::instance();
+    sinker.remove_sinker(g_sink);
+    auto sink = std::make_shared<SequenceSink>();
+    sinker.add_sinker(sink);
+    Logger logger("sim");
+
+    // Producer policy: 300 messages before the worker runs, 128 slots
+    SinkerConfig config;
+    config.spill_store = std::make_shared<FileSpillStore>("loggable_spill_sim.bin", 64 * 1024);
+    sinker.init(config);
+    const size_t dropped_before = sinker.get_metrics().dropped_count;
+    for (int i = 0; i < 300; ++i) {
+        logger.logf(LogLevel::Info, "{}", i);
+    }
+    const auto pressured = sinker.get_metrics();
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    const auto producer = sinker.get_metrics();
+    sinker.shutdown();
+    const int producer_received = sink->next;
+    const size_t producer_out_of_order = sink->out_of_order;
+
+    // Worker policy: 120 queued, above the high watermark of 96
+    sink->next = 0;
+    config.spill_policy = SpillPolicy::Worker;
+    config.spill_store = std::make_shared<FileSpillStore>("loggable_spill_sim.bin", 64 * 1024);
+    sinker.init(config);
+    for (int i = 0; i < 120; ++i) {
+        logger.logf(LogLevel::Info, "{}", i);
+    }
+    TEST_ASSERT_TRUE(sinker.flush(10000));
+    const auto worker = sinker.get_metrics();
+    sinker.shutdown();
+    sinker.init(); // Releases the spill store
+    sinker.shutdown();
+
+    sinker.remove_sinker(sink);
+    sinker.add_sinker(g_sink);
+
+    TEST_ASSERT_EQUAL(172u, pressured.spill_pending_count); // Every eviction
+    TEST_ASSERT_EQUAL(128u, pressured.queued_count);
+    TEST_ASSERT_EQUAL(0u, producer.dropped_count - dropped_before);
+    TEST_ASSERT_EQUAL(300u, producer.spilled_count); // The queue lines up behind the spill
+    TEST_ASSERT_EQUAL(0u, producer.spill_pending_count);
+    TEST_ASSERT_EQUAL(300, producer_received);
+    TEST_ASSERT_EQUAL(0u, producer_out_of_order);
+
+    TEST_ASSERT_EQUAL(0u, worker.dropped_count - dropped_before);
+    TEST_ASSERT_EQUAL(420u, worker.spilled_count);
+    TEST_ASSERT_EQUAL(120, sink->next);
+    TEST_ASSERT_EQUAL(0u, sink->out_of_order);
+}
+
+void test_sim_slow_sink_breaker() {
+    reset(/*sink_cost_ms=*/10);
+    auto& sinker = Sinker::instance();
+    auto fast = std::make_shared<LatencySink>();
+    sinker.add_sinker(fast);
+    SinkerConfig config;
+    config.slow_sink_us = 5000;
+    config.slow_sink_trips = 3;
+    config.sink_probe_ms = 100;
+    sinker.init(config);
+
+    // Three slow deliveries trip the breaker; the fast sink then stops
+    // waiting behind the slow one
+    Logger logger("sim");
+    for (int i = 0; i < 20; ++i) {
+        logger.log(LogLevel::Info, "burst");
+    }
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    const auto tripped = sinker.get_metrics();
+    TEST_ASSERT_EQUAL(3u, g_sink->received);
+    TEST_ASSERT_EQUAL(20u, fast->received);
+    TEST_ASSERT_EQUAL(30u, fast->max_latency_ms); // Not 200
+    TEST_ASSERT_EQUAL(1u, tripped.bypassed_sinks);
+    TEST_ASSERT_EQUAL(17u, tripped.sink_bypassed_count);
+    TEST_ASSERT_EQUAL(1u, tripped.sink_trip_count);
+
+    // A slow probe after the bypass period doubles it
+    g_sim->advance(110);
+    logger.log(LogLevel::Info, "probe");
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    TEST_ASSERT_EQUAL(4u, g_sink->received);
+    g_sim->advance(110);
+    logger.log(LogLevel::Info, "still bypassed");
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    TEST_ASSERT_EQUAL(4u, g_sink->received);
+
+    // A fast probe restores the sink
+    g_sink->cost_ms = 0;
+    g_sim->advance(110);
+    logger.log(LogLevel::Info, "recovered");
+    logger.log(LogLevel::Info, "delivered");
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    const auto recovered = sinker.get_metrics();
+    sinker.shutdown();
+    sinker.remove_sinker(fast);
+
+    TEST_ASSERT_EQUAL(6u, g_sink->received);
+    TEST_ASSERT_EQUAL(24u, fast->received);
+    TEST_ASSERT_EQUAL(0u, recovered.bypassed_sinks);
+    TEST_ASSERT_EQUAL(18u, recovered.sink_bypassed_count);
+    TEST_ASSERT_EQUAL(1u, recovered.sink_trip_count);
+}
+
+void test_sim_timing_spans() {
+#if LOGGABLE_SPAN_LEVEL < 4
+    // Debug spans compiled out
+    static_assert(std::is_same_v<Logger::SpanFor<LogLevel::Debug>, Logger::NullSpan>);
+    static_assert(std::is_empty_v<Logger::NullSpan>);
+#else
+    reset();
+    auto& sinker = Sinker::instance();
+    sinker.set_level(LogLevel::Debug);
+    sinker.init();
+
+    const Logger logger("sim");
+    {
+        auto span = logger.span("work");
+        g_sim->advance(7);
+        TEST_ASSERT_EQUAL(7000u, span.elapsed_us());
+    }
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    TEST_ASSERT_EQUAL(1u, g_sink->received);
+    TEST_ASSERT_EQUAL_STRING("work: 7000 us", g_sink->last_message.c_str());
+
+    // Only durations at or above the threshold are logged
+    {
+        auto quick = logger.span<LogLevel::Info>("quick", 5000);
+        g_sim->advance(2);
+    }
+    {
+        auto slow = logger.span<LogLevel::Info>("slow", 5000);
+        g_sim->advance(5);
+    }
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    TEST_ASSERT_EQUAL(2u, g_sink->received);
+    TEST_ASSERT_EQUAL_STRING("slow: 5000 us", g_sink->last_message.c_str());
+
+    // Ended early, cancelled, moved, or disabled when started
+    {
+        auto early = logger.span("early");
+        g_sim->advance(1);
+        early.end();
+        g_sim->advance(10);
+        early.end();
+
+        auto cancelled = logger.span("cancelled");
+        cancelled.cancel();
+
+        auto moved = logger.span("moved");
+        g_sim->advance(3);
+        auto target = std::move(moved);
+        TEST_ASSERT_EQUAL(0u, moved.elapsed_us());
+        TEST_ASSERT_EQUAL(3000u, target.elapsed_us());
+    }
+    sinker.set_level(LogLevel::Info);
+    {
+        auto disabled = logger.span<LogLevel::Debug>("disabled");
+        TEST_ASSERT_EQUAL(0u, disabled.elapsed_us());
+        sinker.set_level(LogLevel::Debug); // Too late: it never started timing
+        g_sim->advance(1);
+    }
+    TEST_ASSERT_TRUE(sinker.flush(1000));
+    sinker.shutdown();
+    sinker.set_level(LogLevel::Info);
+
+    TEST_ASSERT_EQUAL(4u, g_sink->received);
+    TEST_ASSERT_EQUAL_STRING("moved: 3000 us", g_sink->last_message.c_str());
+    static_assert(std::is_same_v<Logger::SpanFor<LogLevel::Debug>, Logger::Span>);
+#endif
+}
+
+void test_sim_shutdown_cost() {
+    auto& sinker = Sinker::instance();
+    sinker.init();
+    Logger logger("sim");
+    logger.log(LogLevel::Info, "last words");
+    reset();
+
+    const uint64_t start = g_sim->now();
+    sinker.shutdown();
+    const auto c = g_sim->counters();
+
+    TEST_ASSERT_FALSE(sinker.is_running());
+    TEST_ASSERT_EQUAL(1u, g_sink->received);
+    TEST_ASSERT_EQUAL(0u, g_sim->now() - start); // No flush() polling interval
+    TEST_ASSERT_EQUAL(1u, c.semaphores_destroyed);
+    TEST_ASSERT_EQUAL(3u, c.semaphore_gives); // Two wake signals and the worker's exit
+    TEST_ASSERT_EQUAL(1u, c.blocking_waits);  // Only the flush() event wait
+}
+
+int main() {
+    printf("Starting loggable simulated-backend tests...\n");
+
+    os::set_backend(g_sim);
+    g_sink = std::make_shared<LatencySink>();
+    Sinker::instance().add_sinker(g_sink);
+    Sinker::instance().set_level(LogLevel::Info);
+
+    RUN_TEST(test_sim_ringbuffer_binary_signaling);
+    RUN_TEST(test_sim_ringbuffer_counting_signaling);
+    RUN_TEST(test_sim_ringbuffer_notify_signaling);
+    RUN_TEST(test_sim_async_delivery_and_latency);
+    RUN_TEST(test_sim_idle_wakeups);
+    RUN_TEST(test_sim_drop_report_wakeups);
+    RUN_TEST(test_sim_worker_pool_overlaps_sinks);
+    RUN_TEST(test_sim_priority_lane);
+    RUN_TEST(test_sim_adaptive_level);
+    RUN_TEST(test_sim_window_metrics);
+    RUN_TEST(test_sim_spill_overflow);
+    RUN_TEST(test_sim_slow_sink_breaker);
+    RUN_TEST(test_sim_timing_spans);
+    RUN_TEST(test_sim_shutdown_cost);
+
+    Sinker::instance().remove_sinker(g_sink);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,653 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "loggable_block.hpp"
+#include "loggable_lz.hpp"
+#include "loggable_query.hpp"
+#include "loggable_record.hpp"
+#include "loggable_serial.hpp"
+#include "loggable_spill.hpp"
+#include "test_support.hpp"
+
+using namespace loggable;
+
+// Binary log formats: record codec, LZ codec, block files and queries on
+// them, and serial framing, all driven synchronously through the sinks'
+// consume().
+
+namespace {
+
+constexpr const char* BLOCK_FILE = "loggable_storage_test.lgbk";
+
+void remove_log(const char* path) {
+    std::remove(path);
+    std::remove(block::index_path(path).c_str());
+}
+
+std::vector<uint8_t> read_file(const std::string& path) {
+    std::vector<uint8_t> contents;
+    if (std::FILE* file = std::fopen(path.c_str(), "rb")) {
+        contents.resize(1 << 20);
+        contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+        std::fclose(file);
+    }
+    return contents;
+}
+
+void write_file(const std::string& path, const uint8_t* data, size_t size) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(data, 1, size, file);
+    std::fclose(file);
+}
+
+LogMessage make_message(int64_t ms, LogLevel level, std::string_view tag, std::string_view text) {
+    return LogMessage(std::chrono::system_clock::time_point(std::chrono::milliseconds(ms)),
+                      level, LogMessage::Tag(tag), LogMessage::Text(text));
+}
+
+/// Gateway-style log traffic: a few tags and templates with varying fields.
+LogMessage typical_message(int i) {
+    static const char* const TAGS[] = {"wifi", "mqtt", "sensor", "ota", "http"};
+    const int64_t ms = 1'700'000'000'000 + i * 37;
+    switch (i % 5) {
+    case 0:
+        return make_message(ms, LogLevel::Info, TAGS[0], "rssi=-" + std::to_string(40 + i % 30) + " dBm channel=6 bssid=a4:cf:12:9b:3e:01");
+    case 1:
+        return make_message(ms, LogLevel::Debug, TAGS[1], "publish topic=gw/" + std::to_string(i % 16) + "/telemetry qos=1 len=" + std::to_string(100 + i % 90));
+    case 2:
+        return make_message(ms, LogLevel::Info, TAGS[2], "temperature=" + std::to_string(20 + i % 7) + "." + std::to_string(i % 10) + "C humidity=" + std::to_string(40 + i % 20) + "%");
+    case 3:
+        return make_message(ms, LogLevel::Warning, TAGS[3], "chunk " + std::to_string(i) + " retry after timeout");
+    default:
+        return make_message(ms, LogLevel::Verbose, TAGS[4], "GET /api/v1/status 200 " + std::to_string(i % 50) + "ms");
+    }
+}
+
+std::vector<uint8_t> bytes_of(const std::string& text) {
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+bool lz_roundtrips(const std::vector<uint8_t>& input) {
+    lz::CompressState state;
+    std::vector<uint8_t> compressed(lz::compress_bound(input.size()));
+    const size_t size = lz::compress(input.data(), input.size(), compressed.data(),
+                                     compressed.size(), state);
+    if (size == 0) {
+        return false;
+    }
+    std::vector<uint8_t> output(input.size());
+    const size_t restored = lz::decompress(compressed.data(), size, output.data(), output.size());
+    return (restored == input.size() || input.empty()) && output == input;
+}
+
+struct ReadBack {
+    size_t blocks{0};
+    size_t damaged{0};
+    std::vector<std::string> lines;
+    std::vector<int64_t> timestamps;
+};
+
+ReadBack read_back(const char* path) {
+    ReadBack result;
+    BlockFileReader reader(path);
+    block::BlockHeader header;
+    std::vector<uint8_t> raw;
+    while (reader.next(header)) {
+        if (!reader.read_payload(header, raw)) {
+            ++result.damaged;
+            continue;
+        }
+        ++result.blocks;
+        (void)block::for_each_record(header, raw, [&](const record::RecordView& view) {
+            result.lines.push_back(std::string(view.tag) + ":" + std::string(view.message));
+            result.timestamps.push_back(view.timestamp_ms);
+        });
+    }
+    return result;
+}
+
+} // namespace
+
+void test_crc32_check_value() {
+    const auto digits = bytes_of("123456789");
+    TEST_ASSERT_EQUAL(0xCBF43926u, record::crc32(digits.data(), digits.size()));
+    // Chunked input continues the same checksum
+    const uint32_t head = record::crc32(digits.data(), 4);
+    TEST_ASSERT_EQUAL(0xCBF43926u, record::crc32(digits.data() + 4, 5, head));
+}
+
+void test_record_roundtrip() {
+    const auto original = make_message(-5, LogLevel::Warning, std::string(300, 't'), "hello");
+    std::vector<uint8_t> encoded;
+    const size_t size = record::encode(original, encoded);
+    TEST_ASSERT_EQUAL(record::encoded_size(original), size);
+    const size_t tag_size = std::min<size_t>(original.get_tag().size(), 255);
+    TEST_ASSERT_EQUAL(record::HEADER_SIZE + tag_size + 5, size); // Tag truncated
+
+    LogMessage decoded;
+    TEST_ASSERT_EQUAL(size, record::decode(encoded.data(), encoded.size(), decoded));
+    TEST_ASSERT_TRUE(decoded.get_timestamp() == original.get_timestamp());
+    TEST_ASSERT_TRUE(decoded.get_level() == LogLevel::Warning);
+    TEST_ASSERT_EQUAL(tag_size, decoded.get_tag().size());
+    TEST_ASSERT_EQUAL_STRING("hello", decoded.get_message().c_str());
+
+    // A truncated record is rejected rather than misread
+    TEST_ASSERT_EQUAL(0u, record::decode(encoded.data(), encoded.size() - 1, decoded));
+
+    // A size limit cuts the text first, then the tag
+    encoded.clear();
+    const size_t limit = record::HEADER_SIZE + 20;
+    TEST_ASSERT_EQUAL(limit, record::encode(original, encoded, limit));
+    TEST_ASSERT_EQUAL(limit, record::decode(encoded.data(), encoded.size(), decoded));
+    TEST_ASSERT_EQUAL(20u, decoded.get_tag().size());
+    TEST_ASSERT_TRUE(decoded.get_message().empty());
+    encoded.clear();
+    const auto long_text = make_message(0, LogLevel::Info, "tag", std::string(500, 'x'));
+    TEST_ASSERT_EQUAL(64u, record::encode(long_text, encoded, 64));
+    TEST_ASSERT_EQUAL(64u, record::decode(encoded.data(), encoded.size(), decoded));
+    TEST_ASSERT_EQUAL_STRING("tag", decoded.get_tag().c_str());
+    TEST_ASSERT_EQUAL(49u, decoded.get_message().size());
+
+    // Static text is encoded like owned text and decodes as owned text
+    encoded.clear();
+    const LogMessage fixed(original.get_timestamp(), LogLevel::Info, "tag", StaticText("fixed"));
+    TEST_ASSERT_EQUAL(record::encoded_size(fixed), record::encode(fixed, encoded));
+    TEST_ASSERT_TRUE(record::decode(encoded.data(), encoded.size(), decoded) > 0);
+    TEST_ASSERT_FALSE(decoded.has_static_text());
+    TEST_ASSERT_EQUAL_STRING("fixed", decoded.get_message().c_str());
+}
+
+void test_spill_store_drops_corrupt_records() {
+    constexpr const char* SPILL_FILE = "loggable_spill_store_test.bin";
+    FileSpillStore store(SPILL_FILE, 1024);
+    TEST_ASSERT_TRUE(store.is_open());
+    const uint8_t first[] = {1, 2, 3};
+    const uint8_t second[] = {4, 5};
+    TEST_ASSERT_TRUE(store.append(first, sizeof(first)));
+    TEST_ASSERT_TRUE(store.append(second, sizeof(second))); // Flushes the first
+
+    // A length far past the end of the data, as from a bad flash sector
+    if (std::FILE* file = std::fopen(SPILL_FILE, "r+b")) {
+        const uint8_t garbage[] = {0xff, 0xff, 0xff, 0x7f};
+        std::fwrite(garbage, 1, sizeof(garbage), file);
+        std::fclose(file);
+    }
+    std::vector<uint8_t> record;
+    TEST_ASSERT_FALSE(store.read(record));
+    TEST_ASSERT_TRUE(record.empty());
+    TEST_ASSERT_EQUAL(0u, store.size_bytes()); // Nothing after it can be found
+    TEST_ASSERT_FALSE(store.read(record));
+
+    // Usable again afterwards
+    TEST_ASSERT_TRUE(store.append(second, sizeof(second)));
+    TEST_ASSERT_TRUE(store.read(record));
+    TEST_ASSERT_EQUAL(2u, record.size());
+    TEST_ASSERT_EQUAL(0u, store.size_bytes());
+}
+
+void test_lz_roundtrip() {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> random(5000);
+    for (auto& byte : random) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    std::vector<uint8_t> runs(70000, 'a'); // Offsets and lengths past 16 bits of literals
+    for (size_t i = 0; i < runs.size(); i += 1000) {
+        runs[i] = 'b';
+    }
+    std::vector<uint8_t> text;
+    for (int i = 0; i < 500; ++i) {
+        (void)record::encode(typical_message(i), text);
+    }
+
+    for (size_t size = 0; size <= 20; ++size) {
+        TEST_ASSERT_TRUE(lz_roundtrips(std::vector<uint8_t>(random.begin(), random.begin() + size)));
+    }
+    TEST_ASSERT_TRUE(lz_roundtrips(random));
+    TEST_ASSERT_TRUE(lz_roundtrips(runs));
+    TEST_ASSERT_TRUE(lz_roundtrips(text));
+
+    // Every truncation of a valid stream fails cleanly
+    lz::CompressState state;
+    std::vector<uint8_t> compressed(lz::compress_bound(text.size()));
+    const size_t size = lz::compress(text.data(), text.size(), compressed.data(),
+                                     compressed.size(), state);
+    std::vector<uint8_t> output(text.size());
+    for (size_t cut = 0; cut < size; ++cut) {
+        TEST_ASSERT_TRUE(lz::decompress(compressed.data(), cut, output.data(), output.size()) < text.size());
+    }
+    // Too small an output buffer is an error, not an overflow
+    TEST_ASSERT_EQUAL(0u, lz::decompress(compressed.data(), size, output.data(), output.size() - 1));
+}
+
+void test_block_sink_roundtrip() {
+    remove_log(BLOCK_FILE);
+    constexpr int COUNT = 5000;
+    BlockFileSink::Stats stats;
+    {
+        BlockFileSink sink(BLOCK_FILE);
+        TEST_ASSERT_TRUE(sink.is_open());
+        for (int i = 0; i < COUNT; ++i) {
+            sink.consume(typical_message(i));
+        }
+        // Producers stamp messages before queueing, so time can step back
+        sink.consume(make_message(1'000, LogLevel::Error, "late", "stamped early"));
+        TEST_ASSERT_TRUE(sink.flush());
+        stats = sink.stats();
+    }
+
+    const ReadBack back = read_back(BLOCK_FILE);
+    remove_log(BLOCK_FILE);
+
+    TEST_ASSERT_EQUAL(static_cast<size_t>(COUNT + 1), stats.records);
+    TEST_ASSERT_EQUAL(0u, stats.write_errors);
+    TEST_ASSERT_EQUAL(stats.blocks, back.blocks);
+    TEST_ASSERT_EQUAL(0u, back.damaged);
+    TEST_ASSERT_EQUAL(static_cast<size_t>(COUNT + 1), back.lines.size());
+    TEST_ASSERT_EQUAL(1'000, back.timestamps.back());
+    for (int i = 0; i < COUNT; i += 997) {
+        const auto expected = typical_message(i);
+        TEST_ASSERT_TRUE(back.lines[i] == std::string(expected.get_tag()) + ":" + std::string(expected.get_message_view()));
+        TEST_ASSERT_TRUE(std::chrono::system_clock::time_point(std::chrono::milliseconds(
+                             back.timestamps[i])) == expected.get_timestamp());
+    }
+    // Typical log text compresses several times over, headers included
+    TEST_ASSERT_TRUE(stats.raw_bytes > 6 * stats.stored_bytes);
+}
+
+void test_block_age_limit() {
+    remove_log(BLOCK_FILE);
+    BlockFileConfig config;
+    config.max_block_age_ms = 1000;
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        for (int i = 0; i < 10; ++i) {
+            sink.consume(make_message(i * 250, LogLevel::Info, "tick", std::to_string(i)));
+        }
+    } // Destruction writes the open block
+
+    BlockFileReader reader(BLOCK_FILE);
+    block::BlockHeader header;
+    std::vector<int64_t> spans;
+    while (reader.next(header)) {
+        spans.push_back(header.max_ms - header.min_ms);
+        TEST_ASSERT_TRUE(reader.skip_payload(header));
+    }
+    remove_log(BLOCK_FILE);
+
+    TEST_ASSERT_EQUAL(3u, spans.size()); // 0-750, 1000-1750, 2000-2250
+    TEST_ASSERT_EQUAL(750, spans[0]);
+    TEST_ASSERT_EQUAL(250, spans[2]);
+}
+
+void test_block_reader_resyncs() {
+    remove_log(BLOCK_FILE);
+    BlockFileConfig config;
+    config.block_size = 1024;
+    size_t blocks = 0;
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        for (int i = 0; i < 200; ++i) {
+            sink.consume(typical_message(i));
+        }
+        TEST_ASSERT_TRUE(sink.flush());
+        blocks = sink.stats().blocks;
+    }
+
+    // Damage the payload of the second block, then append a torn block
+    // followed by a good one, as after a power cut mid-write
+    {
+        BlockFileReader reader(BLOCK_FILE);
+        block::BlockHeader header;
+        TEST_ASSERT_TRUE(reader.next(header));
+        TEST_ASSERT_TRUE(reader.skip_payload(header));
+        TEST_ASSERT_TRUE(reader.next(header));
+        const long payload = static_cast<long>(reader.block_offset() + block::HEADER_SIZE +
+                                               header.extensions.size());
+        std::FILE* file = std::fopen(BLOCK_FILE, "r+b");
+        std::fseek(file, payload + 10, SEEK_SET);
+        std::fputc(0xFF, file);
+        std::fclose(file);
+    }
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        for (int i = 0; i < 20; ++i) {
+            sink.consume(typical_message(i));
+        }
+        TEST_ASSERT_TRUE(sink.flush());
+        blocks += sink.stats().blocks;
+    }
+    const std::vector<uint8_t> contents = read_file(BLOCK_FILE);
+    const size_t last = contents.size();
+    std::FILE* file = std::fopen(BLOCK_FILE, "ab");
+    std::fwrite(contents.data() + last - 300, 1, 100, file); // Header-less tail of a block
+    std::fclose(file);
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        sink.consume(make_message(0, LogLevel::Error, "after", "power cut"));
+    }
+
+    const ReadBack back = read_back(BLOCK_FILE);
+    remove_log(BLOCK_FILE);
+
+    TEST_ASSERT_EQUAL(1u, back.damaged);
+    TEST_ASSERT_EQUAL(blocks - 1 + 1, back.blocks); // All but the damaged one, plus the last
+    TEST_ASSERT_TRUE(back.lines.back() == "after:power cut");
+}
+
+void test_query_uses_index() {
+    remove_log(BLOCK_FILE);
+    BlockFileConfig config;
+    config.block_size = 1024;
+    size_t blocks = 0;
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        for (int i = 0; i < 5000; ++i) {
+            sink.consume(typical_message(i));
+        }
+        TEST_ASSERT_TRUE(sink.flush());
+        blocks = sink.stats().blocks;
+    }
+    std::vector<block::IndexEntry> index;
+    TEST_ASSERT_TRUE(block::load_index(BLOCK_FILE, index));
+    TEST_ASSERT_EQUAL(blocks, index.size());
+    TEST_ASSERT_EQUAL(0u, index.front().offset);
+
+    // Records 1000-1099, and the ota warnings among them
+    LogQuery window;
+    window.from_ms = typical_message(1000).get_timestamp().time_since_epoch() / std::chrono::milliseconds(1);
+    window.to_ms = window.from_ms + 99 * 37;
+    LogQuery warnings = window;
+    warnings.least_severe = LogLevel::Warning;
+    warnings.tags = {"ota"};
+
+    const auto count = [](const LogQuery& query, QueryStats& stats) {
+        std::vector<std::string> lines;
+        stats = run_query(BLOCK_FILE, query, [&](const record::RecordView& view) {
+            lines.push_back(std::string(view.tag) + ":" + std::string(view.message));
+        });
+        return lines;
+    };
+    QueryStats stats;
+    std::vector<std::string> lines = count(window, stats);
+    TEST_ASSERT_TRUE(stats.used_index);
+    TEST_ASSERT_EQUAL(100u, lines.size());
+    TEST_ASSERT_TRUE(lines.front() == "wifi:" + std::string(typical_message(1000).get_message_view()));
+    TEST_ASSERT_EQUAL(blocks, stats.blocks_total);
+    TEST_ASSERT_TRUE(stats.blocks_read * 10 < blocks);
+    const size_t window_blocks = stats.blocks_read;
+
+    lines = count(warnings, stats);
+    TEST_ASSERT_EQUAL(20u, lines.size());
+    TEST_ASSERT_TRUE(lines.front() == "ota:chunk 1003 retry after timeout");
+
+    // An index missing its last entries still covers the rest by scanning
+    const std::vector<uint8_t> full = read_file(block::index_path(BLOCK_FILE));
+    write_file(block::index_path(BLOCK_FILE), full.data(),
+               block::INDEX_HEADER_SIZE + 10 * block::INDEX_ENTRY_SIZE + 7);
+    TEST_ASSERT_EQUAL(20u, count(warnings, stats).size());
+    TEST_ASSERT_TRUE(stats.used_index);
+    TEST_ASSERT_EQUAL(blocks, stats.blocks_total);
+
+    // An index that belongs to another file is ignored
+    write_file(block::index_path(BLOCK_FILE), full.data(), full.size());
+    std::vector<uint8_t> shifted = read_file(BLOCK_FILE);
+    shifted.insert(shifted.begin(), 5, uint8_t{0});
+    write_file(BLOCK_FILE, shifted.data(), shifted.size());
+    TEST_ASSERT_EQUAL(20u, count(warnings, stats).size());
+    TEST_ASSERT_FALSE(stats.used_index);
+
+    // Without an index, headers are scanned but payloads still skipped
+    std::remove(block::index_path(BLOCK_FILE).c_str());
+    TEST_ASSERT_EQUAL(100u, count(window, stats).size());
+    TEST_ASSERT_FALSE(stats.used_index);
+    TEST_ASSERT_EQUAL(blocks, stats.blocks_total);
+    TEST_ASSERT_EQUAL(window_blocks, stats.blocks_read);
+    remove_log(BLOCK_FILE);
+}
+
+void test_query_uses_block_summaries() {
+    remove_log(BLOCK_FILE);
+    BlockFileConfig config;
+    config.block_size = 1024;
+    size_t blocks = 0;
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        for (int i = 0; i < 5000; ++i) {
+            sink.consume(typical_message(i));
+            if (i % 1000 == 500) {
+                sink.consume(make_message(i, LogLevel::Error, "power", "brownout code=E42"));
+            }
+        }
+        TEST_ASSERT_TRUE(sink.flush());
+        blocks = sink.stats().blocks;
+    }
+
+    // No false negatives: every tag and token is in its block's filter
+    {
+        BlockFileReader reader(BLOCK_FILE);
+        block::BlockHeader header;
+        std::vector<uint8_t> raw;
+        size_t misses = 0;
+        while (reader.next(header) && reader.read_payload(header, raw)) {
+            const block::BlockSummary summary = block::summary(header);
+            TEST_ASSERT_TRUE(summary.bloom != nullptr);
+            TEST_ASSERT_TRUE(summary.bloom_size < 512); // Folded down from 4096 bits
+            (void)block::for_each_record(header, raw, [&](const record::RecordView& view) {
+                misses += summary.may_have(view.level) ? 0 : 1;
+                misses += summary.may_contain(block::tag_hash(view.tag)) ? 0 : 1;
+                block::for_each_token(view.message, [&](std::string_view token) {
+                    misses += summary.may_contain(block::token_hash(token)) ? 0 : 1;
+                });
+            });
+        }
+        TEST_ASSERT_EQUAL(0u, misses);
+    }
+
+    const auto run = [](const LogQuery& query) {
+        return run_query(BLOCK_FILE, query, [](const record::RecordView&) {});
+    };
+    // The five errors sit in at most five blocks; the rest are ruled out
+    LogQuery errors;
+    errors.least_severe = LogLevel::Error;
+    QueryStats stats = run(errors);
+    TEST_ASSERT_EQUAL(5u, stats.records_matched);
+    TEST_ASSERT_TRUE(stats.blocks_read <= 5);
+    TEST_ASSERT_EQUAL(blocks, stats.blocks_read + stats.blocks_filtered);
+
+    LogQuery tagged;
+    tagged.tags = {"power"};
+    stats = run(tagged);
+    TEST_ASSERT_EQUAL(5u, stats.records_matched);
+    TEST_ASSERT_TRUE(stats.blocks_read * 10 < blocks); // Allows a few false positives
+
+    LogQuery worded;
+    worded.words = {"E42"};
+    stats = run(worded);
+    TEST_ASSERT_EQUAL(5u, stats.records_matched);
+    TEST_ASSERT_TRUE(stats.blocks_read * 10 < blocks);
+    worded.words = {"chunk", "1003"};
+    stats = run(worded);
+    TEST_ASSERT_EQUAL(1u, stats.records_matched);
+    TEST_ASSERT_TRUE(stats.blocks_read * 10 < blocks);
+
+    // Without summaries every block in the time range is read
+    remove_log(BLOCK_FILE);
+    config.summary_bits = 0;
+    {
+        BlockFileSink sink(BLOCK_FILE, config);
+        for (int i = 0; i < 500; ++i) {
+            sink.consume(typical_message(i));
+        }
+        TEST_ASSERT_TRUE(sink.flush());
+        blocks = sink.stats().blocks;
+    }
+    stats = run(errors);
+    TEST_ASSERT_EQUAL(0u, stats.records_matched);
+    TEST_ASSERT_EQUAL(blocks, stats.blocks_read);
+    remove_log(BLOCK_FILE);
+}
+
+void test_cobs_roundtrip() {
+    // Worked example: zeros become block lengths
+    const std::vector<uint8_t> input = {0x11, 0x22, 0x00, 0x33};
+    std::vector<uint8_t> encoded;
+    serial::cobs_encode(input.data(), input.size(), encoded);
+    TEST_ASSERT_TRUE(encoded == (std::vector<uint8_t>{0x03, 0x11, 0x22, 0x02, 0x33}));
+
+    std::mt19937 rng(11);
+    std::vector<uint8_t> decoded;
+    for (const size_t size : {0, 1, 253, 254, 255, 508, 1000}) {
+        for (const int fill : {-1, 0x00, 0xFF}) {
+            std::vector<uint8_t> data(size);
+            for (auto& byte : data) {
+                // Random data is about one in eight zeros
+                byte = fill >= 0 ? static_cast<uint8_t>(fill)
+                                 : static_cast<uint8_t>(rng() % 8 == 0 ? 0 : rng());
+            }
+            encoded.clear();
+            serial::cobs_encode(data.data(), data.size(), encoded);
+            TEST_ASSERT_TRUE(std::find(encoded.begin(), encoded.end(), 0) == encoded.end());
+            TEST_ASSERT_TRUE(encoded.size() <= size + size / 254 + 1);
+            TEST_ASSERT_TRUE(serial::cobs_decode(encoded.data(), encoded.size(), decoded));
+            TEST_ASSERT_TRUE(decoded == data);
+        }
+    }
+
+    // A block length running past the end is rejected
+    const std::vector<uint8_t> overrun = {0x05, 0x11, 0x22};
+    TEST_ASSERT_FALSE(serial::cobs_decode(overrun.data(), overrun.size(), decoded));
+}
+
+void test_serial_decoder_resyncs() {
+    std::vector<uint8_t> stream;
+    std::vector<size_t> starts;
+    std::vector<uint8_t> record_bytes;
+    std::vector<uint8_t> payload;
+    for (int i = 0; i < 100; ++i) {
+        if (i == 31) {
+            const std::string boot = "\r\nets Jun  8 2016 00:22:57 rst:0x1 (POWERON_RESET)\r\n";
+            stream.insert(stream.end(), boot.begin(), boot.end());
+        }
+        starts.push_back(stream.size());
+        record_bytes.clear();
+        (void)record::encode(typical_message(i), record_bytes);
+        serial::encode_frame(record_bytes.data(), record_bytes.size(), static_cast<uint16_t>(i),
+                             payload, stream);
+    }
+
+    // Join mid-frame, garble frame 10 and cut bytes out of frame 20
+    stream[starts[10] + 20] ^= 0x40;
+    stream.erase(stream.begin() + static_cast<ptrdiff_t>(starts[20] + 10),
+                 stream.begin() + static_cast<ptrdiff_t>(starts[20] + 15));
+    stream.erase(stream.begin(), stream.begin() + 5);
+
+    serial::FrameDecoder decoder;
+    std::vector<std::string> messages;
+    std::mt19937 rng(3);
+    for (size_t pos = 0; pos < stream.size();) {
+        const size_t chunk = std::min<size_t>(1 + rng() % 64, stream.size() - pos);
+        decoder.feed(stream.data() + pos, chunk, [&](const record::RecordView& view) {
+            messages.emplace_back(view.message);
+        });
+        pos += chunk;
+    }
+
+    std::vector<std::string> expected;
+    for (int i = 1; i < 100; ++i) {
+        if (i != 10 && i != 20) {
+            expected.emplace_back(typical_message(i).get_message_view());
+        }
+    }
+    const serial::FrameDecoder::Stats stats = decoder.stats();
+    TEST_ASSERT_TRUE(messages == expected);
+    TEST_ASSERT_EQUAL(97u, stats.frames);
+    TEST_ASSERT_EQUAL(2u, stats.lost_frames);
+    TEST_ASSERT_EQUAL(4u, stats.bad_frames); // Also the partial first frame and the console text
+}
+
+void test_serial_sink_pipe() {
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    (void)fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    (void)fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    serial::FrameDecoder decoder;
+    std::vector<std::string> messages;
+    const auto drain = [&] {
+        uint8_t buffer[4096];
+        ssize_t size;
+        while ((size = read(fds[0], buffer, sizeof(buffer))) > 0) {
+            decoder.feed(buffer, static_cast<size_t>(size), [&](const record::RecordView& view) {
+                messages.emplace_back(view.message);
+            });
+        }
+    };
+
+    SerialSinkConfig config;
+    config.max_record = 64;
+    SerialSink sink(fds[1], config);
+    sink.consume(make_message(0, LogLevel::Info, "t", std::string(200, 'x')));
+    for (int i = 1; i < 50; ++i) {
+        sink.consume(typical_message(i));
+    }
+    TEST_ASSERT_TRUE(sink.flush());
+    drain();
+    TEST_ASSERT_EQUAL(50u, messages.size());
+    TEST_ASSERT_EQUAL(64u - record::HEADER_SIZE - 1, messages[0].size()); // Cut to max_record
+    TEST_ASSERT_TRUE(messages[49] == typical_message(49).get_message_view());
+
+    // Nobody reads: the pipe fills, then the buffer, then frames are dropped
+    messages.clear();
+    constexpr int COUNT = 5000;
+    for (int i = 0; i < COUNT; ++i) {
+        sink.consume(typical_message(i));
+    }
+    const SerialSink::Stats full = sink.stats();
+    TEST_ASSERT_TRUE(full.frames_dropped > 0);
+    TEST_ASSERT_TRUE(sink.backpressure().buffered_bytes > 0);
+    TEST_ASSERT_EQUAL(full.frames_dropped, sink.backpressure().dropped_count);
+    TEST_ASSERT_EQUAL(5u, sink.on_idle());
+
+    do {
+        drain();
+    } while (!sink.flush());
+    TEST_ASSERT_EQUAL(os::WAIT_FOREVER, sink.on_idle());
+
+    // The next frame through shows the gap to the receiver
+    sink.consume(make_message(0, LogLevel::Info, "t", "after"));
+    drain();
+    TEST_ASSERT_EQUAL(static_cast<size_t>(COUNT) + 1 - full.frames_dropped, messages.size());
+    TEST_ASSERT_TRUE(messages.back() == "after");
+    TEST_ASSERT_EQUAL(full.frames_dropped, decoder.stats().lost_frames);
+    TEST_ASSERT_EQUAL(0u, decoder.stats().bad_frames);
+    TEST_ASSERT_EQUAL(0u, sink.stats().write_errors);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+int main() {
+    printf("Starting loggable storage tests...\n");
+
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_record_roundtrip);
+    RUN_TEST(test_spill_store_drops_corrupt_records);
+    RUN_TEST(test_lz_roundtrip);
+    RUN_TEST(test_block_sink_roundtrip);
+    RUN_TEST(test_block_age_limit);
+    RUN_TEST(test_block_reader_resyncs);
+    RUN_TEST(test_query_uses_index);
+    RUN_TEST(test_query_uses_block_summaries);
+    RUN_TEST(test_cobs_roundtrip);
+    RUN_TEST(test_serial_decoder_resyncs);
+    RUN_TEST(test_serial_sink_pipe);
+
+    printf("%d test(s) failed\n", test::g_failures);
+    return test::g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+
+// Minimal assertion macros mirroring test/test_loggable.cpp, but recording
+// failures so the host test binary can report them through its exit code.
+
+namespace loggable::test {
+inline int g_failures = 0;
+inline bool g_current_failed = false;
+} // namespace loggable::test
+
+#define TEST_FAIL_(...) \
+    do { \
+        printf(__VA_ARGS__); \
+        ::loggable::test::g_current_failed = true; \
+        return; \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) \
+    do { \
+        if ((expected) != (actual)) { \
+            TEST_FAIL_("TEST FAILED: %s != %s at line %d\n", #expected, #actual, __LINE__); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL_STRING(expected, actual) \
+    do { \
+        if (strcmp((expected), (actual)) != 0) { \
+            TEST_FAIL_("TEST FAILED: '%s' != '%s' at line %d\n", (expected), (actual), __LINE__); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_TRUE(condition) \
+    do { \
+        if (!(condition)) { \
+            TEST_FAIL_("TEST FAILED: %s at line %d\n", #condition, __LINE__); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_FALSE(condition) \
+    do { \
+        if (condition) { \
+            TEST_FAIL_("TEST FAILED: %s should be false at line %d\n", #condition, __LINE__); \
+        } \
+    } while(0)
+
+#define RUN_TEST(test_func) \
+    do { \
+        printf("Running %s... ", #test_func); \
+        fflush(stdout); \
+        ::loggable::test::g_current_failed = false; \
+        test_func(); \
+        if (::loggable::test::g_current_failed) { \
+            ++::loggable::test::g_failures; \
+        } else { \
+            printf("PASSED\n"); \
+        } \
+    } while(0)
@@ -1,3 +1,4 @@
+#include <cstdarg>
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
@@ -229,6 +230,69 @@ void test_sink_lifecycle() {
     TEST_ASSERT_EQUAL(1, temp_sink->message_count); // Should not increase
 }
 
+static int vlog_line_helper(Logger& logger, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = logger.vlog_line(format, args);
+    va_end(args);
+    return len;
+}
+
+static void vlogf_helper(Logger& logger, LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logger.vlogf(level, format, args);
+    va_end(args);
+}
+
+void test_parse_log_line_prefix() {
+    auto prefix = parse_log_line_prefix("W (1234) wifi: disconnected");
+    TEST_ASSERT_EQUAL(LogLevel::Warning, prefix.level);
+    TEST_ASSERT_TRUE(prefix.tag == "wifi");
+    TEST_ASSERT_EQUAL(15u, prefix.length);
+
+    prefix = parse_log_line_prefix("\033[0;31mE (12:00:01.500) nvs: fail");
+    TEST_ASSERT_EQUAL(LogLevel::Error, prefix.level);
+    TEST_ASSERT_TRUE(prefix.tag == "nvs");
+
+    TEST_ASSERT_EQUAL(0u, parse_log_line_prefix("plain text").length);
+    TEST_ASSERT_EQUAL(0u, parse_log_line_prefix("X (1) tag: msg").length);
+}
+
+void test_logger_vlogf_method() {
+    test_sink->clear();
+    Sinker::instance().set_level(LogLevel::Verbose);
+    TestLoggable test_obj("TestComponent");
+    vlogf_helper(test_obj.logger(), LogLevel::Info, "Formatted message: %d %s", 42, "test");
+
+    TEST_ASSERT_EQUAL(1, test_sink->message_count);
+    TEST_ASSERT_EQUAL_STRING("Formatted message: 42 test", test_sink->captured_messages[0].message);
+}
+
+void test_logger_vlog_line_method() {
+    test_sink->clear();
+    Sinker::instance().set_level(LogLevel::Verbose);
+    Logger hook_logger("ESP_LOG");
+    vlog_line_helper(hook_logger, "\033[0;33mW (%lu) %s: retry %d\033[0m\n", 1234UL, "wifi", 3);
+    vlog_line_helper(hook_logger, "no prefix here\n");
+
+    TEST_ASSERT_EQUAL(2, test_sink->message_count);
+    TEST_ASSERT_EQUAL(LogLevel::Warning, test_sink->captured_messages[0].level);
+    TEST_ASSERT_EQUAL_STRING("wifi", test_sink->captured_messages[0].tag);
+    TEST_ASSERT_EQUAL_STRING("retry 3", test_sink->captured_messages[0].message);
+    TEST_ASSERT_EQUAL(LogLevel::Info, test_sink->captured_messages[1].level);
+    TEST_ASSERT_EQUAL_STRING("ESP_LOG", test_sink->captured_messages[1].tag);
+    TEST_ASSERT_EQUAL_STRING("no prefix here", test_sink->captured_messages[1].message);
+
+    // Disabled levels are rejected from the format string alone, but still
+    // report their length like vprintf
+    test_sink->clear();
+    Sinker::instance().set_level(LogLevel::Info);
+    TEST_ASSERT_EQUAL(18, vlog_line_helper(hook_logger, "D (%lu) %s: noisy\n", 1UL, "wifi"));
+    TEST_ASSERT_EQUAL(0, test_sink->message_count);
+    Sinker::instance().set_level(LogLevel::Verbose);
+}
+
 // Main test runner
 extern "C" void app_main() {
     printf("Starting loggable component tests...\n");
@@ -247,6 +311,9 @@ extern "C" void app_main() {
     RUN_TEST(test_multiple_sinks);
     RUN_TEST(test_logger_log_method);
     RUN_TEST(test_logger_logf_method);
+    RUN_TEST(test_parse_log_line_prefix);
+    RUN_TEST(test_logger_vlogf_method);
+    RUN_TEST(test_logger_vlog_line_method);
     RUN_TEST(test_empty_message);
     RUN_TEST(test_large_message);
     RUN_TEST(test_sink_lifecycle);
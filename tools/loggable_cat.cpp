@@ -0,0 +1,95 @@
+// Decompress block-compressed log files written by BlockFileSink.
+//
+//   loggable_cat [--stats] FILE...
+//
+// Prints every record as "[timestamp_ms][L][tag] message". With --stats,
+// prints one summary line per file instead.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "loggable_block.hpp"
+
+using namespace loggable;
+
+namespace {
+
+struct FileStats {
+    size_t blocks{0};
+    size_t records{0};
+    size_t damaged{0};
+    uint64_t raw_bytes{0};
+    uint64_t stored_bytes{0};
+};
+
+bool cat_file(const char *path, bool stats_only) {
+    BlockFileReader reader(path);
+    if (!reader.is_open()) {
+        std::fprintf(stderr, "loggable_cat: cannot open %s\n", path);
+        return false;
+    }
+
+    FileStats stats;
+    block::BlockHeader header;
+    std::vector<uint8_t> raw;
+    while (reader.next(header)) {
+        if (!reader.read_payload(header, raw)) {
+            ++stats.damaged;
+            continue;
+        }
+        ++stats.blocks;
+        stats.raw_bytes += header.raw_size;
+        stats.stored_bytes += block::HEADER_SIZE + header.extensions.size() + header.stored_size;
+        const bool whole = block::for_each_record(header, raw, [&](const record::RecordView &view) {
+            ++stats.records;
+            if (!stats_only) {
+                std::printf("[%lld][%s][%.*s] %.*s\n", static_cast<long long>(view.timestamp_ms),
+                            log_level_to_string(view.level), static_cast<int>(view.tag.size()),
+                            view.tag.data(), static_cast<int>(view.message.size()),
+                            view.message.data());
+            }
+        });
+        if (!whole) {
+            ++stats.damaged;
+        }
+    }
+
+    if (stats_only) {
+        const double ratio = stats.stored_bytes == 0 ? 0.0
+            : static_cast<double>(stats.raw_bytes) / static_cast<double>(stats.stored_bytes);
+        std::printf("%s: %zu blocks, %zu records, %llu -> %llu bytes (%.2fx)\n", path,
+                    stats.blocks, stats.records, static_cast<unsigned long long>(stats.raw_bytes),
+                    static_cast<unsigned long long>(stats.stored_bytes), ratio);
+    }
+    if (stats.damaged > 0 || reader.skipped_bytes() > 0) {
+        std::fprintf(stderr, "loggable_cat: %s: %zu damaged blocks, %llu bytes skipped\n", path,
+                     stats.damaged, static_cast<unsigned long long>(reader.skipped_bytes()));
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bool stats_only = false;
+    std::vector<const char *> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            stats_only = true;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "usage: loggable_cat [--stats] FILE...\n");
+        return 2;
+    }
+
+    bool ok = true;
+    for (const char *path : paths) {
+        ok = cat_file(path, stats_only) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// Extract records from block-compressed log files written by BlockFileSink.
+//
+//   loggable_query [--from MS] [--to MS] [--level L[..L]] [--tag TAG]...
+//                  [--word WORD]... [--stats] FILE...
+//
+// --from/--to bound the timestamp in ms, inclusive. --level takes level
+// letters: "W" keeps W and everything more severe, "W..I" keeps W to I.
+// --tag may be repeated; a record matches any of the tags. --word keeps
+// records whose message has every given word as a whole token. Matching
+// records print as "[timestamp_ms][L][tag] message". The `<FILE>.idx`
+// index lets blocks outside the time range be skipped unread, and block
+// summaries those without the levels, tags or words; --stats reports how
+// many blocks were read.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "loggable_query.hpp"
+
+using namespace loggable;
+
+namespace {
+
+bool parse_ms(const char *text, int64_t &out) {
+    char *end = nullptr;
+    out = std::strtoll(text, &end, 10);
+    return end != text && *end == '\0';
+}
+
+bool parse_levels(const char *text, LogQuery &query) {
+    const size_t length = std::strlen(text);
+    if (length == 1) {
+        query.most_severe = LogLevel::Error;
+        query.least_severe = log_level_from_char(text[0]);
+    } else if (length == 4 && std::strncmp(text + 1, "..", 2) == 0) {
+        query.most_severe = log_level_from_char(text[0]);
+        query.least_severe = log_level_from_char(text[3]);
+    } else {
+        return false;
+    }
+    return query.most_severe != LogLevel::None && query.least_severe != LogLevel::None &&
+           query.most_severe <= query.least_severe;
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: loggable_query [--from MS] [--to MS] [--level L[..L]] "
+                         "[--tag TAG]... [--word WORD]... [--stats] FILE...\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    LogQuery query;
+    bool stats_wanted = false;
+    std::vector<const char *> paths;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--from") == 0 && has_value) {
+            if (!parse_ms(argv[++i], query.from_ms)) {
+                return usage();
+            }
+        } else if (std::strcmp(argv[i], "--to") == 0 && has_value) {
+            if (!parse_ms(argv[++i], query.to_ms)) {
+                return usage();
+            }
+        } else if (std::strcmp(argv[i], "--level") == 0 && has_value) {
+            if (!parse_levels(argv[++i], query)) {
+                return usage();
+            }
+        } else if (std::strcmp(argv[i], "--tag") == 0 && has_value) {
+            query.tags.emplace_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--word") == 0 && has_value) {
+            // "rssi=-40" is two tokens; the message must contain both
+            block::for_each_token(argv[++i], [&](std::string_view token) {
+                query.words.emplace_back(token);
+            });
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats_wanted = true;
+        } else if (argv[i][0] == '-') {
+            return usage();
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        return usage();
+    }
+
+    bool ok = true;
+    for (const char *path : paths) {
+        if (!BlockFileReader(path).is_open()) {
+            std::fprintf(stderr, "loggable_query: cannot open %s\n", path);
+            ok = false;
+            continue;
+        }
+        const QueryStats stats = run_query(path, query, [](const record::RecordView &view) {
+            std::printf("[%lld][%s][%.*s] %.*s\n", static_cast<long long>(view.timestamp_ms),
+                        log_level_to_string(view.level), static_cast<int>(view.tag.size()),
+                        view.tag.data(), static_cast<int>(view.message.size()),
+                        view.message.data());
+        });
+        if (stats_wanted) {
+            std::fprintf(stderr,
+                         "%s: %zu of %zu blocks read (%s), %zu ruled out by summaries, "
+                         "%zu records matched\n", path, stats.blocks_read, stats.blocks_total,
+                         stats.used_index ? "indexed" : "scanned", stats.blocks_filtered,
+                         stats.records_matched);
+        }
+        if (stats.blocks_damaged > 0) {
+            std::fprintf(stderr, "loggable_query: %s: %zu damaged blocks\n", path,
+                         stats.blocks_damaged);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+// Decode framed binary records written by SerialSink.
+//
+//   loggable_serial [--baud N] [--stats] [PATH]
+//
+// Reads PATH, or standard input when it is missing or "-": a capture
+// file, a pipe, or a serial device such as /dev/ttyUSB0. A tty is put in
+// raw mode, at N baud when --baud is given. Prints every record as
+// "[timestamp_ms][L][tag] message" until end of input or Ctrl-C. Damaged
+// frames and console text on the line are skipped; --stats reports them
+// and the frames lost, on stderr, at the end.
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "loggable_serial.hpp"
+
+using namespace loggable;
+
+namespace {
+
+volatile std::sig_atomic_t g_interrupted = 0;
+
+void on_interrupt(int) { g_interrupted = 1; }
+
+bool baud_constant(long baud, speed_t &out) {
+    switch (baud) {
+    case 9600: out = B9600; return true;
+    case 19200: out = B19200; return true;
+    case 38400: out = B38400; return true;
+    case 57600: out = B57600; return true;
+    case 115200: out = B115200; return true;
+    case 230400: out = B230400; return true;
+#ifdef B460800
+    case 460800: out = B460800; return true;
+#endif
+#ifdef B921600
+    case 921600: out = B921600; return true;
+#endif
+    default: return false;
+    }
+}
+
+bool configure_tty(int fd, long baud) {
+    termios tty{};
+    if (tcgetattr(fd, &tty) != 0) {
+        return false;
+    }
+    cfmakeraw(&tty);
+    if (baud > 0) {
+        speed_t speed{};
+        if (!baud_constant(baud, speed) || cfsetispeed(&tty, speed) != 0 ||
+            cfsetospeed(&tty, speed) != 0) {
+            return false;
+        }
+    }
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: loggable_serial [--baud N] [--stats] [PATH]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long baud = 0;
+    bool stats_wanted = false;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            baud = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats_wanted = true;
+        } else if ((argv[i][0] == '-' && argv[i][1] != '\0') || path) {
+            return usage();
+        } else {
+            path = argv[i];
+        }
+    }
+
+    const bool from_stdin = !path || std::strcmp(path, "-") == 0;
+    const int fd = from_stdin ? STDIN_FILENO : open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        std::fprintf(stderr, "loggable_serial: cannot open %s\n", path);
+        return 1;
+    }
+    if (isatty(fd) && !configure_tty(fd, baud)) {
+        std::fprintf(stderr, "loggable_serial: cannot configure %s\n", from_stdin ? "stdin" : path);
+        return 1;
+    }
+
+    // No SA_RESTART: Ctrl-C interrupts the blocking read and ends the loop
+    struct sigaction action{};
+    action.sa_handler = on_interrupt;
+    sigaction(SIGINT, &action, nullptr);
+
+    serial::FrameDecoder decoder;
+    uint8_t buffer[4096];
+    bool ok = true;
+    while (!g_interrupted) {
+        const ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size == 0) {
+            break;
+        }
+        if (size < 0) {
+            ok = errno == EINTR;
+            if (!ok) {
+                std::perror("loggable_serial: read");
+            }
+            break;
+        }
+        decoder.feed(buffer, static_cast<size_t>(size), [](const record::RecordView &view) {
+            std::printf("[%lld][%s][%.*s] %.*s\n", static_cast<long long>(view.timestamp_ms),
+                        log_level_to_string(view.level), static_cast<int>(view.tag.size()),
+                        view.tag.data(), static_cast<int>(view.message.size()),
+                        view.message.data());
+        });
+        std::fflush(stdout);
+    }
+
+    if (stats_wanted) {
+        const serial::FrameDecoder::Stats stats = decoder.stats();
+        std::fprintf(stderr, "%llu bytes, %zu records, %zu damaged frames, %zu frames lost\n",
+                     static_cast<unsigned long long>(stats.bytes), stats.frames,
+                     stats.bad_frames, stats.lost_frames);
+    }
+    if (!from_stdin) {
+        close(fd);
+    }
+    return ok ? 0 : 1;
+}